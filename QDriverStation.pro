@@ -32,6 +32,7 @@ QT_SELECT = qt5 qmake
 
 QT += qml
 QT += quick
+QT += network
 
 win32* {
     LIBS += -lPdh -lgdi32
@@ -87,14 +88,25 @@ SOURCES += \
   $$PWD/src/utilities.cpp \
   $$PWD/src/beeper.cpp \
   $$PWD/src/dashboards.cpp \
-  $$PWD/src/shortcuts.cpp
+  $$PWD/src/shortcuts.cpp \
+  $$PWD/src/inputbridge.cpp \
+  $$PWD/src/powersource.cpp \
+  $$PWD/src/hostmetrics.cpp \
+  $$PWD/src/plotitem.cpp \
+  $$PWD/src/headlessserver.cpp
   
 HEADERS += \
   $$PWD/src/utilities.h \
   $$PWD/src/beeper.h \
   $$PWD/src/dashboards.h \
   $$PWD/src/versions.h \
-  $$PWD/src/shortcuts.h
+  $$PWD/src/shortcuts.h \
+  $$PWD/src/inputbridge.h \
+  $$PWD/src/powersource.h \
+  $$PWD/src/hostmetrics.h \
+  $$PWD/src/plotitem.h \
+  $$PWD/src/spscqueue.h \
+  $$PWD/src/headlessserver.h
     
 RESOURCES += \
   $$PWD/qml/qml.qrc \
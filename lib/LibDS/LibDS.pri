@@ -21,14 +21,18 @@ win32* {
 HEADERS += \
     $$PWD/include/DS_Client.h \
     $$PWD/include/DS_Config.h \
+    $$PWD/include/DS_Context.h \
+    $$PWD/include/DS_Discovery.h \
     $$PWD/include/DS_Events.h \
     $$PWD/include/DS_Joysticks.h \
+    $$PWD/include/DS_Latency.h \
     $$PWD/include/DS_Types.h \
     $$PWD/include/DS_Utils.h \
     $$PWD/include/LibDS.h \
     $$PWD/include/DS_Array.h \
     $$PWD/include/DS_Socket.h \
     $$PWD/include/DS_Protocol.h \
+    $$PWD/include/DS_Realtime.h \
     $$PWD/include/DS_DefaultProtocols.h \
     $$PWD/include/DS_Timer.h \
     $$PWD/include/DS_Queue.h \
@@ -40,10 +44,14 @@ SOURCES += \
     $$PWD/src/protocols/frc_2016.c \
     $$PWD/src/client.c \
     $$PWD/src/config.c \
+    $$PWD/src/context.c \
+    $$PWD/src/discovery.c \
     $$PWD/src/events.c \
     $$PWD/src/init.c \
     $$PWD/src/joysticks.c \
+    $$PWD/src/latency.c \
     $$PWD/src/protocols.c \
+    $$PWD/src/realtime.c \
     $$PWD/src/socket.c \
     $$PWD/src/utils.c \
     $$PWD/src/crc32.c \
@@ -0,0 +1,33 @@
+#-------------------------------------------------------------------------------
+# Remove Qt dependency
+#-------------------------------------------------------------------------------
+
+CONFIG += console
+
+CONFIG -= qt
+CONFIG -= app_bundle
+
+DEFINES -= UNICODE QT_LARGEFILE_SUPPORT
+
+TARGET = LibDS_Bench
+
+#-------------------------------------------------------------------------------
+# Count heap allocations (requires the GNU linker)
+#-------------------------------------------------------------------------------
+
+linux:!android {
+    DEFINES += BENCH_COUNT_ALLOCS
+    QMAKE_LFLAGS += -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
+}
+
+#-------------------------------------------------------------------------------
+# Include libraries
+#-------------------------------------------------------------------------------
+
+include ($$PWD/LibDS.pri)
+
+#-------------------------------------------------------------------------------
+# Import source code
+#-------------------------------------------------------------------------------
+
+SOURCES += $$PWD/bench/main.c
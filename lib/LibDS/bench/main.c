@@ -0,0 +1,436 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <LibDS.h>
+#include <DS_Queue.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Allocation counters, updated by the malloc wrappers (if available)
+ */
+#if defined BENCH_COUNT_ALLOCS
+#define ALLOCS_COUNTED "true"
+static unsigned long allocations = 0;
+
+extern void* __real_malloc (size_t size);
+extern void* __real_calloc (size_t count, size_t size);
+extern void* __real_realloc (void* ptr, size_t size);
+
+void* __wrap_malloc (size_t size)
+{
+    ++allocations;
+    return __real_malloc (size);
+}
+
+void* __wrap_calloc (size_t count, size_t size)
+{
+    ++allocations;
+    return __real_calloc (count, size);
+}
+
+void* __wrap_realloc (void* ptr, size_t size)
+{
+    ++allocations;
+    return __real_realloc (ptr, size);
+}
+#else
+#define ALLOCS_COUNTED "false"
+#endif
+
+/**
+ * Represents a benchmark and its optional setup/teardown functions
+ */
+typedef struct {
+    const char* name;
+    void (*setup) (void);
+    void (*run) (void);
+    void (*teardown) (void);
+} Benchmark;
+
+/**
+ * Holds the results of a benchmark
+ */
+typedef struct {
+    long iterations;
+    double ns_per_op;
+    double allocs_per_op;
+} Result;
+
+/*
+ * Data used by the benchmarks
+ */
+static DS_Queue queue;
+static DS_String string;
+static DS_Protocol protocol;
+static DS_String robot_packet;
+static uint8_t buffer [1024];
+static volatile uint32_t sink = 0;
+
+/*
+ * Benchmark options
+ */
+static int json = 0;
+static int min_time = 200;
+static const char* filter = NULL;
+
+/*
+ * Setup & teardown functions
+ */
+
+static void setup_string (void)
+{
+    string = DS_StrNew ("LibDS");
+}
+
+static void teardown_string (void)
+{
+    DS_StrRmBuf (&string);
+}
+
+static void setup_buffer (void)
+{
+    int i;
+    for (i = 0; i < (int) sizeof (buffer); ++i)
+        buffer [i] = (uint8_t) (i * 31);
+}
+
+static void setup_queue (void)
+{
+    DS_QueueInit (&queue, 50, sizeof (DS_Event));
+}
+
+static void teardown_queue (void)
+{
+    DS_QueueFree (&queue);
+}
+
+static void setup_2014 (void)
+{
+    protocol = DS_GetProtocolFRC_2014();
+    robot_packet = DS_StrNewLen (1024);
+    DS_StrSetChar (&robot_packet, 0, 0x40);
+    DS_StrSetChar (&robot_packet, 1, 0x12);
+    DS_StrSetChar (&robot_packet, 2, 0x80);
+}
+
+static void setup_2015 (void)
+{
+    protocol = DS_GetProtocolFRC_2015();
+    robot_packet = DS_StrNewLen (8);
+    DS_StrSetChar (&robot_packet, 2, 0x01);
+    DS_StrSetChar (&robot_packet, 4, 0x20);
+    DS_StrSetChar (&robot_packet, 5, 0x0c);
+    DS_StrSetChar (&robot_packet, 6, 0x80);
+}
+
+static void setup_2016 (void)
+{
+    setup_2015();
+    protocol = DS_GetProtocolFRC_2016();
+}
+
+static void teardown_protocol (void)
+{
+    DS_StrRmBuf (&robot_packet);
+    DS_StrRmBuf (&protocol.name);
+}
+
+/*
+ * Benchmarks
+ */
+
+static void bench_str_new (void)
+{
+    DS_String str = DS_StrNew ("roboRIO-3794-FRC.local");
+    DS_StrRmBuf (&str);
+}
+
+static void bench_str_append (void)
+{
+    DS_StrAppend (&string, 'x');
+
+    if (DS_StrLen (&string) >= 1024) {
+        DS_StrRmBuf (&string);
+        string = DS_StrNew ("LibDS");
+    }
+}
+
+static void bench_str_join (void)
+{
+    DS_String first = DS_StrNewLen (8);
+    DS_StrJoin (&first, &string);
+    DS_StrRmBuf (&first);
+}
+
+static void bench_str_format (void)
+{
+    DS_String str = DS_StrFormat ("%s %d", "Team", 3794);
+    DS_StrRmBuf (&str);
+}
+
+static void bench_crc32 (void)
+{
+    sink += DS_CRC32 (buffer, sizeof (buffer));
+}
+
+static void bench_queue (void)
+{
+    DS_Event event;
+    memset (&event, 0, sizeof (event));
+
+    DS_QueuePush (&queue, (void*) &event);
+    DS_QueuePop (&queue);
+}
+
+static void bench_joystick_set (void)
+{
+    DS_SetJoystickAxis (0, 1, 0.5);
+    DS_SetJoystickButton (0, 3, 1);
+    DS_SetJoystickHat (0, 0, 90);
+}
+
+static void bench_joystick_get (void)
+{
+    sink += (uint32_t) (DS_GetJoystickAxis (0, 1) * 100);
+    sink += (uint32_t) DS_GetJoystickButton (0, 3);
+    sink += (uint32_t) DS_GetJoystickHat (0, 0);
+}
+
+static void bench_create_robot_packet (void)
+{
+    DS_String packet = protocol.create_robot_packet();
+    sink += (uint32_t) DS_StrLen (&packet);
+    DS_StrRmBuf (&packet);
+}
+
+static void bench_read_robot_packet (void)
+{
+    sink += (uint32_t) protocol.read_robot_packet (&robot_packet);
+}
+
+static void bench_events (void)
+{
+    DS_Event event;
+    event.robot.type = DS_ROBOT_VOLTAGE_CHANGED;
+    event.robot.voltage = 12.5;
+    DS_AddEvent (&event);
+
+    while (DS_PollEvent (&event))
+        sink += (uint32_t) event.type;
+}
+
+static const Benchmark benchmarks [] = {
+    {"DS_StrNew", NULL, &bench_str_new, NULL},
+    {"DS_StrAppend", &setup_string, &bench_str_append, &teardown_string},
+    {"DS_StrJoin", &setup_string, &bench_str_join, &teardown_string},
+    {"DS_StrFormat", NULL, &bench_str_format, NULL},
+    {"DS_CRC32 (1024 bytes)", &setup_buffer, &bench_crc32, NULL},
+    {"DS_Queue push/pop", &setup_queue, &bench_queue, &teardown_queue},
+    {"Joystick set", NULL, &bench_joystick_set, NULL},
+    {"Joystick get", NULL, &bench_joystick_get, NULL},
+    {"FRC 2014 create_robot_packet",
+     &setup_2014, &bench_create_robot_packet, &teardown_protocol},
+    {"FRC 2014 read_robot_packet",
+     &setup_2014, &bench_read_robot_packet, &teardown_protocol},
+    {"FRC 2015 create_robot_packet",
+     &setup_2015, &bench_create_robot_packet, &teardown_protocol},
+    {"FRC 2015 read_robot_packet",
+     &setup_2015, &bench_read_robot_packet, &teardown_protocol},
+    {"FRC 2016 create_robot_packet",
+     &setup_2016, &bench_create_robot_packet, &teardown_protocol},
+    {"FRC 2016 read_robot_packet",
+     &setup_2016, &bench_read_robot_packet, &teardown_protocol},
+    {"Event dispatch", NULL, &bench_events, NULL},
+};
+
+/*
+ * Benchmark runner
+ */
+
+/**
+ * Runs the given \a benchmark \a iterations times and returns the elapsed
+ * processor time (in nsecs).
+ *
+ * \note We cannot use \c DS_Now() here, because the step mode replaces it
+ *       with a virtual clock that only advances with \c DS_Step()
+ */
+static int64_t run_batch (const Benchmark* benchmark, const long iterations)
+{
+    long i;
+    clock_t start = clock();
+
+    for (i = 0; i < iterations; ++i)
+        benchmark->run();
+
+    return (int64_t) ((double) (clock() - start) * 1e9 / CLOCKS_PER_SEC);
+}
+
+/**
+ * Runs the given \a benchmark until it takes at least \c min_time msecs,
+ * the iteration count is doubled until then
+ */
+static Result run_benchmark (const Benchmark* benchmark)
+{
+    Result result;
+    int64_t elapsed = 0;
+    long iterations = 1;
+
+    if (benchmark->setup)
+        benchmark->setup();
+
+    /* Warm up */
+    run_batch (benchmark, 100);
+
+    /* Find the number of iterations to run */
+    while (elapsed < (int64_t) min_time * 1000000 / 4) {
+        iterations *= 2;
+        elapsed = run_batch (benchmark, iterations);
+    }
+
+    /* Run the benchmark */
+#if defined BENCH_COUNT_ALLOCS
+    unsigned long allocs = allocations;
+#endif
+    iterations *= 4;
+    elapsed = run_batch (benchmark, iterations);
+
+    /* Fill the results */
+    result.iterations = iterations;
+    result.ns_per_op = (double) elapsed / iterations;
+#if defined BENCH_COUNT_ALLOCS
+    result.allocs_per_op = (double) (allocations - allocs) / iterations;
+#else
+    result.allocs_per_op = -1;
+#endif
+
+    if (benchmark->teardown)
+        benchmark->teardown();
+
+    return result;
+}
+
+/**
+ * Prints the usage of the application
+ */
+static void print_usage (const char* name)
+{
+    printf ("Usage: %s [options]\n\n", name);
+    printf ("Options:\n");
+    printf ("  --json         Print the results as JSON\n");
+    printf ("  --time <ms>    Minimum time of each benchmark (default 200)\n");
+    printf ("  --filter <str> Only run the benchmarks that contain <str>\n");
+    printf ("  --help         Show this message\n");
+}
+
+/**
+ * Reads the command line options, returns \c 0 if the application shall
+ * quit
+ */
+static int read_options (int argc, char** argv)
+{
+    int i;
+    for (i = 1; i < argc; ++i) {
+        if (strcmp (argv [i], "--json") == 0)
+            json = 1;
+
+        else if (strcmp (argv [i], "--time") == 0 && i + 1 < argc)
+            min_time = atoi (argv [++i]) > 0 ? atoi (argv [i]) : min_time;
+
+        else if (strcmp (argv [i], "--filter") == 0 && i + 1 < argc)
+            filter = argv [++i];
+
+        else {
+            print_usage (argv [0]);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Runs the benchmarks in a thread-less context and prints the results
+ */
+int main (int argc, char** argv)
+{
+    if (!read_options (argc, argv))
+        return EXIT_SUCCESS;
+
+    /* Initialize a context without threads or sockets */
+    DS_SetStepMode (1);
+    DS_Init();
+    DS_SetTeamNumber (3794);
+    DS_JoysticksAdd (6, 1, 12);
+    DS_JoysticksAdd (4, 0, 10);
+
+    /* Print header */
+    if (json) {
+        printf ("{\n");
+        printf ("  \"version\": \"%s\",\n", DS_GetVersion());
+        printf ("  \"allocsCounted\": %s,\n", ALLOCS_COUNTED);
+        printf ("  \"benchmarks\": [");
+    }
+
+    else {
+        printf ("LibDS %s benchmarks\n\n", DS_GetVersion());
+        printf ("%-30s %14s %12s %12s\n", "Benchmark", "Iterations", "ns/op",
+                "allocs/op");
+    }
+
+    /* Run the benchmarks */
+    int i;
+    int count = 0;
+    int total = (int) (sizeof (benchmarks) / sizeof (benchmarks [0]));
+    for (i = 0; i < total; ++i) {
+        const Benchmark* benchmark = &benchmarks [i];
+        if (filter && !strstr (benchmark->name, filter))
+            continue;
+
+        Result result = run_benchmark (benchmark);
+
+        if (json) {
+            printf ("%s\n    {\"name\": \"%s\", \"iterations\": %ld, "
+                    "\"nsPerOp\": %.2f, \"allocsPerOp\": %.2f}",
+                    count > 0 ? "," : "", benchmark->name, result.iterations,
+                    result.ns_per_op, result.allocs_per_op);
+        }
+
+        else {
+            printf ("%-30s %14ld %12.2f %12.2f\n", benchmark->name,
+                    result.iterations, result.ns_per_op, result.allocs_per_op);
+        }
+
+        ++count;
+    }
+
+    /* Print footer */
+    if (json)
+        printf ("\n  ]\n}\n");
+
+    DS_Close();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,24 @@
+#-------------------------------------------------------------------------------
+# Remove Qt dependency
+#-------------------------------------------------------------------------------
+
+CONFIG += console
+
+CONFIG -= qt
+CONFIG -= app_bundle
+
+DEFINES -= UNICODE QT_LARGEFILE_SUPPORT
+
+#-------------------------------------------------------------------------------
+# Deploy options
+#-------------------------------------------------------------------------------
+
+TARGET = step-ds
+
+#-------------------------------------------------------------------------------
+# Include LibDS and the example code
+#-------------------------------------------------------------------------------
+
+include ($$PWD/../../LibDS.pri)
+
+SOURCES += $$PWD/src/main.c
@@ -0,0 +1,206 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Simulates a short match against a scripted robot. The DS runs in step
+ * mode and its sockets are replaced with hooks, so the whole match runs
+ * without threads, without the network and faster than real time.
+ *
+ * The robot boots after one second, is enabled by the DS and loses power
+ * for two seconds in the middle of the match. The program prints the DS
+ * events and exits with an error if the DS did not react as expected.
+ */
+
+#include <LibDS.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEAM_NUMBER    3794
+#define ROBOT_ADDRESS  "10.37.94.2"  /* Static address of the robot */
+
+#define BOOT_TIME      1000 /* Time at which the robot starts answering */
+#define ENABLE_TIME    3000 /* Time at which the DS enables the robot */
+#define OUTAGE_START   6000 /* Time at which the robot loses power */
+#define OUTAGE_END     8000 /* Time at which the robot answers again */
+#define MATCH_LENGTH  12000 /* Length of the simulated match */
+#define STEP_LENGTH      10 /* Time advanced between each event check */
+
+/*
+ * State of the scripted robot
+ */
+typedef struct {
+    int powered;    /* Set to 1 while the robot answers */
+    int pending;    /* Set to 1 if an answer is waiting to be read */
+    int packets;    /* Number of DS packets received by the robot */
+    int enabled;    /* Enabled state requested by the last DS packet */
+} Robot;
+
+static Robot robot;
+
+/*
+ * Time at which the DS reported each robot state change (-1 if never)
+ */
+static int comms_found = -1;
+static int comms_lost = -1;
+static int comms_recovered = -1;
+static int robot_enabled = -1;
+
+/**
+ * Returns the current time of the simulation (in msecs)
+ */
+static int now (void)
+{
+    return (int) (DS_Now() / 1000000);
+}
+
+/**
+ * Called when the DS sends a packet, the robot only listens to the robot
+ * packets sent to its address (the DS also probes the other candidates)
+ */
+static int robot_send (const DS_Socket* socket, const char* address,
+                       const char* data, const int length)
+{
+    if (socket->out_port != 1110 || strcmp (address, ROBOT_ADDRESS) != 0)
+        return length;
+
+    if (length > 3) {
+        ++robot.packets;
+        robot.enabled = (data [3] & 0x04) != 0;
+        robot.pending = robot.powered;
+    }
+
+    return length;
+}
+
+/**
+ * Called when the DS reads a socket, the robot answers each DS packet with
+ * a 2015 status packet (robot code running, 12.5 volts)
+ */
+static int robot_receive (const DS_Socket* socket, char* data,
+                          const int length, char* peer, const int peer_length)
+{
+    const char packet [8] = {0, 0, 0x01, 0, 0x20, 12, 0x80, 0};
+
+    if (socket->in_port != 1150 || !robot.pending || length < 8)
+        return 0;
+
+    robot.pending = 0;
+    memcpy (data, packet, sizeof (packet));
+    strncpy (peer, ROBOT_ADDRESS, peer_length);
+    return sizeof (packet);
+}
+
+/**
+ * Prints the events generated by the DS and registers the robot state
+ * changes that we want to check
+ */
+static void process_events (void)
+{
+    DS_Event event;
+    while (DS_PollEvent (&event)) {
+        switch (event.type) {
+        case DS_ROBOT_COMMS_CHANGED:
+            printf ("%6d ms: robot communications %s\n", now(),
+                    event.robot.connected ? "established" : "lost");
+
+            if (event.robot.connected && comms_found < 0)
+                comms_found = now();
+            else if (event.robot.connected && comms_lost >= 0)
+                comms_recovered = now();
+            else if (!event.robot.connected && comms_found >= 0)
+                comms_lost = now();
+            break;
+        case DS_ROBOT_CODE_CHANGED:
+            printf ("%6d ms: robot code %s\n", now(),
+                    event.robot.code ? "running" : "stopped");
+            break;
+        case DS_ROBOT_ENABLED_CHANGED:
+            printf ("%6d ms: robot %s\n", now(),
+                    event.robot.enabled ? "enabled" : "disabled");
+
+            if (event.robot.enabled && robot_enabled < 0)
+                robot_enabled = now();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ * Checks the given \a condition and prints the result
+ */
+static int check (const char* description, const int condition)
+{
+    printf ("[%s] %s\n", condition ? "PASS" : "FAIL", description);
+    return condition ? 0 : 1;
+}
+
+int main (void)
+{
+    DS_SocketHooks hooks;
+    hooks.send = &robot_send;
+    hooks.receive = &robot_receive;
+
+    /* Initialize the DS in step mode, with the scripted robot */
+    DS_SetStepMode (1);
+    DS_Init();
+    DS_SetSocketHooks (&hooks);
+    DS_SetTeamNumber (TEAM_NUMBER);
+
+    DS_Protocol protocol = DS_GetProtocolFRC_2015();
+    DS_ConfigureProtocol (&protocol);
+
+    /* Run the match */
+    while (now() < MATCH_LENGTH) {
+        robot.powered = (now() >= BOOT_TIME) &&
+                        (now() < OUTAGE_START || now() >= OUTAGE_END);
+
+        if (now() == ENABLE_TIME)
+            DS_SetRobotEnabled (1);
+
+        DS_Step (STEP_LENGTH);
+        process_events();
+    }
+
+    /* Check that the DS followed the robot */
+    int errors = 0;
+    printf ("\n");
+    errors += check ("DS found the robot after it booted",
+                     comms_found >= BOOT_TIME);
+    errors += check ("DS enabled the robot",
+                     robot_enabled >= ENABLE_TIME && robot.packets > 0);
+    errors += check ("DS detected the power outage",
+                     comms_lost >= OUTAGE_START && comms_lost < OUTAGE_END);
+    errors += check ("DS recovered the robot after the outage",
+                     comms_recovered >= OUTAGE_END);
+    errors += check ("Robot is disabled after the outage",
+                     !DS_GetRobotEnabled() && !robot.enabled);
+
+    printf ("\nRecovered the robot in %d ms, sent %d robot packets\n",
+            DS_RobotRecoveryTime(), DS_SentRobotPackets());
+
+    DS_Close();
+    return errors;
+}
@@ -46,6 +46,9 @@ extern "C" {
 #define RECONFIGURE_ROBOT 0x04
 #define RECONFIGURE_ALL   0x01 | 0x02 | 0x04
 
+/* Set when the addresses are re-applied because a watchdog expired */
+#define RECONFIGURE_WATCHDOG 0x08
+
 /* Misc */
 extern void CFG_ReconfigureAddresses (const int flags);
 
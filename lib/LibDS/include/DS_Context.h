@@ -0,0 +1,85 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIB_DS_CONTEXT_H
+#define _LIB_DS_CONTEXT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+/**
+ * Holds the state of a driver station (the protocol, the robot state, the
+ * joysticks, the event queue, etc). Each context can drive its own robot,
+ * which allows a single process to run several driver stations at once.
+ *
+ * The \c DS_* functions operate with the current context of the calling
+ * thread, which is the default context unless \c DS_MakeCurrent() is used.
+ */
+typedef struct _ds_context DS_Context;
+
+/*
+ * Identifies the state of each module inside a context
+ */
+typedef enum {
+    DS_STATE_INIT,
+    DS_STATE_TIMERS,
+    DS_STATE_SOCKETS,
+    DS_STATE_CLIENT,
+    DS_STATE_CONFIG,
+    DS_STATE_EVENTS,
+    DS_STATE_LATENCY,
+    DS_STATE_JOYSTICKS,
+    DS_STATE_PROTOCOLS,
+    DS_STATE_DISCOVERY,
+    DS_STATE_FRC_2014,
+    DS_STATE_FRC_2015,
+    DS_STATE_COUNT,
+} DS_StateId;
+
+/**
+ * Describes how a context allocates and frees the state of a module
+ */
+typedef struct _state_info {
+    size_t size;                /**< Size of the state structure */
+    void (*init) (void* state); /**< Sets the default values (optional) */
+    void (*free) (void* state); /**< Frees the state members (optional) */
+} DS_StateInfo;
+
+/* Context functions */
+extern DS_Context* DS_ContextCreate (void);
+extern DS_Context* DS_DefaultContext (void);
+extern DS_Context* DS_CurrentContext (void);
+extern void DS_ContextDestroy (DS_Context* context);
+extern void DS_MakeCurrent (DS_Context* context);
+
+/* Used by the modules to access their state */
+extern void* DS_ContextState (const DS_StateId id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIB_DS_DISCOVERY_H
+#define _LIB_DS_DISCOVERY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "DS_Socket.h"
+#include "DS_String.h"
+
+/*
+ * Maximum number of addresses that can be added with DS_AddRobotAddress()
+ */
+#define DS_DISCOVERY_USER_ADDRESSES 4
+
+extern void Discovery_Init (void);
+extern void Discovery_Close (void);
+extern void Discovery_Reset (const int watchdog);
+extern int Discovery_Searching (void);
+extern void Discovery_PacketRead (DS_Socket* socket);
+extern int Discovery_Probe (const DS_Socket* socket, const DS_String* data);
+
+extern void DS_ClearRobotAddresses (void);
+extern int DS_GetRobotDiscoveryTime (void);
+extern char* DS_GetDiscoveredRobotAddress (void);
+extern void DS_AddRobotAddress (const char* address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
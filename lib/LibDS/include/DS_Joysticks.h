@@ -42,6 +42,9 @@ extern int DS_GetJoystickButton (int joystick, int button);
 
 extern void DS_JoysticksReset (void);
 extern void DS_JoysticksAdd (const int axes, const int hats, const int buttons);
+extern void DS_JoysticksSet (const int joystick, const int axes, const int hats,
+                             const int buttons);
+extern void DS_JoysticksRemove (const int joystick);
 extern void DS_SetJoystickHat (int joystick, int hat, int angle);
 extern void DS_SetJoystickAxis (int joystick, int axis, float value);
 extern void DS_SetJoystickButton (int joystick, int button, int pressed);
@@ -0,0 +1,82 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIB_DS_LATENCY_H
+#define _LIB_DS_LATENCY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * Number of buckets of each latency histogram, bucket 0 counts the
+ * latencies below 2 usecs and bucket N counts the latencies between
+ * 2^N and 2^(N+1) usecs
+ */
+#define DS_LATENCY_BUCKETS 24
+
+/*
+ * Stages of the input-to-wire path, followed by the stages of the path of
+ * the robot packets that we receive
+ */
+typedef enum {
+    DS_LATENCY_INPUT,      /* Input event to DS_SetJoystick*() */
+    DS_LATENCY_ENCODE,     /* DS_SetJoystick*() to robot packet encoding */
+    DS_LATENCY_SEND,       /* Robot packet encoding to DS_SocketSend() return */
+    DS_LATENCY_TOTAL,      /* Input event to DS_SocketSend() return */
+    DS_LATENCY_QUEUE,      /* Robot packet arrival to robot packet decoding */
+    DS_LATENCY_ROUND_TRIP, /* DS_SocketSend() return to robot packet arrival */
+    DS_LATENCY_STAGES,
+} DS_LatencyStage;
+
+/**
+ * Holds the latency distribution of a stage
+ */
+typedef struct _latency_histogram {
+    uint32_t count;                        /**< Number of samples */
+    int64_t total;                         /**< Sum of the samples (in nsecs) */
+    int64_t max;                           /**< Largest sample (in nsecs) */
+    uint32_t buckets [DS_LATENCY_BUCKETS]; /**< Sample count of each bucket */
+} DS_LatencyHistogram;
+
+extern void Latency_Init (void);
+extern void Latency_Close (void);
+extern void Latency_PacketSent (void);
+extern void Latency_InputEncoded (void);
+extern void Latency_PacketEncoded (void);
+extern void Latency_PacketEncoding (void);
+extern void Latency_PacketReceived (const int64_t arrival_time);
+
+extern int64_t DS_LatencyNow (void);
+extern void DS_ResetLatency (void);
+extern void DS_LatencyInput (const int64_t event_time);
+extern void DS_GetLatencyHistogram (const DS_LatencyStage stage,
+                                    DS_LatencyHistogram* histogram);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
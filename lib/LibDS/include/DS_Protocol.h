@@ -56,6 +56,11 @@ typedef struct _protocol {
     int radio_interval;
     int robot_interval;
 
+    int fms_timeout;
+    int radio_timeout;
+    int robot_timeout;
+    int robot_recovery_interval;
+
     int max_joysticks;
     int max_axis_count;
     int max_hat_count;
@@ -70,6 +75,7 @@ typedef struct _protocol {
 
 extern void Protocols_Init();
 extern void Protocols_Close();
+extern void Protocols_Step (const int millisecs);
 extern void DS_ConfigureProtocol (const DS_Protocol* ptr);
 
 extern unsigned long DS_SentFMSBytes();
@@ -88,6 +94,8 @@ extern int DS_ReceivedFMSPackets();
 extern int DS_ReceivedRadioPackets();
 extern int DS_ReceivedRobotPackets();
 
+extern int DS_RobotRecoveryTime();
+
 extern void DS_ResetFMSPackets();
 extern void DS_ResetRadioPackets();
 extern void DS_ResetRobotPackets();
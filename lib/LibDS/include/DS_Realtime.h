@@ -0,0 +1,85 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _LIB_DS_REALTIME_H
+#define _LIB_DS_REALTIME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Result of each setting of the real-time profile
+ */
+typedef enum {
+    DS_REALTIME_NOT_REQUESTED, /* The setting is not used by the profile */
+    DS_REALTIME_APPLIED,       /* The setting took effect */
+    DS_REALTIME_DENIED,        /* The system refused the setting */
+    DS_REALTIME_UNSUPPORTED,   /* The system does not have the setting */
+} DS_RealtimeResult;
+
+/**
+ * Holds the scheduling options of the protocol and socket threads
+ */
+typedef struct {
+    int enabled;     /**< 1 to apply the profile, 0 to use the defaults */
+    int priority;    /**< Real-time priority (1 to 99 on Linux) */
+    int round_robin; /**< 1 to use SCHED_RR instead of SCHED_FIFO */
+    int nice;        /**< Nice value used if the priority is denied */
+    int cpu;         /**< CPU that runs the threads, -1 for any CPU */
+    int lock_memory; /**< 1 to lock the memory of the process in RAM */
+} DS_RealtimeProfile;
+
+/**
+ * Reports whether each setting of the profile took effect, a setting is
+ * reported as denied if it failed on any of the threads
+ */
+typedef struct {
+    DS_RealtimeResult scheduler;   /**< Real-time priority */
+    DS_RealtimeResult nice;        /**< Nice value (fallback) */
+    DS_RealtimeResult affinity;    /**< CPU affinity */
+    DS_RealtimeResult memory_lock; /**< Locked memory (mlockall) */
+} DS_RealtimeStatus;
+
+/**
+ * Holds the settings that the profile changed on a thread, so that they can
+ * be restored when the profile changes
+ */
+typedef struct {
+    int generation; /**< Version of the profile applied to the thread */
+    int scheduler;  /**< 1 if the thread has a real-time priority */
+    int nice;       /**< 1 if the thread has a custom nice value */
+    int affinity;   /**< 1 if the thread is bound to a CPU */
+} DS_RealtimeThread;
+
+extern void Realtime_Update (DS_RealtimeThread* thread);
+
+extern void DS_GetRealtimeStatus (DS_RealtimeStatus* status);
+extern void DS_GetRealtimeProfile (DS_RealtimeProfile* profile);
+extern void DS_SetRealtimeProfile (const DS_RealtimeProfile* profile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -28,11 +28,24 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include <pthread.h>
 
 #include "DS_Types.h"
 #include "DS_String.h"
 
+/**
+ * Holds the quality of service options of a socket. A value of \c 0 keeps
+ * the default of the operating system.
+ */
+typedef struct {
+    int dscp;              /**< DiffServ code point (e.g. 46 for EF) */
+    int priority;          /**< Queueing priority (SO_PRIORITY, Linux) */
+    int recv_buffer;       /**< Receive buffer size in bytes (SO_RCVBUF) */
+    int send_buffer;       /**< Send buffer size in bytes (SO_SNDBUF) */
+    int busy_poll;         /**< Busy polling time in usecs (Linux) */
+} DS_SocketQoS;
+
 /**
  * Holds all the private (erm, dirty) variables that the sockets module needs
  * to operate with the data provided by a \c DS_Socket structure
@@ -42,8 +55,17 @@ typedef struct {
     int sock_out;          /**< Output socket file descriptor */
     int client_init;       /**< 1 if client is working, 0 if not */
     int server_init;       /**< 1 if server is working, 0 if not */
+    int running;           /**< 1 while the socket thread shall run */
+    int polled;            /**< 1 if the socket is read without a thread */
+    int hooked;            /**< 1 if the socket uses the context hooks */
+    int bound_port;        /**< Input port registered for the context */
+    pthread_t thread;      /**< The thread that opens and reads the socket */
     size_t buffer_size;    /**< Holds the number of received bytes */
     char buffer [4096];    /**< Holds the received data buffer */
+    char peer [64];        /**< Numeric address of the last sender */
+    int64_t rx_stamp;      /**< System time at which the buffer arrived */
+    int64_t rx_time;       /**< Arrival time of the last read data */
+    DS_SocketQoS applied;  /**< QoS options reported by the system */
     char in_service [12];  /**< Holds the input port number as a string */
     char out_service [12]; /**< Holds the output port number as a string */
 } DS_SocketInfo;
@@ -52,16 +74,40 @@ typedef struct {
  * Holds all the 'public' variables of a socket, these variables can be used
  * both the the networking module and the rest of the application.
  */
-typedef struct {
+typedef struct _socket {
     int in_port;           /**< Input port number */
     int out_port;          /**< Output port number */
     int disabled;          /**< 1 if socket shall not send or receive data */
     int broadcast;         /**< 1 if socket shall send or receive broadcasts */
     char address [512];    /**< Address of remote host */
     DS_SocketType type;    /**< Type of socket (UDP/TCP) */
+    DS_SocketQoS qos;      /**< QoS options to apply to the socket */
     DS_SocketInfo info;    /**< Ugly data about the socket */
 } DS_Socket;
 
+/**
+ * Replaces the system sockets of a context that is driven by \c DS_Step(),
+ * so that simulations and tests can exchange packets with a scripted robot
+ * without using the network. The \c socket argument identifies the socket
+ * that sends or reads the data (e.g. by its ports).
+ */
+typedef struct {
+    /**
+     * Sends the \a length bytes of \a data to the given \a address,
+     * returns the number of bytes written or \c -1 on failure
+     */
+    int (*send) (const DS_Socket* socket, const char* address,
+                 const char* data, const int length);
+
+    /**
+     * Copies up to \a length bytes of received data to \a data and the
+     * numeric address of the sender to \a peer, returns the number of
+     * bytes read (\c 0 if nothing was received)
+     */
+    int (*receive) (const DS_Socket* socket, char* data, const int length,
+                    char* peer, const int peer_length);
+} DS_SocketHooks;
+
 /* For socket initialization */
 extern DS_Socket* DS_SocketEmpty (void);
 
@@ -76,8 +122,13 @@ extern void DS_SocketClose (DS_Socket* ptr);
 /* I/O functions */
 extern DS_String DS_SocketRead (DS_Socket* ptr);
 extern int DS_SocketSend (const DS_Socket* ptr, const DS_String* data);
+extern int DS_SocketSendTo (const DS_Socket* ptr, const DS_String* data,
+                            const char* address);
 extern void DS_SocketChangeAddress (DS_Socket* ptr, const char* address);
 
+/* Step mode functions */
+extern void DS_SetSocketHooks (const DS_SocketHooks* hooks);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,8 +28,14 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include <pthread.h>
 
+/**
+ * Returns the current time (in nsecs) of a monotonic clock
+ */
+typedef int64_t (*DS_Clock) (void);
+
 /**
  * Represents a tiemr and its properties
  */
@@ -40,14 +46,26 @@ typedef struct _timer {
     int elapsed;      /**< Number of milliseconds elapsed since last reset */
     int precision;    /**< The update interval (in milliseconds) */
     int initialized;  /**< Set to \c 1 if the timer has been initialized */
+    int manual;       /**< Set to \c 1 if the timer has no thread */
+    pthread_t thread; /**< The thread that updates the timer */
 } DS_Timer;
 
 extern void Timers_Init (void);
 extern void Timers_Close (void);
+extern void Timers_Step (const int millisecs);
+
+extern int64_t DS_Now (void);
+extern int DS_StepMode (void);
+extern DS_Clock DS_CustomClock (void);
+extern void DS_SetClock (const DS_Clock clock);
+extern void DS_SetStepMode (const int enabled);
+
 extern void DS_Sleep (const int millisecs);
 extern void DS_TimerStop (DS_Timer* timer);
+extern void DS_TimerClose (DS_Timer* timer);
 extern void DS_TimerStart (DS_Timer* timer);
 extern void DS_TimerReset (DS_Timer* timer);
+extern void DS_TimerStep (DS_Timer* timer, const int millisecs);
 extern void DS_TimerInit (DS_Timer* timer, const int time, const int precision);
 
 #ifdef __cplusplus
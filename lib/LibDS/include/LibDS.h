@@ -30,16 +30,21 @@ extern "C" {
 
 #include "DS_Timer.h"
 #include "DS_Types.h"
+#include "DS_Context.h"
 #include "DS_Utils.h"
 #include "DS_Events.h"
 #include "DS_Client.h"
 #include "DS_Socket.h"
+#include "DS_Latency.h"
+#include "DS_Discovery.h"
 #include "DS_Protocol.h"
+#include "DS_Realtime.h"
 #include "DS_Joysticks.h"
 #include "DS_DefaultProtocols.h"
 
 extern void DS_Init (void);
 extern void DS_Close (void);
+extern void DS_Step (const int millisecs);
 extern int DS_Initialized (void);
 
 extern char* DS_GetVersion (void);
@@ -25,6 +25,7 @@
 #include "DS_Utils.h"
 
 #include <assert.h>
+#include <string.h>
 
 /**
  * Deallocates the memory used to store the \a array data and resets the
@@ -68,8 +69,10 @@ void DS_ArrayInsert (DS_Array* array, void* element)
 
     /* Resize array if required */
     if (array->used == array->size) {
-        array->size *= 2;
-        array->data = realloc (array->data, array->size);
+        size_t size = array->size > 0 ? array->size * 2 : 1;
+        array->data = realloc (array->data, size * sizeof (void*));
+        memset (array->data + array->size, 0, (size - array->size) * sizeof (void*));
+        array->size = size;
     }
 
     /* Insert element */
@@ -24,6 +24,7 @@
 #include "DS_Utils.h"
 #include "DS_Client.h"
 #include "DS_Config.h"
+#include "DS_Context.h"
 #include "DS_String.h"
 #include "DS_Protocol.h"
 
@@ -32,22 +33,35 @@
 #include <assert.h>
 
 /*
- * Set the strings
+ * Holds the strings of each context
  */
-static DS_String status_string;
-static DS_String custom_fms_address;
-static DS_String custom_radio_address;
-static DS_String custom_robot_address;
+typedef struct {
+    DS_String status_string;
+    DS_String custom_fms_address;
+    DS_String custom_radio_address;
+    DS_String custom_robot_address;
+} Client;
+
+const DS_StateInfo Client_State = {sizeof (Client), NULL, NULL};
+
+/**
+ * Returns the strings of the current context
+ */
+static Client* client (void)
+{
+    return (Client*) DS_ContextState (DS_STATE_CLIENT);
+}
 
 /**
  * Allocates memory for the members of the client module
  */
 void Client_Init (void)
 {
-    status_string = DS_StrNew ("Loading...");
-    custom_fms_address = DS_StrNew (DS_FallBackAddress);
-    custom_radio_address = DS_StrNew (DS_FallBackAddress);
-    custom_robot_address = DS_StrNew (DS_FallBackAddress);
+    Client* ptr = client();
+    ptr->status_string = DS_StrNew ("Loading...");
+    ptr->custom_fms_address = DS_StrNew (DS_FallBackAddress);
+    ptr->custom_radio_address = DS_StrNew (DS_FallBackAddress);
+    ptr->custom_robot_address = DS_StrNew (DS_FallBackAddress);
 }
 
 /**
@@ -55,10 +69,11 @@ void Client_Init (void)
  */
 void Client_Close (void)
 {
-    DS_StrRmBuf (&status_string);
-    DS_StrRmBuf (&custom_fms_address);
-    DS_StrRmBuf (&custom_radio_address);
-    DS_StrRmBuf (&custom_robot_address);
+    Client* ptr = client();
+    DS_StrRmBuf (&ptr->status_string);
+    DS_StrRmBuf (&ptr->custom_fms_address);
+    DS_StrRmBuf (&ptr->custom_radio_address);
+    DS_StrRmBuf (&ptr->custom_robot_address);
 }
 
 /**
@@ -68,7 +83,7 @@ void Client_Close (void)
  */
 char* DS_GetCustomFMSAddress (void)
 {
-    return DS_StrToChar (&custom_fms_address);
+    return DS_StrToChar (&client()->custom_fms_address);
 }
 
 /**
@@ -78,7 +93,7 @@ char* DS_GetCustomFMSAddress (void)
  */
 char* DS_GetCustomRadioAddress (void)
 {
-    return DS_StrToChar (&custom_radio_address);
+    return DS_StrToChar (&client()->custom_radio_address);
 }
 
 /**
@@ -88,7 +103,7 @@ char* DS_GetCustomRadioAddress (void)
  */
 char* DS_GetCustomRobotAddress (void)
 {
-    return DS_StrToChar (&custom_robot_address);
+    return DS_StrToChar (&client()->custom_robot_address);
 }
 
 /**
@@ -147,7 +162,7 @@ char* DS_GetDefaultRobotAddress (void)
  */
 char* DS_GetAppliedFMSAddress (void)
 {
-    if (DS_StrEmpty (&custom_fms_address))
+    if (DS_StrEmpty (&client()->custom_fms_address))
         return DS_GetDefaultFMSAddress();
     else
         return DS_GetCustomFMSAddress();
@@ -161,7 +176,7 @@ char* DS_GetAppliedFMSAddress (void)
  */
 char* DS_GetAppliedRadioAddress (void)
 {
-    if (DS_StrEmpty (&custom_radio_address))
+    if (DS_StrEmpty (&client()->custom_radio_address))
         return DS_GetDefaultRadioAddress();
     else
         return DS_GetCustomRadioAddress();
@@ -175,7 +190,7 @@ char* DS_GetAppliedRadioAddress (void)
  */
 char* DS_GetAppliedRobotAddress (void)
 {
-    if (DS_StrEmpty (&custom_robot_address))
+    if (DS_StrEmpty (&client()->custom_robot_address))
         return DS_GetDefaultRobotAddress();
     else
         return DS_GetCustomRobotAddress();
@@ -451,14 +466,14 @@ void DS_SetCustomFMSAddress (const char* address)
     assert (address);
 
     if (strlen (address) > 0) {
-        DS_StrRmBuf (&custom_fms_address);
-        custom_fms_address = DS_StrNew (address);
+        DS_StrRmBuf (&client()->custom_fms_address);
+        client()->custom_fms_address = DS_StrNew (address);
         CFG_ReconfigureAddresses (RECONFIGURE_FMS);
     }
 
     else {
-        DS_StrRmBuf (&custom_fms_address);
-        custom_fms_address = DS_StrNewLen (0);
+        DS_StrRmBuf (&client()->custom_fms_address);
+        client()->custom_fms_address = DS_StrNewLen (0);
         CFG_ReconfigureAddresses (RECONFIGURE_FMS);
     }
 }
@@ -471,14 +486,14 @@ void DS_SetCustomRadioAddress (const char* address)
     assert (address);
 
     if (strlen (address) > 0) {
-        DS_StrRmBuf (&custom_radio_address);
-        custom_radio_address = DS_StrNew (address);
+        DS_StrRmBuf (&client()->custom_radio_address);
+        client()->custom_radio_address = DS_StrNew (address);
         CFG_ReconfigureAddresses (RECONFIGURE_RADIO);
     }
 
     else {
-        DS_StrRmBuf (&custom_radio_address);
-        custom_radio_address = DS_StrNewLen (0);
+        DS_StrRmBuf (&client()->custom_radio_address);
+        client()->custom_radio_address = DS_StrNewLen (0);
         CFG_ReconfigureAddresses (RECONFIGURE_RADIO);
     }
 }
@@ -491,14 +506,14 @@ void DS_SetCustomRobotAddress (const char* address)
     assert (address);
 
     if (strlen (address) > 0) {
-        DS_StrRmBuf (&custom_robot_address);
-        custom_robot_address = DS_StrNew (address);
+        DS_StrRmBuf (&client()->custom_robot_address);
+        client()->custom_robot_address = DS_StrNew (address);
         CFG_ReconfigureAddresses (RECONFIGURE_ROBOT);
     }
 
     else {
-        DS_StrRmBuf (&custom_robot_address);
-        custom_robot_address = DS_StrNewLen (0);
+        DS_StrRmBuf (&client()->custom_robot_address);
+        client()->custom_robot_address = DS_StrNewLen (0);
         CFG_ReconfigureAddresses (RECONFIGURE_ROBOT);
     }
 }
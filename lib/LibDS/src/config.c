@@ -25,30 +25,68 @@
 #include "DS_Client.h"
 #include "DS_Events.h"
 #include "DS_Config.h"
+#include "DS_Context.h"
 #include "DS_Protocol.h"
+#include "DS_Discovery.h"
 
 #include <math.h>
 #include <string.h>
 #include <assert.h>
 
 /*
- * These variables hold the state(s) of the LibDS and its modules
- */
-static int team = 0;
-static int cpu_usage = -1;
-static int ram_usage = -1;
-static int disk_usage = -1;
-static int robot_code = -1;
-static int robot_enabled = -1;
-static int can_utilization = -1;
-static float robot_voltage = -1;
-static int emergency_stopped = -1;
-static int fms_communications = -1;
-static int radio_communications = -1;
-static int robot_communications = -1;
-static DS_Position robot_position = DS_POSITION_1;
-static DS_Alliance robot_alliance = DS_ALLIANCE_RED;
-static DS_ControlMode control_mode = DS_CONTROL_TELEOPERATED;
+ * Holds the state of the robot of each context
+ */
+typedef struct {
+    int team;
+    int cpu_usage;
+    int ram_usage;
+    int disk_usage;
+    int robot_code;
+    int robot_enabled;
+    int can_utilization;
+    float robot_voltage;
+    int emergency_stopped;
+    int fms_communications;
+    int radio_communications;
+    int robot_communications;
+    DS_Position robot_position;
+    DS_Alliance robot_alliance;
+    DS_ControlMode control_mode;
+} Config;
+
+/**
+ * Sets the default values of the given \a ptr state
+ */
+static void init_state (void* ptr)
+{
+    Config* cfg = (Config*) ptr;
+
+    cfg->team = 0;
+    cfg->cpu_usage = -1;
+    cfg->ram_usage = -1;
+    cfg->disk_usage = -1;
+    cfg->robot_code = -1;
+    cfg->robot_enabled = -1;
+    cfg->can_utilization = -1;
+    cfg->robot_voltage = -1;
+    cfg->emergency_stopped = -1;
+    cfg->fms_communications = -1;
+    cfg->radio_communications = -1;
+    cfg->robot_communications = -1;
+    cfg->robot_position = DS_POSITION_1;
+    cfg->robot_alliance = DS_ALLIANCE_RED;
+    cfg->control_mode = DS_CONTROL_TELEOPERATED;
+}
+
+const DS_StateInfo CFG_State = {sizeof (Config), &init_state, NULL};
+
+/**
+ * Returns the robot state of the current context
+ */
+static Config* config (void)
+{
+    return (Config*) DS_ContextState (DS_STATE_CONFIG);
+}
 
 /**
  * Ensures that the given \a input number is either \c 0 or \c 1
@@ -161,6 +199,7 @@ void CFG_ReconfigureAddresses (const int flags)
         char* address = DS_GetAppliedRobotAddress();
         DS_SocketChangeAddress (&DS_CurrentProtocol()->robot_socket, address);
         DS_FREE (address);
+        Discovery_Reset (flags & RECONFIGURE_WATCHDOG);
     }
 }
 
@@ -170,7 +209,7 @@ void CFG_ReconfigureAddresses (const int flags)
  */
 int CFG_GetTeamNumber (void)
 {
-    return DS_Max (team, 0);
+    return DS_Max (config()->team, 0);
 }
 
 /**
@@ -178,7 +217,7 @@ int CFG_GetTeamNumber (void)
  */
 int CFG_GetRobotCode (void)
 {
-    return robot_code == 1;
+    return config()->robot_code == 1;
 }
 
 /**
@@ -186,7 +225,7 @@ int CFG_GetRobotCode (void)
  */
 int CFG_GetRobotEnabled (void)
 {
-    return robot_enabled == 1;
+    return config()->robot_enabled == 1;
 }
 
 /**
@@ -194,7 +233,7 @@ int CFG_GetRobotEnabled (void)
  */
 int CFG_GetRobotCPUUsage (void)
 {
-    return DS_Max (cpu_usage, 0);
+    return DS_Max (config()->cpu_usage, 0);
 }
 
 /**
@@ -202,7 +241,7 @@ int CFG_GetRobotCPUUsage (void)
  */
 int CFG_GetRobotRAMUsage (void)
 {
-    return DS_Max (ram_usage, 0);
+    return DS_Max (config()->ram_usage, 0);
 }
 
 /**
@@ -210,7 +249,7 @@ int CFG_GetRobotRAMUsage (void)
  */
 int CFG_GetCANUtilization (void)
 {
-    return DS_Max (can_utilization, 0);
+    return DS_Max (config()->can_utilization, 0);
 }
 
 /**
@@ -218,7 +257,7 @@ int CFG_GetCANUtilization (void)
  */
 int CFG_GetRobotDiskUsage (void)
 {
-    return DS_Max (disk_usage, 0);
+    return DS_Max (config()->disk_usage, 0);
 }
 
 /**
@@ -226,7 +265,7 @@ int CFG_GetRobotDiskUsage (void)
  */
 float CFG_GetRobotVoltage (void)
 {
-    return DS_Max (robot_voltage, 0);
+    return DS_Max (config()->robot_voltage, 0);
 }
 
 /**
@@ -236,7 +275,7 @@ float CFG_GetRobotVoltage (void)
  */
 DS_Alliance CFG_GetAlliance (void)
 {
-    return robot_alliance;
+    return config()->robot_alliance;
 }
 
 /**
@@ -247,7 +286,7 @@ DS_Alliance CFG_GetAlliance (void)
  */
 DS_Position CFG_GetPosition (void)
 {
-    return robot_position;
+    return config()->robot_position;
 }
 
 /**
@@ -255,7 +294,7 @@ DS_Position CFG_GetPosition (void)
  */
 int CFG_GetEmergencyStopped (void)
 {
-    return emergency_stopped == 1;
+    return config()->emergency_stopped == 1;
 }
 
 /**
@@ -264,7 +303,7 @@ int CFG_GetEmergencyStopped (void)
  */
 int CFG_GetFMSCommunications (void)
 {
-    return fms_communications == 1;
+    return config()->fms_communications == 1;
 }
 
 /**
@@ -273,7 +312,7 @@ int CFG_GetFMSCommunications (void)
  */
 int CFG_GetRadioCommunications (void)
 {
-    return radio_communications == 1;
+    return config()->radio_communications == 1;
 }
 
 /**
@@ -282,7 +321,7 @@ int CFG_GetRadioCommunications (void)
  */
 int CFG_GetRobotCommunications (void)
 {
-    return robot_communications == 1;
+    return config()->robot_communications == 1;
 }
 
 /**
@@ -293,7 +332,7 @@ int CFG_GetRobotCommunications (void)
  */
 DS_ControlMode CFG_GetControlMode (void)
 {
-    return control_mode;
+    return config()->control_mode;
 }
 
 /**
@@ -301,8 +340,8 @@ DS_ControlMode CFG_GetControlMode (void)
  */
 void CFG_SetRobotCode (const int code)
 {
-    if (robot_code != to_boolean (code)) {
-        robot_code = to_boolean (code);
+    if (config()->robot_code != to_boolean (code)) {
+        config()->robot_code = to_boolean (code);
         create_robot_event (DS_ROBOT_CODE_CHANGED);
         create_robot_event (DS_STATUS_STRING_CHANGED);
     }
@@ -313,8 +352,8 @@ void CFG_SetRobotCode (const int code)
  */
 void CFG_SetTeamNumber (const int number)
 {
-    if (team != number) {
-        team = number;
+    if (config()->team != number) {
+        config()->team = number;
         CFG_ReconfigureAddresses (RECONFIGURE_ALL);
     }
 }
@@ -324,8 +363,9 @@ void CFG_SetTeamNumber (const int number)
  */
 void CFG_SetRobotEnabled (const int enabled)
 {
-    if (robot_enabled != to_boolean (enabled)) {
-        robot_enabled = to_boolean (enabled) && !CFG_GetEmergencyStopped();
+    if (config()->robot_enabled != to_boolean (enabled)) {
+        config()->robot_enabled = to_boolean (enabled) &&
+                                  !CFG_GetEmergencyStopped();
         create_robot_event (DS_ROBOT_ENABLED_CHANGED);
         create_robot_event (DS_STATUS_STRING_CHANGED);
     }
@@ -337,8 +377,8 @@ void CFG_SetRobotEnabled (const int enabled)
  */
 void CFG_SetRobotCPUUsage (const int percent)
 {
-    if (cpu_usage != percent) {
-        cpu_usage = respect_range (percent, 0, 100);
+    if (config()->cpu_usage != percent) {
+        config()->cpu_usage = respect_range (percent, 0, 100);
         create_robot_event (DS_ROBOT_CPU_INFO_CHANGED);
     }
 }
@@ -349,8 +389,8 @@ void CFG_SetRobotCPUUsage (const int percent)
  */
 void CFG_SetRobotRAMUsage (const int percent)
 {
-    if (ram_usage != percent) {
-        ram_usage = respect_range (percent, 0, 100);
+    if (config()->ram_usage != percent) {
+        config()->ram_usage = respect_range (percent, 0, 100);
         create_robot_event (DS_ROBOT_RAM_INFO_CHANGED);
     }
 }
@@ -361,8 +401,8 @@ void CFG_SetRobotRAMUsage (const int percent)
  */
 void CFG_SetRobotDiskUsage (const int percent)
 {
-    if (disk_usage != percent) {
-        disk_usage = respect_range (percent, 0, 100);
+    if (config()->disk_usage != percent) {
+        config()->disk_usage = respect_range (percent, 0, 100);
         create_robot_event (DS_ROBOT_DISK_INFO_CHANGED);
     }
 }
@@ -372,8 +412,8 @@ void CFG_SetRobotDiskUsage (const int percent)
  */
 void CFG_SetRobotVoltage (const float voltage)
 {
-    if (robot_voltage != voltage) {
-        robot_voltage = roundf (voltage * 100) / 100;
+    if (config()->robot_voltage != voltage) {
+        config()->robot_voltage = roundf (voltage * 100) / 100;
         create_robot_event (DS_ROBOT_VOLTAGE_CHANGED);
     }
 }
@@ -383,8 +423,8 @@ void CFG_SetRobotVoltage (const float voltage)
  */
 void CFG_SetEmergencyStopped (const int stopped)
 {
-    if (emergency_stopped != to_boolean (stopped)) {
-        emergency_stopped = to_boolean (stopped);
+    if (config()->emergency_stopped != to_boolean (stopped)) {
+        config()->emergency_stopped = to_boolean (stopped);
         create_robot_event (DS_ROBOT_ESTOP_CHANGED);
         create_robot_event (DS_STATUS_STRING_CHANGED);
     }
@@ -395,8 +435,8 @@ void CFG_SetEmergencyStopped (const int stopped)
  */
 void CFG_SetAlliance (const DS_Alliance alliance)
 {
-    if (robot_alliance != alliance) {
-        robot_alliance = alliance;
+    if (config()->robot_alliance != alliance) {
+        config()->robot_alliance = alliance;
         create_robot_event (DS_ROBOT_STATION_CHANGED);
     }
 }
@@ -406,8 +446,8 @@ void CFG_SetAlliance (const DS_Alliance alliance)
  */
 void CFG_SetPosition (const DS_Position position)
 {
-    if (robot_position != position) {
-        robot_position = position;
+    if (config()->robot_position != position) {
+        config()->robot_position = position;
         create_robot_event (DS_ROBOT_STATION_CHANGED);
     }
 }
@@ -417,8 +457,8 @@ void CFG_SetPosition (const DS_Position position)
  */
 void CFG_SetCANUtilization (const int utilization)
 {
-    if (can_utilization != utilization) {
-        can_utilization = utilization;
+    if (config()->can_utilization != utilization) {
+        config()->can_utilization = utilization;
         create_robot_event (DS_ROBOT_CAN_UTIL_CHANGED);
     }
 }
@@ -428,8 +468,8 @@ void CFG_SetCANUtilization (const int utilization)
  */
 void CFG_SetControlMode (const DS_ControlMode mode)
 {
-    if (control_mode != mode) {
-        control_mode = mode;
+    if (config()->control_mode != mode) {
+        config()->control_mode = mode;
         create_robot_event (DS_ROBOT_MODE_CHANGED);
         create_robot_event (DS_STATUS_STRING_CHANGED);
     }
@@ -440,12 +480,12 @@ void CFG_SetControlMode (const DS_ControlMode mode)
  */
 void CFG_SetFMSCommunications (const int communications)
 {
-    if (fms_communications != to_boolean (communications)) {
-        fms_communications = to_boolean (communications);
+    if (config()->fms_communications != to_boolean (communications)) {
+        config()->fms_communications = to_boolean (communications);
 
         DS_Event event;
         event.fms.type = DS_FMS_COMMS_CHANGED;
-        event.fms.connected = fms_communications;
+        event.fms.connected = config()->fms_communications;
         DS_AddEvent (&event);
 
         DS_ResetFMSPackets();
@@ -457,12 +497,12 @@ void CFG_SetFMSCommunications (const int communications)
  */
 void CFG_SetRadioCommunications (const int communications)
 {
-    if (radio_communications != to_boolean (communications)) {
-        radio_communications = to_boolean (communications);
+    if (config()->radio_communications != to_boolean (communications)) {
+        config()->radio_communications = to_boolean (communications);
 
         DS_Event event;
         event.radio.type = DS_RADIO_COMMS_CHANGED;
-        event.radio.connected = fms_communications;
+        event.radio.connected = config()->fms_communications;
         DS_AddEvent (&event);
 
         DS_ResetRadioPackets();
@@ -474,8 +514,8 @@ void CFG_SetRadioCommunications (const int communications)
  */
 void CFG_SetRobotCommunications (const int communications)
 {
-    if (robot_communications != to_boolean (communications)) {
-        robot_communications = to_boolean (communications);
+    if (config()->robot_communications != to_boolean (communications)) {
+        config()->robot_communications = to_boolean (communications);
         create_robot_event (DS_ROBOT_COMMS_CHANGED);
         create_robot_event (DS_STATUS_STRING_CHANGED);
 
@@ -488,6 +528,9 @@ void CFG_SetRobotCommunications (const int communications)
  */
 void CFG_FMSWatchdogExpired (void)
 {
+    if (DS_CurrentProtocol())
+        DS_CurrentProtocol()->reset_fms();
+
     CFG_SetFMSCommunications (0);
     CFG_ReconfigureAddresses (RECONFIGURE_FMS);
 }
@@ -497,6 +540,9 @@ void CFG_FMSWatchdogExpired (void)
  */
 void CFG_RadioWatchdogExpired (void)
 {
+    if (DS_CurrentProtocol())
+        DS_CurrentProtocol()->reset_radio();
+
     CFG_SetRadioCommunications (0);
     CFG_ReconfigureAddresses (RECONFIGURE_RADIO);
 }
@@ -506,6 +552,10 @@ void CFG_RadioWatchdogExpired (void)
  */
 void CFG_RobotWatchdogExpired (void)
 {
+    /* Let the protocol reset its flags (e.g. to request a resync) */
+    if (DS_CurrentProtocol())
+        DS_CurrentProtocol()->reset_robot();
+
     /* Reset everything to safe state */
     CFG_SetRobotCode (0);
     CFG_SetRobotVoltage (0);
@@ -516,8 +566,8 @@ void CFG_RobotWatchdogExpired (void)
     CFG_SetEmergencyStopped (0);
     CFG_SetRobotCommunications (0);
 
-    /* Force the sockets to perform another lookup */
-    CFG_ReconfigureAddresses (RECONFIGURE_ROBOT);
+    /* Force the sockets to perform another lookup and search the robot */
+    CFG_ReconfigureAddresses (RECONFIGURE_ROBOT | RECONFIGURE_WATCHDOG);
 
     /* Update the status label */
     create_robot_event (DS_STATUS_STRING_CHANGED);
@@ -0,0 +1,180 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LibDS.h"
+#include "DS_Context.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#if defined _MSC_VER
+    #define THREAD_LOCAL __declspec (thread)
+#else
+    #define THREAD_LOCAL __thread
+#endif
+
+struct _ds_context {
+    void* states [DS_STATE_COUNT];
+};
+
+/*
+ * State descriptors of each module (defined in their source files)
+ */
+extern const DS_StateInfo Init_State;
+extern const DS_StateInfo Timers_State;
+extern const DS_StateInfo Sockets_State;
+extern const DS_StateInfo Client_State;
+extern const DS_StateInfo CFG_State;
+extern const DS_StateInfo Events_State;
+extern const DS_StateInfo Latency_State;
+extern const DS_StateInfo Joysticks_State;
+extern const DS_StateInfo Protocols_State;
+extern const DS_StateInfo Discovery_State;
+extern const DS_StateInfo FRC_2014_State;
+extern const DS_StateInfo FRC_2015_State;
+
+static const DS_StateInfo* modules [DS_STATE_COUNT] = {
+    &Init_State,
+    &Timers_State,
+    &Sockets_State,
+    &Client_State,
+    &CFG_State,
+    &Events_State,
+    &Latency_State,
+    &Joysticks_State,
+    &Protocols_State,
+    &Discovery_State,
+    &FRC_2014_State,
+    &FRC_2015_State,
+};
+
+/*
+ * The default context is used by the threads that did not select a context
+ */
+static DS_Context* default_context = NULL;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+/*
+ * The context selected by the calling thread
+ */
+static THREAD_LOCAL DS_Context* current_context = NULL;
+
+/**
+ * Creates the default context, called only once
+ */
+static void create_default_context (void)
+{
+    default_context = DS_ContextCreate();
+}
+
+/**
+ * Allocates a new context with its own modules, the context must be
+ * selected with \c DS_MakeCurrent() and initialized with \c DS_Init()
+ * before using it.
+ */
+DS_Context* DS_ContextCreate (void)
+{
+    DS_Context* context = (DS_Context*) calloc (1, sizeof (DS_Context));
+    assert (context);
+
+    int i;
+    for (i = 0; i < DS_STATE_COUNT; ++i) {
+        context->states [i] = calloc (1, modules [i]->size);
+        assert (context->states [i]);
+
+        if (modules [i]->init)
+            modules [i]->init (context->states [i]);
+    }
+
+    return context;
+}
+
+/**
+ * Returns the context used by the threads that did not select another
+ * context, this is the context used by applications that drive a single
+ * robot.
+ */
+DS_Context* DS_DefaultContext (void)
+{
+    pthread_once (&default_once, &create_default_context);
+    return default_context;
+}
+
+/**
+ * Returns the context selected by the calling thread
+ */
+DS_Context* DS_CurrentContext (void)
+{
+    if (!current_context)
+        current_context = DS_DefaultContext();
+
+    return current_context;
+}
+
+/**
+ * Closes the given \a context (if needed) and frees its modules.
+ *
+ * \note The default context cannot be destroyed, use \c DS_Close() instead
+ */
+void DS_ContextDestroy (DS_Context* context)
+{
+    /* Context is invalid or it is the default context */
+    if (!context || context == DS_DefaultContext())
+        return;
+
+    /* Close the context in the calling thread */
+    DS_Context* previous = DS_CurrentContext();
+    DS_MakeCurrent (context);
+    DS_Close();
+    DS_MakeCurrent (previous == context ? NULL : previous);
+
+    /* Free the modules */
+    int i;
+    for (i = 0; i < DS_STATE_COUNT; ++i) {
+        if (modules [i]->free)
+            modules [i]->free (context->states [i]);
+
+        DS_FREE (context->states [i]);
+    }
+
+    DS_FREE (context);
+}
+
+/**
+ * Selects the \a context used by the \c DS_* functions in the calling
+ * thread. If \a context is \c NULL, the default context is selected.
+ */
+void DS_MakeCurrent (DS_Context* context)
+{
+    current_context = context;
+}
+
+/**
+ * Returns the state of the given module in the current context
+ */
+void* DS_ContextState (const DS_StateId id)
+{
+    assert (id >= 0 && id < DS_STATE_COUNT);
+    return DS_CurrentContext()->states [id];
+}
@@ -0,0 +1,498 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DS_Discovery.h"
+
+#include "LibDS.h"
+#include "DS_Utils.h"
+#include "DS_Timer.h"
+#include "DS_Client.h"
+#include "DS_Config.h"
+#include "DS_Context.h"
+#include "DS_Protocol.h"
+
+#include <socky.h>
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+
+#define USB_ADDRESS      "172.22.11.2" /* Robot address over USB */
+#define MAX_CANDIDATES   (4 + DS_DISCOVERY_USER_ADDRESSES)
+#define RESOLVE_INTERVAL    1000 /* Host name lookup interval while searching */
+#define REVALIDATE_INTERVAL 5000 /* Host name lookup interval once found */
+
+/*
+ * An address that may lead to the robot
+ */
+typedef struct {
+    char name [256];   /* Host name or numeric address */
+    char address [64]; /* Numeric IPv4 address, empty if not resolved yet */
+    int numeric;       /* 1 if the name is already a numeric address */
+} Candidate;
+
+/*
+ * Holds the robot discovery state of each context
+ */
+typedef struct {
+    /* Addresses that we probe while searching for the robot */
+    Candidate candidates [MAX_CANDIDATES];
+    int count;
+
+    /* Addresses added with DS_AddRobotAddress() */
+    char user [DS_DISCOVERY_USER_ADDRESSES][256];
+    int user_count;
+
+    /* Search state */
+    int searching;      /* 1 while no candidate has answered */
+    int64_t start_time; /* Time at which the search started */
+    int connect_time;   /* Time-to-connect of the last search (msecs) */
+    char locked [64];   /* Address of the last candidate that answered */
+
+    /* Host name resolver */
+    int running;        /* 1 while the resolver thread shall run */
+    int pending;        /* 1 if the candidates changed since the last lookup */
+    pthread_t resolver;
+
+    /* Protects the candidates, they are used by several threads */
+    pthread_mutex_t mutex;
+} Discovery;
+
+/**
+ * Initializes the mutex of the given \a ptr state
+ */
+static void init_state (void* ptr)
+{
+    pthread_mutex_init (&((Discovery*) ptr)->mutex, NULL);
+}
+
+/**
+ * Destroys the mutex of the given \a ptr state
+ */
+static void free_state (void* ptr)
+{
+    pthread_mutex_destroy (&((Discovery*) ptr)->mutex);
+}
+
+const DS_StateInfo Discovery_State = {
+    sizeof (Discovery), &init_state, &free_state
+};
+
+/**
+ * Returns the discovery state of the current context
+ */
+static Discovery* state (void)
+{
+    return (Discovery*) DS_ContextState (DS_STATE_DISCOVERY);
+}
+
+/**
+ * Looks up the given \a name and writes its first IPv4 address into
+ * \a address. If \a numeric is set, only numeric names are accepted (so
+ * that the function never blocks).
+ *
+ * \returns \c 1 on success, \c 0 on failure
+ */
+static int resolve (const char* name, char* address, const size_t len,
+                    const int numeric)
+{
+    struct addrinfo hints;
+    struct addrinfo* info = NULL;
+
+    memset (&hints, 0, sizeof (hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = numeric ? AI_NUMERICHOST : 0;
+
+    if (getaddrinfo (name, NULL, &hints, &info) != 0 || !info)
+        return 0;
+
+    int error = getnameinfo (info->ai_addr, (int) info->ai_addrlen,
+                             address, (int) len, NULL, 0, NI_NUMERICHOST);
+
+    freeaddrinfo (info);
+    return (error == 0);
+}
+
+/**
+ * Appends the given \a name to the candidate list (if it is not empty and
+ * is not already in the list). The resolved address of a host name is kept
+ * if the name was a candidate before the list was re-built.
+ */
+static void add_candidate (Discovery* ptr, const Candidate* previous,
+                           const int previous_count, const char* name)
+{
+    int i;
+
+    /* Ignore empty, fall back and repeated names */
+    if (!name || strlen (name) == 0 || strcmp (name, DS_FallBackAddress) == 0)
+        return;
+    for (i = 0; i < ptr->count; ++i) {
+        if (strcmp (ptr->candidates [i].name, name) == 0)
+            return;
+    }
+
+    /* List is full */
+    if (ptr->count >= MAX_CANDIDATES)
+        return;
+
+    /* Register the name */
+    Candidate* candidate = &ptr->candidates [ptr->count++];
+    memset (candidate, 0, sizeof (Candidate));
+    strncpy (candidate->name, name, sizeof (candidate->name) - 1);
+
+    /* Numeric addresses are resolved immediately */
+    candidate->numeric = resolve (name, candidate->address,
+                                  sizeof (candidate->address), 1);
+    if (candidate->numeric)
+        return;
+
+    /* Keep the last known address of the host name */
+    for (i = 0; i < previous_count; ++i) {
+        if (strcmp (previous [i].name, name) == 0) {
+            memcpy (candidate->address, previous [i].address,
+                    sizeof (candidate->address));
+            return;
+        }
+    }
+}
+
+/**
+ * Looks up the host names of the candidate list of the given \a ptr state,
+ * the mutex is only locked while reading or updating the list, so that a
+ * slow lookup (e.g. mDNS) does not block the probes sent to the other
+ * candidates.
+ */
+static void resolve_candidates (Discovery* ptr)
+{
+    int i;
+    int count = 0;
+    char names [MAX_CANDIDATES][256];
+
+    /* Get the names to look up */
+    pthread_mutex_lock (&ptr->mutex);
+    for (i = 0; i < ptr->count; ++i) {
+        if (!ptr->candidates [i].numeric)
+            memcpy (names [count++], ptr->candidates [i].name, 256);
+    }
+    ptr->pending = 0;
+    pthread_mutex_unlock (&ptr->mutex);
+
+    /* Look up each name and update the candidates that still use it */
+    for (i = 0; i < count; ++i) {
+        char address [64] = {0};
+        if (!resolve (names [i], address, sizeof (address), 0))
+            continue;
+
+        int j;
+        pthread_mutex_lock (&ptr->mutex);
+        for (j = 0; j < ptr->count; ++j) {
+            if (strcmp (ptr->candidates [j].name, names [i]) == 0)
+                memcpy (ptr->candidates [j].address, address, sizeof (address));
+        }
+        pthread_mutex_unlock (&ptr->mutex);
+    }
+}
+
+/**
+ * Looks up the host names of the candidates periodically, or as soon as
+ * the candidate list changes. The lookups continue (less often) after the
+ * robot has been found, so that the addresses of the candidates are still
+ * valid if the robot is lost (e.g. it got a new address from the radio).
+ */
+static void* run_resolver (void* data)
+{
+    Discovery* ptr = (Discovery*) data;
+
+    while (ptr->running) {
+        resolve_candidates (ptr);
+
+        /* Wait for the next lookup */
+        int i;
+        int interval = ptr->searching ? RESOLVE_INTERVAL : REVALIDATE_INTERVAL;
+        for (i = 0; i < interval / 50; ++i) {
+            if (!ptr->running || ptr->pending)
+                break;
+
+            DS_Sleep (50);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts the host name resolver of the current context
+ */
+void Discovery_Init (void)
+{
+    Discovery* ptr = state();
+
+    /* Reset the search state */
+    ptr->count = 0;
+    ptr->searching = 0;
+    ptr->connect_time = -1;
+    memset (ptr->locked, 0, sizeof (ptr->locked));
+
+    /* Host names are not looked up in step mode, a lookup may block */
+    if (DS_StepMode())
+        return;
+
+    /* Start the resolver thread */
+    ptr->running = 1;
+    int error = pthread_create (&ptr->resolver, NULL, &run_resolver, ptr);
+    if (error)
+        ptr->running = 0;
+}
+
+/**
+ * Stops the host name resolver of the current context.
+ *
+ * \note This function waits for the lookup in progress (if any) to finish
+ */
+void Discovery_Close (void)
+{
+    Discovery* ptr = state();
+
+    if (ptr->running) {
+        ptr->running = 0;
+        pthread_join (ptr->resolver, NULL);
+    }
+
+    ptr->count = 0;
+    ptr->searching = 0;
+}
+
+/**
+ * Re-builds the candidate list and starts searching for the robot (if we
+ * are not searching already). This function is called when the protocol,
+ * the team number or the robot address changes, and when the robot
+ * watchdog expires (in which case \a watchdog is set to \c 1).
+ *
+ * The candidates are (in order):
+ *    - The address of the robot found by the last search (only if the
+ *      robot watchdog expired, the address is forgotten otherwise)
+ *    - The custom robot address
+ *    - The robot address of the current protocol (e.g. its mDNS name)
+ *    - The static address of the robot (10.TE.AM.2)
+ *    - The USB address of the robot (172.22.11.2)
+ *    - The addresses added with \c DS_AddRobotAddress()
+ *
+ * \note In step mode, only the numeric addresses are probed
+ */
+void Discovery_Reset (const int watchdog)
+{
+    int i;
+    Discovery* ptr = state();
+    Candidate previous [MAX_CANDIDATES];
+
+    /* Get the addresses */
+    char* custom = DS_GetCustomRobotAddress();
+    DS_String fallback = DS_StrNew (DS_FallBackAddress);
+    DS_String protocol = DS_CurrentProtocol() ?
+                         DS_CurrentProtocol()->robot_address() : fallback;
+    DS_String static_ip = DS_GetStaticIP (10, CFG_GetTeamNumber(), 2);
+    char* protocol_str = DS_StrToChar (&protocol);
+    char* static_str = DS_StrToChar (&static_ip);
+
+    /* Re-build the candidate list */
+    pthread_mutex_lock (&ptr->mutex);
+    int previous_count = ptr->count;
+    memcpy (previous, ptr->candidates, sizeof (previous));
+
+    /* The last robot address is not valid for another configuration */
+    if (!watchdog)
+        memset (ptr->locked, 0, sizeof (ptr->locked));
+
+    ptr->count = 0;
+    add_candidate (ptr, previous, previous_count, ptr->locked);
+    add_candidate (ptr, previous, previous_count, custom);
+    add_candidate (ptr, previous, previous_count, protocol_str);
+    add_candidate (ptr, previous, previous_count, static_str);
+    add_candidate (ptr, previous, previous_count, USB_ADDRESS);
+    for (i = 0; i < ptr->user_count; ++i)
+        add_candidate (ptr, previous, previous_count, ptr->user [i]);
+
+    /* Start searching */
+    if (!ptr->searching) {
+        ptr->searching = 1;
+        ptr->connect_time = -1;
+        ptr->start_time = DS_Now();
+    }
+
+    ptr->pending = 1;
+    pthread_mutex_unlock (&ptr->mutex);
+
+    /* Free the addresses */
+    DS_FREE (custom);
+    DS_FREE (static_str);
+    DS_FREE (protocol_str);
+    DS_StrRmBuf (&static_ip);
+    DS_StrRmBuf (&fallback);
+    if (DS_CurrentProtocol())
+        DS_StrRmBuf (&protocol);
+}
+
+/**
+ * Returns \c 1 while no candidate has answered with a valid robot packet
+ */
+int Discovery_Searching (void)
+{
+    return state()->searching;
+}
+
+/**
+ * Sends the given \a data to every resolved candidate using the given
+ * \a socket, so that all the candidates are probed in parallel.
+ *
+ * \returns the total number of bytes written
+ */
+int Discovery_Probe (const DS_Socket* socket, const DS_String* data)
+{
+    int i, j;
+    int count = 0;
+    int bytes = 0;
+    Discovery* ptr = state();
+    char addresses [MAX_CANDIDATES][64];
+
+    /* Only UDP sockets can probe several addresses */
+    if (socket->type != DS_SOCKET_UDP)
+        return DS_Max (DS_SocketSend (socket, data), 0);
+
+    /* Get the resolved addresses (without repeating them) */
+    pthread_mutex_lock (&ptr->mutex);
+    for (i = 0; i < ptr->count; ++i) {
+        const char* address = ptr->candidates [i].address;
+        if (strlen (address) == 0)
+            continue;
+
+        int repeated = 0;
+        for (j = 0; j < count; ++j)
+            repeated |= (strcmp (addresses [j], address) == 0);
+
+        if (!repeated)
+            memcpy (addresses [count++], address, 64);
+    }
+    pthread_mutex_unlock (&ptr->mutex);
+
+    /* Send the data to each address */
+    for (i = 0; i < count; ++i)
+        bytes += DS_Max (DS_SocketSendTo (socket, data, addresses [i]), 0);
+
+    return bytes;
+}
+
+/**
+ * Called when the given robot \a socket has received a valid packet. If we
+ * are still searching, the sender of the packet becomes the robot address
+ * and the time-to-connect is reported.
+ *
+ * Once the robot is found, each valid packet re-validates its address (by
+ * feeding the robot watchdog), while the resolver keeps looking up the
+ * host names of the other candidates. If the robot stops answering, the
+ * watchdog expires and the search starts again with every candidate.
+ */
+void Discovery_PacketRead (DS_Socket* socket)
+{
+    Discovery* ptr = state();
+
+    /* We already found the robot or do not know the sender */
+    if (!ptr->searching || strlen (socket->info.peer) == 0)
+        return;
+
+    /* Lock onto the sender */
+    pthread_mutex_lock (&ptr->mutex);
+    ptr->searching = 0;
+    ptr->connect_time = (int) ((DS_Now() - ptr->start_time) / 1000000);
+    snprintf (ptr->locked, sizeof (ptr->locked), "%s", socket->info.peer);
+    pthread_mutex_unlock (&ptr->mutex);
+
+    /* Send the next packets only to the robot */
+    DS_SocketChangeAddress (socket, ptr->locked);
+
+    /* Report the time-to-connect */
+    DS_String str = DS_StrFormat ("Found robot at %s after %d ms",
+                                  ptr->locked, ptr->connect_time);
+    CFG_AddNotification (&str);
+    DS_StrRmBuf (&str);
+}
+
+/**
+ * Adds the given \a address (or host name) to the addresses that are probed
+ * while searching for the robot
+ */
+void DS_AddRobotAddress (const char* address)
+{
+    assert (address);
+    Discovery* ptr = state();
+
+    pthread_mutex_lock (&ptr->mutex);
+    if (ptr->user_count < DS_DISCOVERY_USER_ADDRESSES) {
+        char* user = ptr->user [ptr->user_count++];
+        memset (user, 0, 256);
+        strncpy (user, address, 255);
+    }
+    pthread_mutex_unlock (&ptr->mutex);
+
+    CFG_ReconfigureAddresses (RECONFIGURE_ROBOT);
+}
+
+/**
+ * Removes the addresses added with \c DS_AddRobotAddress()
+ */
+void DS_ClearRobotAddresses (void)
+{
+    Discovery* ptr = state();
+
+    pthread_mutex_lock (&ptr->mutex);
+    ptr->user_count = 0;
+    pthread_mutex_unlock (&ptr->mutex);
+
+    CFG_ReconfigureAddresses (RECONFIGURE_ROBOT);
+}
+
+/**
+ * Returns the time (in msecs) that it took to find the robot since the
+ * search started, or \c -1 if we are still searching
+ */
+int DS_GetRobotDiscoveryTime (void)
+{
+    return state()->connect_time;
+}
+
+/**
+ * Returns the numeric address of the robot found by the discovery, the
+ * string is empty while we are still searching
+ */
+char* DS_GetDiscoveredRobotAddress (void)
+{
+    Discovery* ptr = state();
+
+    pthread_mutex_lock (&ptr->mutex);
+    DS_String str = DS_StrNew (ptr->searching ? "" : ptr->locked);
+    pthread_mutex_unlock (&ptr->mutex);
+
+    char* address = DS_StrToChar (&str);
+    DS_StrRmBuf (&str);
+    return address;
+}
@@ -23,19 +23,35 @@
 
 #include "DS_Queue.h"
 #include "DS_Events.h"
+#include "DS_Context.h"
 
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
 
-static DS_Queue events;
+/*
+ * Holds the event queue of each context
+ */
+typedef struct {
+    DS_Queue queue;
+} Events;
+
+const DS_StateInfo Events_State = {sizeof (Events), NULL, NULL};
+
+/**
+ * Returns the event queue of the current context
+ */
+static DS_Queue* events (void)
+{
+    return &((Events*) DS_ContextState (DS_STATE_EVENTS))->queue;
+}
 
 /**
  * Initializes the event queue with an initial support for 50 events
  */
 void Events_Init (void)
 {
-    DS_QueueInit (&events, 50, sizeof (DS_Event));
+    DS_QueueInit (events(), 50, sizeof (DS_Event));
 }
 
 /**
@@ -43,7 +59,7 @@ void Events_Init (void)
  */
 void Events_Close (void)
 {
-    DS_QueueFree (&events);
+    DS_QueueFree (events());
 }
 
 /**
@@ -54,7 +70,7 @@ void Events_Close (void)
 void DS_AddEvent (DS_Event* event)
 {
     assert (event);
-    DS_QueuePush (&events, (void*) event);
+    DS_QueuePush (events(), (void*) event);
 }
 
 /**
@@ -67,10 +83,10 @@ void DS_AddEvent (DS_Event* event)
  */
 int DS_PollEvent (DS_Event* event)
 {
-    DS_Event* front = (DS_Event*) DS_QueueGetFirst (&events);
+    DS_Event* front = (DS_Event*) DS_QueueGetFirst (events());
 
     if (front) {
-        DS_QueuePop (&events);
+        DS_QueuePop (events());
         memcpy (event, front, sizeof (DS_Event));
         return 1;
     }
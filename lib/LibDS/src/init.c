@@ -23,24 +23,58 @@
 
 #include "LibDS.h"
 #include "DS_Config.h"
+#include "DS_Context.h"
 
-static int init = 0;
+#include <pthread.h>
+
+/*
+ * Initialized state of each context
+ */
+typedef struct {
+    int init;
+} Init;
+
+const DS_StateInfo Init_State = {sizeof (Init), NULL, NULL};
+
+/*
+ * The timers and sockets modules are shared by all the contexts, they are
+ * initialized with the first context and closed with the last one
+ */
+static int contexts = 0;
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns the initialized state of the current context
+ */
+static Init* state (void)
+{
+    return (Init*) DS_ContextState (DS_STATE_INIT);
+}
 
 /**
  * Initializes all the modules of the LibDS library, you should call this
  * function before your application begins interacting with the different
  * modules of the LibDS.
+ *
+ * \note Only the current context (see \c DS_MakeCurrent()) is initialized
  */
 void DS_Init (void)
 {
     if (!DS_Initialized()) {
-        init = 1;
+        state()->init = 1;
+
+        pthread_mutex_lock (&mutex);
+        if (contexts++ == 0) {
+            Timers_Init();
+            Sockets_Init();
+        }
+        pthread_mutex_unlock (&mutex);
 
-        Timers_Init();
         Client_Init();
         Events_Init();
-        Sockets_Init();
+        Latency_Init();
         Joysticks_Init();
+        Discovery_Init();
         Protocols_Init();
     }
 }
@@ -54,15 +88,42 @@ void DS_Init (void)
 void DS_Close (void)
 {
     if (DS_Initialized()) {
-        init = 0;
+        state()->init = 0;
 
-        Timers_Close();
-        Sockets_Close();
         Protocols_Close();
+        Discovery_Close();
         Joysticks_Close();
+        Latency_Close();
 
         Events_Close();
         Client_Close();
+
+        pthread_mutex_lock (&mutex);
+        if (--contexts == 0) {
+            Timers_Close();
+            Sockets_Close();
+        }
+        pthread_mutex_unlock (&mutex);
+    }
+}
+
+/**
+ * Advances the current context by the given number of \a millisecs, in
+ * steps of one millisecond. Each step advances the clock and the timers,
+ * sends the packets that are due, reads the received packets and checks
+ * the watchdogs.
+ *
+ * \note This function only works in step mode (see \c DS_SetStepMode())
+ */
+void DS_Step (const int millisecs)
+{
+    if (!DS_Initialized() || !DS_StepMode())
+        return;
+
+    int i;
+    for (i = 0; i < millisecs; ++i) {
+        Timers_Step (1);
+        Protocols_Step (1);
     }
 }
 
@@ -71,7 +132,7 @@ void DS_Close (void)
  */
 int DS_Initialized (void)
 {
-    return init;
+    return state()->init;
 }
 
 /**
@@ -23,7 +23,9 @@
 
 #include "DS_Array.h"
 #include "DS_Config.h"
+#include "DS_Utils.h"
 #include "DS_Events.h"
+#include "DS_Context.h"
 #include "DS_Joysticks.h"
 
 #include <stdio.h>
@@ -40,10 +42,22 @@ typedef struct _joystick {
     int num_buttons; /**< The number of buttons of the joystick */
 } DS_Joystick;
 
+/*
+ * Holds the joysticks of each context
+ */
+typedef struct {
+    DS_Array array;
+} Joysticks;
+
+const DS_StateInfo Joysticks_State = {sizeof (Joysticks), NULL, NULL};
+
 /**
- * Holds all the joysticks
+ * Returns the joystick array of the current context
  */
-static DS_Array array;
+static DS_Array* joysticks (void)
+{
+    return &((Joysticks*) DS_ContextState (DS_STATE_JOYSTICKS))->array;
+}
 
 /**
  * Registers a joystick event to the LibDS event system
@@ -62,8 +76,9 @@ static void register_event()
  */
 static DS_Joystick* get_joystick (int joystick)
 {
-    if ((int) array.used > joystick)
-        return (DS_Joystick*) array.data [joystick];
+    DS_Array* array = joysticks();
+    if ((int) array->used > joystick)
+        return (DS_Joystick*) array->data [joystick];
 
     return NULL;
 }
@@ -79,12 +94,65 @@ static int joystick_exists (int joystick)
     return 0;
 }
 
+/**
+ * Allocates a new joystick with the given number of \a axes, \a hats and
+ * \a buttons, all its values are set to a neutral state.
+ * If the joystick is empty, this function shall return \c NULL
+ */
+static DS_Joystick* create_joystick (const int axes, const int hats,
+                                     const int buttons)
+{
+    /* Joystick is empty */
+    if (axes <= 0 && hats <= 0 && buttons <= 0)
+        return NULL;
+
+    /* Allocate memory for a new joystick */
+    DS_Joystick* joystick = (DS_Joystick*) calloc (1, sizeof (DS_Joystick));
+
+    /* Set joystick properties */
+    joystick->num_axes = axes;
+    joystick->num_hats = hats;
+    joystick->num_buttons = buttons;
+
+    /* Set joystick value arrays */
+    joystick->hats = calloc (hats, sizeof (int));
+    joystick->axes = calloc (axes, sizeof (float));
+    joystick->buttons = calloc (buttons, sizeof (int));
+
+    return joystick;
+}
+
+/**
+ * De-allocates the value arrays of the given \a joystick, the joystick
+ * structure itself is freed by the array
+ */
+static void free_joystick_values (DS_Joystick* joystick)
+{
+    if (joystick) {
+        DS_FREE (joystick->hats);
+        DS_FREE (joystick->axes);
+        DS_FREE (joystick->buttons);
+    }
+}
+
+/**
+ * De-allocates every registered joystick and the joystick array
+ */
+static void free_joysticks (void)
+{
+    int i;
+    for (i = 0; i < (int) joysticks()->used; ++i)
+        free_joystick_values (get_joystick (i));
+
+    DS_ArrayFree (joysticks());
+}
+
 /**
  * Initializes the joystick array, with an initial support for 6 joysticks
  */
 void Joysticks_Init (void)
 {
-    DS_ArrayInit (&array, 6);
+    DS_ArrayInit (joysticks(), 6);
 }
 
 /**
@@ -92,7 +160,7 @@ void Joysticks_Init (void)
  */
 void Joysticks_Close (void)
 {
-    DS_ArrayFree (&array);
+    free_joysticks();
     register_event();
 }
 
@@ -101,7 +169,7 @@ void Joysticks_Close (void)
  */
 int DS_GetJoystickCount (void)
 {
-    return (int) array.used;
+    return (int) joysticks()->used;
 }
 
 /**
@@ -205,8 +273,8 @@ int DS_GetJoystickButton (int joystick, int button)
  */
 void DS_JoysticksReset (void)
 {
-    DS_ArrayFree (&array);
-    DS_ArrayInit (&array, 6);
+    free_joysticks();
+    DS_ArrayInit (joysticks(), 6);
 
     register_event();
 }
@@ -218,27 +286,73 @@ void DS_JoysticksReset (void)
  */
 void DS_JoysticksAdd (const int axes, const int hats, const int buttons)
 {
+    DS_Joystick* joystick = create_joystick (axes, hats, buttons);
+
     /* Joystick is empty */
-    if (axes <= 0 && hats <= 0 && buttons <= 0) {
+    if (!joystick) {
         fprintf (stderr, "DS_JoystickAdd: Cannot register empty joystick!\n");
         return;
     }
 
-    /* Allocate memory for a new joystick */
-    DS_Joystick* joystick = (DS_Joystick*) calloc (1, sizeof (DS_Joystick));
+    /* Register the new joystick in the joystick list */
+    DS_ArrayInsert (joysticks(), (void*) joystick);
 
-    /* Set joystick properties */
-    joystick->num_axes = axes;
-    joystick->num_hats = hats;
-    joystick->num_buttons = buttons;
+    /* Emit the joystick count changed event */
+    register_event();
+}
 
-    /* Set joystick value arrays */
-    joystick->hats = calloc (hats, sizeof (int));
-    joystick->axes = calloc (axes, sizeof (float));
-    joystick->buttons = calloc (buttons, sizeof (int));
+/**
+ * Registers a joystick with the given number of \a axes, \a hats and
+ * \a buttons in the given \a joystick slot, without changing the other
+ * slots. If the slot is used, its joystick is replaced. If the slot does
+ * not exist, the slots between the last joystick and the new joystick are
+ * left empty.
+ */
+void DS_JoysticksSet (const int joystick, const int axes, const int hats,
+                      const int buttons)
+{
+    DS_Joystick* stick = create_joystick (axes, hats, buttons);
 
-    /* Register the new joystick in the joystick list */
-    DS_ArrayInsert (&array, (void*) joystick);
+    /* Joystick is empty or slot is invalid */
+    if (!stick || joystick < 0) {
+        free_joystick_values (stick);
+        DS_FREE (stick);
+        fprintf (stderr, "DS_JoysticksSet: Cannot register joystick!\n");
+        return;
+    }
+
+    /* Create empty slots (if needed) */
+    DS_Array* array = joysticks();
+    while ((int) array->used <= joystick)
+        DS_ArrayInsert (array, NULL);
+
+    /* Replace the joystick of the slot */
+    free_joystick_values (get_joystick (joystick));
+    DS_FREE (array->data [joystick]);
+    array->data [joystick] = (void*) stick;
+
+    /* Emit the joystick count changed event */
+    register_event();
+}
+
+/**
+ * Removes the joystick in the given \a joystick slot, the slot is left empty
+ * so that the other joysticks keep their slots. Empty slots at the end of
+ * the joystick list are removed.
+ */
+void DS_JoysticksRemove (const int joystick)
+{
+    if (!joystick_exists (joystick))
+        return;
+
+    /* Free the joystick and leave the slot empty */
+    DS_Array* array = joysticks();
+    free_joystick_values (get_joystick (joystick));
+    DS_FREE (array->data [joystick]);
+
+    /* Remove empty slots at the end of the list */
+    while (array->used > 0 && array->data [array->used - 1] == NULL)
+        --array->used;
 
     /* Emit the joystick count changed event */
     register_event();
@@ -0,0 +1,293 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "DS_Latency.h"
+
+#include "DS_Utils.h"
+#include "DS_Timer.h"
+#include "DS_Context.h"
+
+#include <string.h>
+#include <pthread.h>
+
+/*
+ * Holds the latency measurements of each context
+ */
+typedef struct {
+    /* Holds the histogram of each stage */
+    DS_LatencyHistogram histograms [DS_LATENCY_STAGES];
+
+    /* Time of the oldest input event that has not been sent yet, and the
+     * time at which it was applied with DS_SetJoystick*() */
+    int64_t input_time;
+    int64_t applied_time;
+
+    /* Time at which the last robot packet with new input was encoded */
+    int64_t encode_time;
+
+    /* Time at which the robot packet that is being encoded was started,
+     * and set if the protocol added the joystick values to the packet */
+    int64_t encode_start;
+    int input_encoded;
+
+    /* Time at which the last robot packet was sent, cleared when the
+     * robot answers it */
+    int64_t sent_time;
+
+    /* Protects the histograms, the input can be applied from any thread */
+    pthread_mutex_t mutex;
+} Latency;
+
+/**
+ * Initializes the mutex of the given \a ptr state
+ */
+static void init_state (void* ptr)
+{
+    pthread_mutex_init (&((Latency*) ptr)->mutex, NULL);
+}
+
+/**
+ * Destroys the mutex of the given \a ptr state
+ */
+static void free_state (void* ptr)
+{
+    pthread_mutex_destroy (&((Latency*) ptr)->mutex);
+}
+
+const DS_StateInfo Latency_State = {sizeof (Latency), &init_state, &free_state};
+
+/**
+ * Returns the latency measurements of the current context
+ */
+static Latency* state (void)
+{
+    return (Latency*) DS_ContextState (DS_STATE_LATENCY);
+}
+
+/**
+ * Registers the given \a latency (in nsecs) to the histogram of the given
+ * \a stage, must be called with the mutex locked
+ */
+static void add_sample (Latency* ptr, const DS_LatencyStage stage,
+                        const int64_t latency)
+{
+    DS_LatencyHistogram* histogram = &ptr->histograms [stage];
+    int64_t usecs = DS_Max (latency, 0) / 1000;
+
+    /* Get the bucket (the base-2 logarithm of the latency) */
+    int bucket = 0;
+    while (usecs > 1 && bucket < DS_LATENCY_BUCKETS - 1) {
+        usecs >>= 1;
+        ++bucket;
+    }
+
+    /* Update the histogram */
+    ++histogram->count;
+    ++histogram->buckets [bucket];
+    histogram->total += latency;
+    histogram->max = DS_Max (histogram->max, latency);
+}
+
+/**
+ * Clears the histograms and the pending input
+ */
+void Latency_Init (void)
+{
+    DS_ResetLatency();
+}
+
+/**
+ * Clears the histograms and the pending input
+ */
+void Latency_Close (void)
+{
+    DS_ResetLatency();
+}
+
+/**
+ * Called before a robot packet is encoded, the input applied after this
+ * point is not part of the packet
+ */
+void Latency_PacketEncoding (void)
+{
+    int64_t now = DS_LatencyNow();
+    Latency* latency = state();
+    pthread_mutex_lock (&latency->mutex);
+
+    latency->encode_start = now;
+    latency->input_encoded = 0;
+
+    pthread_mutex_unlock (&latency->mutex);
+}
+
+/**
+ * Called by the protocols when the joystick values are added to the robot
+ * packet that is being encoded
+ */
+void Latency_InputEncoded (void)
+{
+    Latency* latency = state();
+    pthread_mutex_lock (&latency->mutex);
+    latency->input_encoded = 1;
+    pthread_mutex_unlock (&latency->mutex);
+}
+
+/**
+ * Called when a robot packet has been encoded, the pending input (if any)
+ * is now part of a packet if the protocol added the joystick values to it
+ * and the input was applied before the encoding started
+ */
+void Latency_PacketEncoded (void)
+{
+    Latency* latency = state();
+    pthread_mutex_lock (&latency->mutex);
+
+    if (latency->input_time > 0 && latency->encode_time == 0
+            && latency->input_encoded
+            && latency->applied_time <= latency->encode_start) {
+        latency->encode_time = DS_LatencyNow();
+        add_sample (latency, DS_LATENCY_ENCODE,
+                    latency->encode_time - latency->applied_time);
+    }
+
+    pthread_mutex_unlock (&latency->mutex);
+}
+
+/**
+ * Called when a robot packet has been sent, the input that was encoded in
+ * the packet has now reached the network
+ */
+void Latency_PacketSent (void)
+{
+    int64_t now = DS_LatencyNow();
+    Latency* latency = state();
+    pthread_mutex_lock (&latency->mutex);
+
+    latency->sent_time = now;
+
+    if (latency->encode_time > 0) {
+        add_sample (latency, DS_LATENCY_SEND, now - latency->encode_time);
+        add_sample (latency, DS_LATENCY_TOTAL, now - latency->input_time);
+
+        latency->input_time = 0;
+        latency->encode_time = 0;
+        latency->applied_time = 0;
+    }
+
+    pthread_mutex_unlock (&latency->mutex);
+}
+
+/**
+ * Called when a valid robot packet has been decoded, the \a arrival_time is
+ * the time at which the packet was received by the system (which is given
+ * by the kernel if possible). The round trip assumes that the robot answers
+ * each packet before we send the next one.
+ */
+void Latency_PacketReceived (const int64_t arrival_time)
+{
+    Latency* latency = state();
+    pthread_mutex_lock (&latency->mutex);
+
+    add_sample (latency, DS_LATENCY_QUEUE, DS_LatencyNow() - arrival_time);
+
+    if (latency->sent_time > 0 && arrival_time >= latency->sent_time) {
+        add_sample (latency, DS_LATENCY_ROUND_TRIP,
+                    arrival_time - latency->sent_time);
+        latency->sent_time = 0;
+    }
+
+    pthread_mutex_unlock (&latency->mutex);
+}
+
+/**
+ * Returns the time of the clock of the current context (in nsecs), the
+ * input events must be timestamped with this clock
+ */
+int64_t DS_LatencyNow (void)
+{
+    return DS_Now();
+}
+
+/**
+ * Clears all the latency histograms
+ */
+void DS_ResetLatency (void)
+{
+    Latency* latency = state();
+    pthread_mutex_lock (&latency->mutex);
+
+    memset (latency->histograms, 0, sizeof (latency->histograms));
+    latency->input_time = 0;
+    latency->encode_time = 0;
+    latency->applied_time = 0;
+    latency->sent_time = 0;
+    latency->encode_start = 0;
+    latency->input_encoded = 0;
+
+    pthread_mutex_unlock (&latency->mutex);
+}
+
+/**
+ * Registers an input event that occurred at the given \a event_time (as
+ * given by \c DS_LatencyNow()) and has just been applied with the
+ * \c DS_SetJoystick*() functions.
+ *
+ * Only the oldest input that has not been sent is tracked through the
+ * encode and send stages, since it is the one that waits the longest.
+ */
+void DS_LatencyInput (const int64_t event_time)
+{
+    int64_t now = DS_LatencyNow();
+    Latency* latency = state();
+
+    pthread_mutex_lock (&latency->mutex);
+
+    add_sample (latency, DS_LATENCY_INPUT, now - event_time);
+
+    if (latency->input_time == 0) {
+        latency->input_time = event_time;
+        latency->applied_time = now;
+    }
+
+    pthread_mutex_unlock (&latency->mutex);
+}
+
+/**
+ * Copies the latency histogram of the given \a stage to \a histogram
+ */
+void DS_GetLatencyHistogram (const DS_LatencyStage stage,
+                             DS_LatencyHistogram* histogram)
+{
+    if (!histogram)
+        return;
+
+    if (stage < 0 || stage >= DS_LATENCY_STAGES) {
+        memset (histogram, 0, sizeof (DS_LatencyHistogram));
+        return;
+    }
+
+    Latency* latency = state();
+    pthread_mutex_lock (&latency->mutex);
+    *histogram = latency->histograms [stage];
+    pthread_mutex_unlock (&latency->mutex);
+}
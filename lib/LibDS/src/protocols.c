@@ -25,9 +25,13 @@
 #include "DS_Timer.h"
 #include "DS_Client.h"
 #include "DS_Config.h"
+#include "DS_Context.h"
 #include "DS_Events.h"
 #include "DS_Socket.h"
+#include "DS_Latency.h"
+#include "DS_Realtime.h"
 #include "DS_Protocol.h"
+#include "DS_Discovery.h"
 
 #include <stdio.h>
 #include <assert.h>
@@ -35,8 +39,9 @@
 #include <string.h>
 #include <pthread.h>
 
-#define SEND_PRECISION 1  /* Update the sender timers every millisecond */
-#define RECV_PRECISION 50 /* Update the watchdogs every 50 milliseconds */
+#define SEND_PRECISION  1    /* Update the sender timers every millisecond */
+#define LOOP_INTERVAL   5    /* Maximum time between event loop iterations */
+#define RECOVERY_WINDOW 5000 /* Time to send packets at the recovery rate */
 
 /*
  * Used to re-assing to 'empty' structure
@@ -44,69 +49,179 @@
 static const DS_Protocol EmptyProtocol;
 
 /*
- * Protocol data
+ * Receiver watchdog, expires when no valid packet is read before its
+ * (absolute) deadline
  */
-static DS_Protocol protocol;
-static int enable_operations = 0;
+typedef struct {
+    int timeout;      /* Timeout in msecs, 0 disables the watchdog */
+    int64_t deadline; /* Time of the clock (in nsecs) at which it expires */
+} Watchdog;
 
 /*
- * Define the sender watchdogs (when one expires, we send a packet)
+ * Holds the protocol and the network state of each context
+ */
+typedef struct {
+    /* Protocol data */
+    DS_Protocol protocol;
+    int enable_operations;
+
+    /* Sender watchdogs (when one expires, we send a packet) */
+    DS_Timer fms_send_timer;
+    DS_Timer radio_send_timer;
+    DS_Timer robot_send_timer;
+
+    /* Receiver watchdogs (when one expires, comms are lost) */
+    Watchdog fms_watchdog;
+    Watchdog radio_watchdog;
+    Watchdog robot_watchdog;
+
+    /* Robot reconnection state, after the robot watchdog expires we send
+     * packets at the recovery interval until the robot answers again (or
+     * until the recovery window is over) */
+    int recovering;
+    int64_t recovery_start;
+    int recovery_time;
+
+    /* If set to anything else than 0, then the event loop will be allowed
+     * to run */
+    int running;
+
+    /* Protocol read success booleans (used to feed the watchdogs) */
+    int fms_read;
+    int radio_read;
+    int robot_read;
+
+    /* Holds the received data */
+    DS_String fms_data;
+    DS_String radio_data;
+    DS_String robot_data;
+    DS_String netcs_data;
+
+    /* Holds the sent/received packets */
+    int sent_fms_packets;
+    int sent_radio_packets;
+    int sent_robot_packets;
+    int received_fms_packets;
+    int received_radio_packets;
+    int received_robot_packets;
+
+    /* Sent/received bytes */
+    unsigned long sent_fms_bytes;
+    unsigned long recv_fms_bytes;
+    unsigned long sent_radio_bytes;
+    unsigned long recv_radio_bytes;
+    unsigned long sent_robot_bytes;
+    unsigned long recv_robot_bytes;
+
+    /* The thread ID for the protocol event loop */
+    pthread_t event_thread;
+} Protocols;
+
+const DS_StateInfo Protocols_State = {sizeof (Protocols), NULL, NULL};
+
+/**
+ * Returns the protocol state of the current context
  */
-static DS_Timer fms_send_timer;
-static DS_Timer radio_send_timer;
-static DS_Timer robot_send_timer;
+static Protocols* protocols (void)
+{
+    return (Protocols*) DS_ContextState (DS_STATE_PROTOCOLS);
+}
 
-/*
- * Define the receiver watchdogs (when one expires, comms are lost)
+/**
+ * Returns the watchdog timeout (in msecs) for the given protocol \a timeout
+ * and packet \a interval. A \a timeout of \c 0 uses the default timeout
+ * (50 packets, up to one second) and a negative \a timeout disables the
+ * watchdog
  */
-static DS_Timer fms_recv_timer;
-static DS_Timer radio_recv_timer;
-static DS_Timer robot_recv_timer;
+static int watchdog_timeout (const int timeout, const int interval)
+{
+    if (timeout < 0)
+        return 0;
 
-/*
- * If set to anything else than 0, then the event loop will be allowed to run
+    if (timeout == 0)
+        return DS_Min (interval * 50, 1000);
+
+    return timeout;
+}
+
+/**
+ * Starts the given \a watchdog with the given \a timeout (in msecs)
  */
-static int running = 0;
+static void watchdog_start (Watchdog* watchdog, const int timeout)
+{
+    watchdog->timeout = DS_Max (timeout, 0);
+    watchdog->deadline = DS_Now() + (int64_t) watchdog->timeout * 1000000;
+}
 
-/*
- * Protocol read success booleans (used to feed the watchdogs)
+/**
+ * Moves the deadline of the given \a watchdog to one timeout from \a now
  */
-static int fms_read = 0;
-static int radio_read = 0;
-static int robot_read = 0;
+static void watchdog_feed (Watchdog* watchdog, const int64_t now)
+{
+    watchdog->deadline = now + (int64_t) watchdog->timeout * 1000000;
+}
 
-/*
- * Holds the received data
+/**
+ * Returns \c 1 if the given \a watchdog is enabled and its deadline has
+ * been reached at the given time (\a now)
  */
-static DS_String fms_data;
-static DS_String radio_data;
-static DS_String robot_data;
-static DS_String netcs_data;
+static int watchdog_expired (const Watchdog* watchdog, const int64_t now)
+{
+    return watchdog->timeout > 0 && now >= watchdog->deadline;
+}
 
-/*
- * Holds the sent/received packets
+/**
+ * Returns the number of nsecs between \a now and the deadline of the given
+ * \a watchdog, or \a limit if the watchdog expires later (or is disabled)
  */
-static int sent_fms_packets = 0;
-static int sent_radio_packets = 0;
-static int sent_robot_packets = 0;
-static int received_fms_packets = 0;
-static int received_radio_packets = 0;
-static int received_robot_packets = 0;
+static int64_t watchdog_remaining (const Watchdog* watchdog,
+                                   const int64_t now, const int64_t limit)
+{
+    if (watchdog->timeout <= 0)
+        return limit;
 
-/*
- * Sent/received bytes
+    return DS_Max (0, DS_Min (watchdog->deadline - now, limit));
+}
+
+/**
+ * Sends the robot packets at the recovery interval of the protocol, this
+ * function is called when the robot watchdog expires after the robot had
+ * communications
  */
-static unsigned long sent_fms_bytes = 0;
-static unsigned long recv_fms_bytes = 0;
-static unsigned long sent_radio_bytes = 0;
-static unsigned long recv_radio_bytes = 0;
-static unsigned long sent_robot_bytes = 0;
-static unsigned long recv_robot_bytes = 0;
+static void start_recovery (const int64_t now)
+{
+    Protocols* state = protocols();
 
-/*
- * The thread ID for the protocol event loop
+    if (state->protocol.robot_recovery_interval <= 0)
+        return;
+
+    state->recovering = 1;
+    state->recovery_time = -1;
+    state->recovery_start = now;
+    state->robot_send_timer.time = state->protocol.robot_recovery_interval;
+    state->robot_send_timer.expired = 1;
+}
+
+/**
+ * Restores the normal robot packet interval. If the robot answered, the
+ * time-to-recover is registered and reported.
  */
-static pthread_t event_thread;
+static void stop_recovery (const int64_t now, const int recovered)
+{
+    Protocols* state = protocols();
+
+    state->recovering = 0;
+    state->robot_send_timer.time = state->protocol.robot_interval;
+
+    if (recovered) {
+        state->recovery_time = (int) (DS_Max (now - state->recovery_start, 0) / 1000000);
+
+        DS_String str = DS_StrFormat ("Robot communications recovered after %d ms",
+                                      state->recovery_time);
+        CFG_AddNotification (&str);
+        DS_StrRmBuf (&str);
+    }
+}
 
 /**
  * Sends a new packet to the FMS, the generated data is immediatly deleted
@@ -114,10 +229,12 @@ static pthread_t event_thread;
  */
 static void send_fms_data()
 {
-    if (enable_operations) {
-        ++sent_fms_packets;
-        DS_String data = protocol.create_fms_packet();
-        sent_fms_bytes += DS_Max (DS_SocketSend (&protocol.fms_socket, &data), 0);
+    Protocols* state = protocols();
+
+    if (state->enable_operations) {
+        ++state->sent_fms_packets;
+        DS_String data = state->protocol.create_fms_packet();
+        state->sent_fms_bytes += DS_Max (DS_SocketSend (&state->protocol.fms_socket, &data), 0);
         DS_StrRmBuf (&data);
     }
 }
@@ -128,24 +245,37 @@ static void send_fms_data()
  */
 static void send_radio_data()
 {
-    if (enable_operations) {
-        ++sent_radio_packets;
-        DS_String data = protocol.create_radio_packet();
-        sent_radio_bytes += DS_Max (DS_SocketSend (&protocol.radio_socket, &data), 0);
+    Protocols* state = protocols();
+
+    if (state->enable_operations) {
+        ++state->sent_radio_packets;
+        DS_String data = state->protocol.create_radio_packet();
+        state->sent_radio_bytes += DS_Max (DS_SocketSend (&state->protocol.radio_socket, &data), 0);
         DS_StrRmBuf (&data);
     }
 }
 
 /**
  * Sends a new packet to the robot, the generated data is immediatly deleted
- * once the packet has been sent
+ * once the packet has been sent. While the robot has not been found, the
+ * packet is sent to every address that may lead to the robot.
  */
 static void send_robot_data()
 {
-    if (enable_operations) {
-        ++sent_robot_packets;
-        DS_String data = protocol.create_robot_packet();
-        sent_robot_bytes += DS_Max (DS_SocketSend (&protocol.robot_socket, &data), 0);
+    Protocols* state = protocols();
+
+    if (state->enable_operations) {
+        ++state->sent_robot_packets;
+        Latency_PacketEncoding();
+        DS_String data = state->protocol.create_robot_packet();
+        Latency_PacketEncoded();
+
+        if (Discovery_Searching())
+            state->sent_robot_bytes += Discovery_Probe (&state->protocol.robot_socket, &data);
+        else
+            state->sent_robot_bytes += DS_Max (DS_SocketSend (&state->protocol.robot_socket, &data), 0);
+
+        Latency_PacketSent();
         DS_StrRmBuf (&data);
     }
 }
@@ -156,26 +286,28 @@ static void send_robot_data()
  */
 static void send_data()
 {
+    Protocols* state = protocols();
+
     /* Protocol is NULL, abort */
-    if (!enable_operations)
+    if (!state->enable_operations)
         return;
 
     /* Send FMS packet */
-    if (fms_send_timer.expired) {
+    if (state->fms_send_timer.expired) {
         send_fms_data();
-        DS_TimerReset (&fms_send_timer);
+        DS_TimerReset (&state->fms_send_timer);
     }
 
     /* Send radio packet */
-    if (radio_send_timer.expired) {
+    if (state->radio_send_timer.expired) {
         send_radio_data();
-        DS_TimerReset (&radio_send_timer);
+        DS_TimerReset (&state->radio_send_timer);
     }
 
     /* Send robot packet */
-    if (robot_send_timer.expired) {
+    if (state->robot_send_timer.expired) {
         send_robot_data();
-        DS_TimerReset (&robot_send_timer);
+        DS_TimerReset (&state->robot_send_timer);
     }
 }
 
@@ -184,10 +316,12 @@ static void send_data()
  */
 static void clear_recv_data()
 {
-    DS_StrRmBuf (&fms_data);
-    DS_StrRmBuf (&radio_data);
-    DS_StrRmBuf (&robot_data);
-    DS_StrRmBuf (&netcs_data);
+    Protocols* state = protocols();
+
+    DS_StrRmBuf (&state->fms_data);
+    DS_StrRmBuf (&state->radio_data);
+    DS_StrRmBuf (&state->robot_data);
+    DS_StrRmBuf (&state->netcs_data);
 }
 
 /**
@@ -196,85 +330,140 @@ static void clear_recv_data()
  */
 static void recv_data()
 {
+    Protocols* state = protocols();
+
     /* Protocol is NULL, abort */
-    if (!enable_operations)
+    if (!state->enable_operations)
         return;
 
     /* Clear buffers (just to be sure) */
     clear_recv_data();
 
     /* Read data from sockets */
-    fms_data = DS_SocketRead (&protocol.fms_socket);
-    radio_data = DS_SocketRead (&protocol.radio_socket);
-    robot_data = DS_SocketRead (&protocol.robot_socket);
-    netcs_data = DS_SocketRead (&protocol.netconsole_socket);
+    state->fms_data = DS_SocketRead (&state->protocol.fms_socket);
+    state->radio_data = DS_SocketRead (&state->protocol.radio_socket);
+    state->robot_data = DS_SocketRead (&state->protocol.robot_socket);
+    state->netcs_data = DS_SocketRead (&state->protocol.netconsole_socket);
 
     /* Update received data indicators */
-    recv_fms_bytes += DS_StrLen (&fms_data);
-    recv_radio_bytes += DS_StrLen (&radio_data);
-    recv_robot_bytes += DS_StrLen (&robot_data);
+    state->recv_fms_bytes += DS_StrLen (&state->fms_data);
+    state->recv_radio_bytes += DS_StrLen (&state->radio_data);
+    state->recv_robot_bytes += DS_StrLen (&state->robot_data);
 
     /* Read FMS packet */
-    if (DS_StrLen (&fms_data) > 0) {
-        ++received_fms_packets;
-        fms_read = protocol.read_fms_packet (&fms_data);
-        CFG_SetFMSCommunications (fms_read);
+    if (DS_StrLen (&state->fms_data) > 0) {
+        ++state->received_fms_packets;
+        state->fms_read = state->protocol.read_fms_packet (&state->fms_data);
+        CFG_SetFMSCommunications (state->fms_read);
     }
 
     /* Read radio packet */
-    if (DS_StrLen (&radio_data) > 0) {
-        ++received_radio_packets;
-        radio_read = protocol.read_radio_packet (&radio_data);
-        CFG_SetRadioCommunications (radio_read);
+    if (DS_StrLen (&state->radio_data) > 0) {
+        ++state->received_radio_packets;
+        state->radio_read = state->protocol.read_radio_packet (&state->radio_data);
+        CFG_SetRadioCommunications (state->radio_read);
     }
 
     /* Read robot packet */
-    if (DS_StrLen (&robot_data) > 0) {
-        ++received_robot_packets;
-        robot_read = protocol.read_robot_packet (&robot_data);
-        CFG_SetRobotCommunications (robot_read);
+    if (DS_StrLen (&state->robot_data) > 0) {
+        ++state->received_robot_packets;
+        state->robot_read = state->protocol.read_robot_packet (&state->robot_data);
+
+        if (state->robot_read) {
+            Discovery_PacketRead (&state->protocol.robot_socket);
+            Latency_PacketReceived (state->protocol.robot_socket.info.rx_time);
+        }
+
+        CFG_SetRobotCommunications (state->robot_read);
     }
 
     /* Add NetConsole message to event system */
-    if (netcs_data.len > 0)
-        CFG_AddNetConsoleMessage (&netcs_data);
+    if (state->netcs_data.len > 0)
+        CFG_AddNetConsoleMessage (&state->netcs_data);
 
     /* Reset the data pointers */
     clear_recv_data();
 }
 
 /**
- * Feeds the watchdogs, updates them and checks if any of them has expired
+ * Feeds the watchdogs and checks if any of them has reached its deadline.
+ * An expired watchdog is re-armed, so that it expires again one timeout
+ * later if we still do not receive anything.
+ *
+ * The watchdogs are fed with the time at which the packets arrived (which
+ * is given by the kernel if possible), not with the time at which we read
+ * them, so that the timeouts do not depend on the load of the DS.
  */
 static void update_watchdogs()
 {
+    Protocols* state = protocols();
+    int64_t now = DS_Now();
+    int64_t fms_time = state->protocol.fms_socket.info.rx_time;
+    int64_t radio_time = state->protocol.radio_socket.info.rx_time;
+    int64_t robot_time = state->protocol.robot_socket.info.rx_time;
+
     /* Feed the watchdogs if packets are read */
-    if (fms_read)   DS_TimerReset (&fms_recv_timer);
-    if (radio_read) DS_TimerReset (&radio_recv_timer);
-    if (robot_read) DS_TimerReset (&robot_recv_timer);
+    if (state->fms_read)   watchdog_feed (&state->fms_watchdog, fms_time);
+    if (state->radio_read) watchdog_feed (&state->radio_watchdog, radio_time);
+    if (state->robot_read) watchdog_feed (&state->robot_watchdog, robot_time);
+
+    /* Leave the recovery state when the robot answers or when it takes
+     * too long to answer */
+    if (state->recovering) {
+        if (state->robot_read)
+            stop_recovery (robot_time, 1);
+        else if (now - state->recovery_start >= (int64_t) RECOVERY_WINDOW * 1000000)
+            stop_recovery (now, 0);
+    }
 
     /* Clear the read success values */
-    fms_read = 0;
-    radio_read = 0;
-    robot_read = 0;
+    state->fms_read = 0;
+    state->radio_read = 0;
+    state->robot_read = 0;
+
+    /* Watchdogs are only used while a protocol is loaded */
+    if (!state->enable_operations)
+        return;
 
     /* Reset the FMS if the watchdog expires */
-    if (fms_recv_timer.expired) {
+    if (watchdog_expired (&state->fms_watchdog, now)) {
         CFG_FMSWatchdogExpired();
-        DS_TimerReset (&fms_recv_timer);
+        watchdog_feed (&state->fms_watchdog, now);
     }
 
     /* Reset the radio if the watchdog expires */
-    if (radio_recv_timer.expired) {
+    if (watchdog_expired (&state->radio_watchdog, now)) {
         CFG_RadioWatchdogExpired();
-        DS_TimerReset (&radio_recv_timer);
+        watchdog_feed (&state->radio_watchdog, now);
     }
 
     /* Reset the robot if the watchdog expires */
-    if (robot_recv_timer.expired) {
+    if (watchdog_expired (&state->robot_watchdog, now)) {
+        if (CFG_GetRobotCommunications())
+            start_recovery (now);
+
         CFG_RobotWatchdogExpired();
-        DS_TimerReset (&robot_recv_timer);
+        watchdog_feed (&state->robot_watchdog, now);
+    }
+}
+
+/**
+ * Returns the number of msecs that the event loop can sleep before running
+ * again, which is \c LOOP_INTERVAL or less if a watchdog expires sooner
+ */
+static int next_iteration()
+{
+    Protocols* state = protocols();
+    int64_t now = DS_Now();
+    int64_t wait = (int64_t) LOOP_INTERVAL * 1000000;
+
+    if (state->enable_operations) {
+        wait = watchdog_remaining (&state->fms_watchdog, now, wait);
+        wait = watchdog_remaining (&state->radio_watchdog, now, wait);
+        wait = watchdog_remaining (&state->robot_watchdog, now, wait);
     }
+
+    return (int) ((wait + 999999) / 1000000);
 }
 
 /**
@@ -284,13 +473,31 @@ static void update_watchdogs()
  *    - Feed/reset the watchdogs
  *    - Check if any of the watchdogs has expired
  */
-static void* run_event_loop()
+static void process_events()
+{
+    send_data();
+    recv_data();
+    update_watchdogs();
+}
+
+/**
+ * Runs the event loop with the given \a context, which is the context that
+ * initialized the protocols module
+ */
+static void* run_event_loop (void* context)
 {
-    while (running) {
-        send_data();
-        recv_data();
-        update_watchdogs();
-        DS_Sleep (5);
+    DS_MakeCurrent ((DS_Context*) context);
+
+    DS_RealtimeThread realtime;
+    memset (&realtime, 0, sizeof (realtime));
+
+    while (protocols()->running) {
+        Realtime_Update (&realtime);
+        process_events();
+
+        int wait = next_iteration();
+        if (wait > 0)
+            DS_Sleep (wait);
     }
 
     return NULL;
@@ -301,8 +508,10 @@ static void* run_event_loop()
  */
 DS_Protocol* DS_CurrentProtocol()
 {
-    if (enable_operations)
-        return &protocol;
+    Protocols* state = protocols();
+
+    if (state->enable_operations)
+        return &state->protocol;
 
     return NULL;
 }
@@ -312,23 +521,24 @@ DS_Protocol* DS_CurrentProtocol()
  */
 void Protocols_Init()
 {
-    /* Initialize sender timers */
-    DS_TimerInit (&fms_send_timer,   0, SEND_PRECISION);
-    DS_TimerInit (&radio_send_timer, 0, SEND_PRECISION);
-    DS_TimerInit (&robot_send_timer, 0, SEND_PRECISION);
+    Protocols* state = protocols();
 
-    /* Initialize watchdog timers */
-    DS_TimerInit (&fms_recv_timer,   0, RECV_PRECISION);
-    DS_TimerInit (&radio_recv_timer, 0, RECV_PRECISION);
-    DS_TimerInit (&robot_recv_timer, 0, RECV_PRECISION);
+    /* Initialize sender timers */
+    DS_TimerInit (&state->fms_send_timer,   0, SEND_PRECISION);
+    DS_TimerInit (&state->radio_send_timer, 0, SEND_PRECISION);
+    DS_TimerInit (&state->robot_send_timer, 0, SEND_PRECISION);
 
     /* Allow the event loop to run */
-    running = 1;
-    enable_operations = 0;
+    state->running = 1;
+    state->enable_operations = 0;
+
+    /* The event loop is driven by DS_Step() */
+    if (DS_StepMode())
+        return;
 
     /* Configure the event thread */
-    int error = pthread_create (&event_thread, NULL,
-                                &run_event_loop, NULL);
+    int error = pthread_create (&state->event_thread, NULL,
+                                &run_event_loop, DS_CurrentContext());
 
     /* Display error message if we cannot star the event loop */
     if (error) {
@@ -348,36 +558,42 @@ void Protocols_Init()
  */
 static void close_protocol()
 {
+    Protocols* state = protocols();
+
     /* Protocol is empty, abort */
-    if (!enable_operations)
+    if (!state->enable_operations)
         return;
 
     /* Disable protocol operations */
-    enable_operations = 0;
+    state->enable_operations = 0;
 
     /* Stop sender timers */
-    DS_TimerStop (&fms_send_timer);
-    DS_TimerStop (&radio_send_timer);
-    DS_TimerStop (&robot_send_timer);
+    DS_TimerStop (&state->fms_send_timer);
+    DS_TimerStop (&state->radio_send_timer);
+    DS_TimerStop (&state->robot_send_timer);
+
+    /* Stop the robot recovery */
+    state->recovering = 0;
+    state->recovery_time = -1;
 
-    /* Stop receiver timers */
-    DS_TimerStop (&fms_recv_timer);
-    DS_TimerStop (&radio_recv_timer);
-    DS_TimerStop (&robot_recv_timer);
+    /* Stop the watchdogs */
+    watchdog_start (&state->fms_watchdog, 0);
+    watchdog_start (&state->radio_watchdog, 0);
+    watchdog_start (&state->robot_watchdog, 0);
 
     /* Close the sockets */
-    DS_SocketClose (&protocol.fms_socket);
-    DS_SocketClose (&protocol.radio_socket);
-    DS_SocketClose (&protocol.robot_socket);
-    DS_SocketClose (&protocol.netconsole_socket);
+    DS_SocketClose (&state->protocol.fms_socket);
+    DS_SocketClose (&state->protocol.radio_socket);
+    DS_SocketClose (&state->protocol.robot_socket);
+    DS_SocketClose (&state->protocol.netconsole_socket);
 
     /* Reset sent/recv bytes */
-    sent_fms_bytes = 0;
-    recv_fms_bytes = 0;
-    sent_radio_bytes = 0;
-    recv_radio_bytes = 0;
-    sent_robot_bytes = 0;
-    recv_robot_bytes = 0;
+    state->sent_fms_bytes = 0;
+    state->recv_fms_bytes = 0;
+    state->sent_radio_bytes = 0;
+    state->recv_radio_bytes = 0;
+    state->sent_robot_bytes = 0;
+    state->recv_robot_bytes = 0;
 
     /* Reset sent/recv packets */
     DS_ResetFMSPackets();
@@ -385,7 +601,7 @@ static void close_protocol()
     DS_ResetRobotPackets();
 
     /* Create notification string */
-    char* name = DS_StrToChar (&protocol.name);
+    char* name = DS_StrToChar (&state->protocol.name);
     DS_String str = DS_StrFormat ("Closed %s protocol", name);
     CFG_AddNotification (&str);
     DS_StrRmBuf (&str);
@@ -397,9 +613,39 @@ static void close_protocol()
  */
 void Protocols_Close()
 {
-    running = 0;
+    Protocols* state = protocols();
+
+    /* Stop the event loop and wait for it to finish */
+    state->running = 0;
+    if (!DS_StepMode())
+        pthread_join (state->event_thread, NULL);
+
+    /* Close the protocol */
     close_protocol();
     clear_recv_data();
+
+    /* Stop the timer threads */
+    DS_TimerClose (&state->fms_send_timer);
+    DS_TimerClose (&state->radio_send_timer);
+    DS_TimerClose (&state->robot_send_timer);
+}
+
+/**
+ * Advances the timers by the given number of \a millisecs and runs one
+ * iteration of the event loop, this function is called by \c DS_Step()
+ */
+void Protocols_Step (const int millisecs)
+{
+    Protocols* state = protocols();
+
+    /* Advance sender timers */
+    DS_TimerStep (&state->fms_send_timer, millisecs);
+    DS_TimerStep (&state->radio_send_timer, millisecs);
+    DS_TimerStep (&state->robot_send_timer, millisecs);
+
+    /* Run the event loop */
+    if (state->running)
+        process_events();
 }
 
 /**
@@ -412,6 +658,8 @@ void Protocols_Close()
  */
 void DS_ConfigureProtocol (const DS_Protocol* ptr)
 {
+    Protocols* state = protocols();
+
     /* Pointer is NULL, abort */
     assert (ptr != NULL);
 
@@ -419,41 +667,49 @@ void DS_ConfigureProtocol (const DS_Protocol* ptr)
     close_protocol();
 
     /* Re-assign the protocol */
-    protocol = *ptr;
+    state->protocol = *ptr;
 
     /* Update sockets */
-    DS_SocketOpen (&protocol.fms_socket);
-    DS_SocketOpen (&protocol.radio_socket);
-    DS_SocketOpen (&protocol.robot_socket);
-    DS_SocketOpen (&protocol.netconsole_socket);
+    DS_SocketOpen (&state->protocol.fms_socket);
+    DS_SocketOpen (&state->protocol.radio_socket);
+    DS_SocketOpen (&state->protocol.robot_socket);
+    DS_SocketOpen (&state->protocol.netconsole_socket);
 
     /* Update sender timers */
-    fms_send_timer.time = protocol.fms_interval;
-    radio_send_timer.time = protocol.radio_interval;
-    robot_send_timer.time = protocol.robot_interval;
-
-    /* Update watchdogs */
-    fms_recv_timer.time = DS_Min (protocol.fms_interval * 50, 1000);
-    radio_recv_timer.time = DS_Min (protocol.radio_interval * 50, 1000);
-    robot_recv_timer.time = DS_Min (protocol.robot_interval * 50, 1000);
+    state->fms_send_timer.time = state->protocol.fms_interval;
+    state->radio_send_timer.time = state->protocol.radio_interval;
+    state->robot_send_timer.time = state->protocol.robot_interval;
 
     /* Start the timers */
-    DS_TimerStart (&fms_send_timer);
-    DS_TimerStart (&fms_recv_timer);
-    DS_TimerStart (&radio_send_timer);
-    DS_TimerStart (&radio_recv_timer);
-    DS_TimerStart (&robot_send_timer);
-    DS_TimerStart (&robot_recv_timer);
+    DS_TimerStart (&state->fms_send_timer);
+    DS_TimerStart (&state->radio_send_timer);
+    DS_TimerStart (&state->robot_send_timer);
+
+    /* Start the watchdogs */
+    state->recovering = 0;
+    state->recovery_time = -1;
+    watchdog_start (&state->fms_watchdog,
+                    watchdog_timeout (state->protocol.fms_timeout,
+                                      state->protocol.fms_interval));
+    watchdog_start (&state->radio_watchdog,
+                    watchdog_timeout (state->protocol.radio_timeout,
+                                      state->protocol.radio_interval));
+    watchdog_start (&state->robot_watchdog,
+                    watchdog_timeout (state->protocol.robot_timeout,
+                                      state->protocol.robot_interval));
 
     /* Create notification string */
-    char* name = DS_StrToChar (&protocol.name);
+    char* name = DS_StrToChar (&state->protocol.name);
     DS_String str = DS_StrFormat ("Loaded %s protocol", name);
     CFG_AddNotification (&str);
     DS_StrRmBuf (&str);
     DS_FREE (name);
 
     /* Restore protocol operations */
-    enable_operations = 1;
+    state->enable_operations = 1;
+
+    /* Search for the robot */
+    Discovery_Reset (0);
 }
 
 /**
@@ -465,7 +721,7 @@ void DS_ConfigureProtocol (const DS_Protocol* ptr)
  */
 unsigned long DS_SentFMSBytes()
 {
-    return sent_fms_bytes;
+    return protocols()->sent_fms_bytes;
 }
 
 /**
@@ -477,7 +733,7 @@ unsigned long DS_SentFMSBytes()
  */
 unsigned long DS_SentRadioBytes()
 {
-    return sent_radio_bytes;
+    return protocols()->sent_radio_bytes;
 }
 
 /**
@@ -489,7 +745,7 @@ unsigned long DS_SentRadioBytes()
  */
 unsigned long DS_SentRobotBytes()
 {
-    return sent_robot_bytes;
+    return protocols()->sent_robot_bytes;
 }
 
 /**
@@ -501,7 +757,7 @@ unsigned long DS_SentRobotBytes()
  */
 unsigned long DS_ReceivedFMSBytes()
 {
-    return recv_fms_bytes;
+    return protocols()->recv_fms_bytes;
 }
 
 /**
@@ -513,7 +769,7 @@ unsigned long DS_ReceivedFMSBytes()
  */
 unsigned long DS_ReceivedRadioBytes()
 {
-    return recv_radio_bytes;
+    return protocols()->recv_radio_bytes;
 }
 
 /**
@@ -525,7 +781,7 @@ unsigned long DS_ReceivedRadioBytes()
  */
 unsigned long DS_ReceivedRobotBytes()
 {
-    return recv_robot_bytes;
+    return protocols()->recv_robot_bytes;
 }
 
 /**
@@ -536,7 +792,7 @@ unsigned long DS_ReceivedRobotBytes()
  */
 int DS_SentFMSPackets()
 {
-    return DS_Max (1, sent_fms_packets);
+    return DS_Max (1, protocols()->sent_fms_packets);
 }
 
 /**
@@ -547,7 +803,7 @@ int DS_SentFMSPackets()
  */
 int DS_SentRadioPackets()
 {
-    return DS_Max (1, sent_radio_packets);
+    return DS_Max (1, protocols()->sent_radio_packets);
 }
 
 /**
@@ -558,7 +814,7 @@ int DS_SentRadioPackets()
  */
 int DS_SentRobotPackets()
 {
-    return DS_Max (1, sent_robot_packets);
+    return DS_Max (1, protocols()->sent_robot_packets);
 }
 
 /**
@@ -569,7 +825,7 @@ int DS_SentRobotPackets()
  */
 int DS_ReceivedFMSPackets()
 {
-    return received_fms_packets;
+    return protocols()->received_fms_packets;
 }
 
 /**
@@ -580,7 +836,7 @@ int DS_ReceivedFMSPackets()
  */
 int DS_ReceivedRadioPackets()
 {
-    return received_radio_packets;
+    return protocols()->received_radio_packets;
 }
 
 /**
@@ -591,7 +847,17 @@ int DS_ReceivedRadioPackets()
  */
 int DS_ReceivedRobotPackets()
 {
-    return received_robot_packets;
+    return protocols()->received_robot_packets;
+}
+
+/**
+ * Returns the time (in msecs) between the last robot watchdog expiration
+ * and the first valid robot packet received after it, or \c -1 if the
+ * robot communications have not been recovered (or lost) yet
+ */
+int DS_RobotRecoveryTime()
+{
+    return protocols()->recovery_time;
 }
 
 /**
@@ -600,8 +866,10 @@ int DS_ReceivedRobotPackets()
  */
 void DS_ResetFMSPackets()
 {
-    sent_fms_packets = 0;
-    received_fms_packets = 0;
+    Protocols* state = protocols();
+
+    state->sent_fms_packets = 0;
+    state->received_fms_packets = 0;
 }
 
 /**
@@ -610,8 +878,10 @@ void DS_ResetFMSPackets()
  */
 void DS_ResetRadioPackets()
 {
-    sent_radio_packets = 0;
-    received_radio_packets = 0;
+    Protocols* state = protocols();
+
+    state->sent_radio_packets = 0;
+    state->received_radio_packets = 0;
 }
 
 /**
@@ -620,6 +890,8 @@ void DS_ResetRadioPackets()
  */
 void DS_ResetRobotPackets()
 {
-    sent_robot_packets = 0;
-    received_robot_packets = 0;
+    Protocols* state = protocols();
+
+    state->sent_robot_packets = 0;
+    state->received_robot_packets = 0;
 }
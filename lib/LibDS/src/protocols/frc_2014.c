@@ -25,6 +25,8 @@
 
 #include "DS_Utils.h"
 #include "DS_Config.h"
+#include "DS_Context.h"
+#include "DS_Latency.h"
 #include "DS_Protocol.h"
 #include "DS_Joysticks.h"
 #include "DS_DefaultProtocols.h"
@@ -50,9 +52,35 @@ static const uint8_t cFMSAutonomous    = 0x53;
 static const uint8_t cFMSTeleoperated  = 0x43;
 
 /*
- * Sent robot packet counters, they are used as packet IDs
+ * Holds the packet counters and control flags of each context
  */
-static unsigned int sent_robot_packets = 0;
+typedef struct {
+    /* Sent robot packet counter, used as packet ID */
+    unsigned int sent_robot_packets;
+
+    /* Control code flags */
+    int resync;
+    int reboot;
+    int restart_code;
+} FRC_2014;
+
+/**
+ * Sets the default values of the given \a ptr state
+ */
+static void init_state (void* ptr)
+{
+    ((FRC_2014*) ptr)->resync = 1;
+}
+
+const DS_StateInfo FRC_2014_State = {sizeof (FRC_2014), &init_state, NULL};
+
+/**
+ * Returns the protocol state of the current context
+ */
+static FRC_2014* state (void)
+{
+    return (FRC_2014*) DS_ContextState (DS_STATE_FRC_2014);
+}
 
 /*
  * Joystick properties
@@ -62,13 +90,6 @@ static int max_hats = 0;
 static int max_buttons = 10;
 static int max_joysticks = 4;
 
-/*
- * Control code flags
- */
-static int resync = 1;
-static int reboot = 0;
-static int restart_code = 0;
-
 /**
  * Gets the alliance type from the received \a byte
  * This function is used to update the robot configuration when receiving data
@@ -132,7 +153,7 @@ static uint8_t get_control_code (void)
     }
 
     /* Resync robot communications */
-    if (resync)
+    if (state()->resync)
         code |= cResyncComms;
 
     /* Let robot know if we are connected to FMS */
@@ -144,7 +165,7 @@ static uint8_t get_control_code (void)
         code = cEmergencyStopOn;
 
     /* Send the reboot code if required */
-    if (reboot)
+    if (state()->reboot)
         code = cRebootRobot;
 
     return code;
@@ -214,6 +235,9 @@ static DS_String get_joystick_data (void)
     int j = 0;
     DS_String buf = DS_StrNewLen (0);
 
+    /* Register the input latency of this packet */
+    Latency_InputEncoded();
+
     /* Add data for every joystick */
     for (i = 0; i < max_joysticks; ++i) {
         /* Add axis data */
@@ -292,8 +316,8 @@ static DS_String create_robot_packet (void)
     DS_String data = DS_StrNewLen (8);
 
     /* Add packet index */
-    DS_StrSetChar (&data, 0, (sent_robot_packets & 0xff00) >> 8);
-    DS_StrSetChar (&data, 1, (sent_robot_packets & 0xff));
+    DS_StrSetChar (&data, 0, (state()->sent_robot_packets & 0xff00) >> 8);
+    DS_StrSetChar (&data, 1, (state()->sent_robot_packets & 0xff));
 
     /* Add control code and digital inputs */
     DS_StrSetChar (&data, 2, get_control_code());
@@ -332,7 +356,7 @@ static DS_String create_robot_packet (void)
     DS_StrSetChar (&data, 1023, (checksum & 0xff));
 
     /* Increase sent robot packets */
-    ++sent_robot_packets;
+    ++state()->sent_robot_packets;
 
     /* Return address of data */
     return data;
@@ -412,6 +436,9 @@ int read_robot_packet (const DS_String* data)
     /* Assume that robot code is present (issue #31 in QDriverStation) */
     CFG_SetRobotCode (1);
 
+    /* The robot answered, stop asking it to resync */
+    state()->resync = 0;
+
     /* Packet read successfully */
     return 1;
 }
@@ -438,9 +465,10 @@ static void reset_radio (void)
  */
 static void reset_robot (void)
 {
-    resync = 1;
-    reboot = 0;
-    restart_code = 0;
+    FRC_2014* ptr = state();
+    ptr->resync = 1;
+    ptr->reboot = 0;
+    ptr->restart_code = 0;
 }
 
 /**
@@ -449,7 +477,7 @@ static void reset_robot (void)
  */
 static void reboot_robot (void)
 {
-    reboot = 1;
+    state()->reboot = 1;
 }
 
 /**
@@ -458,7 +486,7 @@ static void reboot_robot (void)
  */
 void restart_robot_code (void)
 {
-    restart_code = 1;
+    state()->restart_code = 1;
 }
 
 /**
@@ -502,6 +530,12 @@ DS_Protocol DS_GetProtocolFRC_2014 (void)
     protocol.radio_interval = 0;
     protocol.robot_interval = 20;
 
+    /* Set watchdog timeouts */
+    protocol.fms_timeout = 1000;
+    protocol.radio_timeout = 0;
+    protocol.robot_timeout = 1000;
+    protocol.robot_recovery_interval = 5;
+
     /* Set joystick properties */
     protocol.max_hat_count = max_hats;
     protocol.max_axis_count = max_axes;
@@ -514,6 +548,8 @@ DS_Protocol DS_GetProtocolFRC_2014 (void)
     protocol.fms_socket.in_port = 1120;
     protocol.fms_socket.out_port = 1160;
     protocol.fms_socket.type = DS_SOCKET_UDP;
+    protocol.fms_socket.qos.dscp = 46;
+    protocol.fms_socket.qos.priority = 6;
 
     /* Define radio socket properties */
     protocol.radio_socket = *DS_SocketEmpty();
@@ -525,6 +561,8 @@ DS_Protocol DS_GetProtocolFRC_2014 (void)
     protocol.robot_socket.in_port = 1150;
     protocol.robot_socket.out_port = 1110;
     protocol.robot_socket.type = DS_SOCKET_UDP;
+    protocol.robot_socket.qos.dscp = 46;
+    protocol.robot_socket.qos.priority = 6;
 
     /* Define netconsole socket properties */
     protocol.netconsole_socket = *DS_SocketEmpty();
@@ -23,6 +23,8 @@
 
 #include "DS_Utils.h"
 #include "DS_Config.h"
+#include "DS_Context.h"
+#include "DS_Latency.h"
 #include "DS_Protocol.h"
 #include "DS_Joysticks.h"
 #include "DS_DefaultProtocols.h"
@@ -71,17 +73,28 @@ static const uint8_t cRequestTime        = 0x01;
 static const uint8_t cRobotHasCode       = 0x20;
 
 /*
- * Sent robot and FMS packet counters
+ * Holds the packet counters and control flags of each context
  */
-static unsigned int send_time_data = 0;
-static unsigned int sent_fms_packets = 0;
-static unsigned int sent_robot_packets = 0;
+typedef struct {
+    /* Sent robot and FMS packet counters */
+    unsigned int send_time_data;
+    unsigned int sent_fms_packets;
+    unsigned int sent_robot_packets;
 
-/*
- * Control code flags
+    /* Control code flags */
+    int reboot;
+    int restart_code;
+} FRC_2015;
+
+const DS_StateInfo FRC_2015_State = {sizeof (FRC_2015), NULL, NULL};
+
+/**
+ * Returns the protocol state of the current context
  */
-static int reboot = 0;
-static int restart_code = 0;
+static FRC_2015* state (void)
+{
+    return (FRC_2015*) DS_ContextState (DS_STATE_FRC_2015);
+}
 
 /**
  * Obtains the voltage float from the given \a upper and \a lower bytes
@@ -205,9 +218,9 @@ static uint8_t get_request_code (void)
 
     /* Robot has comms, check if we need to send additional flags */
     if (CFG_GetRobotCommunications()) {
-        if (reboot)
+        if (state()->reboot)
             code = cRequestReboot;
-        else if (restart_code)
+        else if (state()->restart_code)
             code = cRequestRestartCode;
     }
 
@@ -348,6 +361,9 @@ static DS_String get_joystick_data (void)
     int j = 0;
     DS_String data = DS_StrNewLen (0);
 
+    /* Register the input latency of this packet */
+    Latency_InputEncoded();
+
     /* Generate data for each joystick */
     for (i = 0; i < DS_GetJoystickCount(); ++i) {
         DS_StrAppend (&data, get_joystick_size (i));
@@ -486,8 +502,8 @@ static DS_String create_fms_packet (void)
     encode_voltage (CFG_GetRobotVoltage(), &integer, &decimal);
 
     /* Add FMS packet count */
-    DS_StrSetChar (&data, 0, (sent_fms_packets >> 8));
-    DS_StrSetChar (&data, 1, (sent_fms_packets));
+    DS_StrSetChar (&data, 0, (state()->sent_fms_packets >> 8));
+    DS_StrSetChar (&data, 1, (state()->sent_fms_packets));
 
     /* Add DS version and FMS control code */
     DS_StrSetChar (&data, 2, cFMS_DS_Version);
@@ -502,7 +518,7 @@ static DS_String create_fms_packet (void)
     DS_StrSetChar (&data, 7, decimal);
 
     /* Increase FMS packet counter */
-    ++sent_fms_packets;
+    ++state()->sent_fms_packets;
 
     return data;
 }
@@ -532,8 +548,8 @@ static DS_String create_robot_packet (void)
     DS_String data = DS_StrNewLen (6);
 
     /* Add packet index */
-    DS_StrSetChar (&data, 0, (sent_robot_packets >> 8));
-    DS_StrSetChar (&data, 1, (sent_robot_packets));
+    DS_StrSetChar (&data, 0, (state()->sent_robot_packets >> 8));
+    DS_StrSetChar (&data, 1, (state()->sent_robot_packets));
 
     /* Add packet header */
     DS_StrSetChar (&data, 2, cTagGeneral);
@@ -544,19 +560,19 @@ static DS_String create_robot_packet (void)
     DS_StrSetChar (&data, 5, get_station_code());
 
     /* Add timezone data (if robot wants it) */
-    if (send_time_data) {
+    if (state()->send_time_data) {
         DS_String tz = get_timezone_data();
         DS_StrJoin (&data, &tz);
     }
 
-    /* Add joystick data */
-    else if (sent_robot_packets > 5) {
+    /* Add joystick data (once the robot answers) */
+    else if (CFG_GetRobotCommunications()) {
         DS_String js = get_joystick_data();
         DS_StrJoin (&data, &js);
     }
 
     /* Increase robot packet counter */
-    ++sent_robot_packets;
+    ++state()->sent_robot_packets;
 
     return data;
 }
@@ -643,7 +659,7 @@ static int read_robot_packet (const DS_String* data)
     CFG_SetEmergencyStopped (control & cEmergencyStop);
 
     /* Update date/time request flag */
-    send_time_data = (request == cRequestTime);
+    state()->send_time_data = (request == cRequestTime);
 
     /* Calculate the voltage */
     uint8_t upper = (uint8_t) DS_StrCharAt (data, 5);
@@ -679,9 +695,10 @@ static void reset_radio (void)
  */
 static void reset_robot (void)
 {
-    reboot = 0;
-    restart_code = 0;
-    send_time_data = 0;
+    FRC_2015* ptr = state();
+    ptr->reboot = 0;
+    ptr->restart_code = 0;
+    ptr->send_time_data = 0;
 }
 
 /**
@@ -689,7 +706,7 @@ static void reset_robot (void)
  */
 static void reboot_robot (void)
 {
-    reboot = 1;
+    state()->reboot = 1;
 }
 
 /**
@@ -698,7 +715,7 @@ static void reboot_robot (void)
  */
 static void restart_robot_code (void)
 {
-    restart_code = 1;
+    state()->restart_code = 1;
 }
 
 /**
@@ -742,6 +759,12 @@ DS_Protocol DS_GetProtocolFRC_2015 (void)
     protocol.radio_interval = 0;
     protocol.robot_interval = 20;
 
+    /* Set watchdog timeouts */
+    protocol.fms_timeout = 1000;
+    protocol.radio_timeout = 0;
+    protocol.robot_timeout = 1000;
+    protocol.robot_recovery_interval = 5;
+
     /* Set joystick properties */
     protocol.max_joysticks = 6;
     protocol.max_hat_count = 1;
@@ -754,6 +777,8 @@ DS_Protocol DS_GetProtocolFRC_2015 (void)
     protocol.fms_socket.in_port = 1120;
     protocol.fms_socket.out_port = 1160;
     protocol.fms_socket.type = DS_SOCKET_UDP;
+    protocol.fms_socket.qos.dscp = 46;
+    protocol.fms_socket.qos.priority = 6;
 
     /* Define radio socket properties */
     protocol.radio_socket = *DS_SocketEmpty();
@@ -765,6 +790,8 @@ DS_Protocol DS_GetProtocolFRC_2015 (void)
     protocol.robot_socket.in_port = 1150;
     protocol.robot_socket.out_port = 1110;
     protocol.robot_socket.type = DS_SOCKET_UDP;
+    protocol.robot_socket.qos.dscp = 46;
+    protocol.robot_socket.qos.priority = 6;
 
     /* Define netconsole socket properties */
     protocol.netconsole_socket = *DS_SocketEmpty();
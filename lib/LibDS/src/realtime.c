@@ -0,0 +1,327 @@
+/*
+ * The Driver Station Library (LibDS)
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/* Required by the CPU affinity functions of glibc */
+#if defined __linux__ && !defined _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#include "DS_Realtime.h"
+#include "DS_Utils.h"
+
+#include <string.h>
+#include <pthread.h>
+
+#if defined _WIN32
+    #include <windows.h>
+#else
+    #include <sched.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+#endif
+
+#if defined __linux__
+    #include <sys/syscall.h>
+#endif
+
+/*
+ * The profile is shared by all the contexts, since the memory lock applies
+ * to the whole process. Each thread checks the generation of the profile to
+ * know if it has to apply it again, the generation is read atomically so
+ * that the threads only lock the mutex when the profile changes.
+ */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static DS_RealtimeProfile profile = {0, 10, 0, -10, -1, 1};
+static DS_RealtimeStatus status;
+static volatile long generation = 0;
+
+#if !defined _WIN32
+static int locked = 0;
+#endif
+
+/**
+ * Updates the given \a status with the \a result of a thread, so that a
+ * failure on any thread is not hidden by the other threads
+ */
+static void merge (DS_RealtimeResult* status, const DS_RealtimeResult result)
+{
+    if (result > *status)
+        *status = result;
+}
+
+/**
+ * Gives a real-time priority to the calling thread if \a enabled is set to
+ * \c 1, or restores the default scheduler if \a enabled is set to \c 0
+ */
+static DS_RealtimeResult set_scheduler (const int enabled)
+{
+#if defined _WIN32
+    int priority = enabled ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_NORMAL;
+    if (SetThreadPriority (GetCurrentThread(), priority))
+        return DS_REALTIME_APPLIED;
+#else
+    int policy = SCHED_OTHER;
+    struct sched_param param;
+    memset (&param, 0, sizeof (param));
+
+    if (enabled) {
+        policy = profile.round_robin ? SCHED_RR : SCHED_FIFO;
+        param.sched_priority = DS_Max (profile.priority, sched_get_priority_min (policy));
+        param.sched_priority = DS_Min (param.sched_priority, sched_get_priority_max (policy));
+    }
+
+    if (pthread_setschedparam (pthread_self(), policy, &param) == 0)
+        return DS_REALTIME_APPLIED;
+#endif
+
+    return DS_REALTIME_DENIED;
+}
+
+/**
+ * Changes the nice value of the calling thread, this is only possible on
+ * Linux, where each thread has its own nice value
+ */
+static DS_RealtimeResult set_nice (const int nice)
+{
+#if defined __linux__
+    if (setpriority (PRIO_PROCESS, (id_t) syscall (SYS_gettid), nice) == 0)
+        return DS_REALTIME_APPLIED;
+
+    return DS_REALTIME_DENIED;
+#else
+    (void) nice;
+    return DS_REALTIME_UNSUPPORTED;
+#endif
+}
+
+/**
+ * Binds the calling thread to the given \a cpu, or allows it to run on the
+ * CPUs of the process if \a cpu is negative
+ */
+static DS_RealtimeResult set_affinity (const int cpu)
+{
+#if defined __linux__
+    cpu_set_t set;
+    CPU_ZERO (&set);
+
+    if (cpu >= CPU_SETSIZE)
+        return DS_REALTIME_DENIED;
+    else if (cpu >= 0)
+        CPU_SET (cpu, &set);
+    else if (sched_getaffinity (getpid(), sizeof (set), &set) != 0)
+        return DS_REALTIME_DENIED;
+
+    if (pthread_setaffinity_np (pthread_self(), sizeof (set), &set) == 0)
+        return DS_REALTIME_APPLIED;
+
+    return DS_REALTIME_DENIED;
+#elif defined _WIN32
+    DWORD_PTR process = 0;
+    DWORD_PTR system = 0;
+    GetProcessAffinityMask (GetCurrentProcess(), &process, &system);
+
+    if (cpu >= (int) (sizeof (DWORD_PTR) * 8))
+        return DS_REALTIME_DENIED;
+
+    DWORD_PTR mask = cpu >= 0 ? ((DWORD_PTR) 1 << cpu) : process;
+    if (SetThreadAffinityMask (GetCurrentThread(), mask))
+        return DS_REALTIME_APPLIED;
+
+    return DS_REALTIME_DENIED;
+#else
+    (void) cpu;
+    return DS_REALTIME_UNSUPPORTED;
+#endif
+}
+
+/**
+ * Locks the current and future memory of the process in RAM if \a lock is
+ * set to \c 1, or unlocks it if \a lock is set to \c 0.
+ *
+ * Once locked, every new allocation counts against the memory lock limit,
+ * so the memory is only locked if the limit cannot be reached.
+ */
+static DS_RealtimeResult lock_memory (const int lock)
+{
+#if defined _WIN32
+    return lock ? DS_REALTIME_UNSUPPORTED : DS_REALTIME_NOT_REQUESTED;
+#else
+    if (!lock) {
+        if (locked)
+            munlockall();
+
+        locked = 0;
+        return DS_REALTIME_NOT_REQUESTED;
+    }
+
+    struct rlimit limit;
+    if (getrlimit (RLIMIT_MEMLOCK, &limit) != 0)
+        return DS_REALTIME_DENIED;
+
+    if (geteuid() != 0 && limit.rlim_cur != RLIM_INFINITY)
+        return DS_REALTIME_DENIED;
+
+    if (mlockall (MCL_CURRENT | MCL_FUTURE) != 0)
+        return DS_REALTIME_DENIED;
+
+    locked = 1;
+    return DS_REALTIME_APPLIED;
+#endif
+}
+
+/**
+ * Returns the generation of the profile, the value is read atomically so
+ * that the threads can check it without locking the mutex
+ */
+static long load_generation (void)
+{
+#if defined _MSC_VER
+    return InterlockedCompareExchange (&generation, 0, 0);
+#else
+    return __atomic_load_n (&generation, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * Increments the generation of the profile (with the mutex locked), so
+ * that the threads apply the new profile
+ */
+static void bump_generation (void)
+{
+#if defined _MSC_VER
+    InterlockedIncrement (&generation);
+#else
+    __atomic_add_fetch (&generation, 1, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * Applies the real-time profile to the calling thread if the profile has
+ * changed since the last call. This function is called by the protocol and
+ * socket threads on each iteration of their loops.
+ */
+void Realtime_Update (DS_RealtimeThread* thread)
+{
+    if (!thread)
+        return;
+
+    /* Profile has not changed, avoid locking the mutex */
+    if (load_generation() == thread->generation)
+        return;
+
+    pthread_mutex_lock (&mutex);
+
+    if (thread->generation != generation) {
+        thread->generation = (int) generation;
+
+        /* Restore the defaults of the thread */
+        if (thread->scheduler)
+            set_scheduler (0);
+        if (thread->nice)
+            set_nice (0);
+        if (thread->affinity)
+            set_affinity (-1);
+
+        thread->scheduler = 0;
+        thread->nice = 0;
+        thread->affinity = 0;
+
+        /* Apply the profile, use the nice value if we cannot get a
+         * real-time priority */
+        if (profile.enabled) {
+            DS_RealtimeResult result = set_scheduler (1);
+            thread->scheduler = (result == DS_REALTIME_APPLIED);
+            merge (&status.scheduler, result);
+
+            if (!thread->scheduler && profile.nice != 0) {
+                result = set_nice (profile.nice);
+                thread->nice = (result == DS_REALTIME_APPLIED);
+                merge (&status.nice, result);
+            }
+
+            if (profile.cpu >= 0) {
+                result = set_affinity (profile.cpu);
+                thread->affinity = (result == DS_REALTIME_APPLIED);
+                merge (&status.affinity, result);
+            }
+        }
+    }
+
+    pthread_mutex_unlock (&mutex);
+}
+
+/**
+ * Copies the result of each setting of the current profile to \a status.
+ * The threads apply a new profile on the next iteration of their loops, so
+ * the status may take a few milliseconds to be complete.
+ */
+void DS_GetRealtimeStatus (DS_RealtimeStatus* status_ptr)
+{
+    if (!status_ptr)
+        return;
+
+    pthread_mutex_lock (&mutex);
+    *status_ptr = status;
+    pthread_mutex_unlock (&mutex);
+}
+
+/**
+ * Copies the current real-time profile to \a profile. The default profile
+ * is disabled, uses the SCHED_FIFO priority 10, a nice value of -10, any
+ * CPU and locks the memory of the process.
+ */
+void DS_GetRealtimeProfile (DS_RealtimeProfile* profile_ptr)
+{
+    if (!profile_ptr)
+        return;
+
+    pthread_mutex_lock (&mutex);
+    *profile_ptr = profile;
+    pthread_mutex_unlock (&mutex);
+}
+
+/**
+ * Changes the real-time profile of the protocol and socket threads of every
+ * context. Most of the settings require special permissions (e.g.
+ * \c CAP_SYS_NICE or an \c rtprio limit on Linux), use
+ * \c DS_GetRealtimeStatus() to know which settings took effect.
+ *
+ * \note The threads of a context that is driven by \c DS_Step() belong to
+ *       the application, so the profile is not applied to them
+ */
+void DS_SetRealtimeProfile (const DS_RealtimeProfile* profile_ptr)
+{
+    if (!profile_ptr)
+        return;
+
+    pthread_mutex_lock (&mutex);
+
+    profile = *profile_ptr;
+    bump_generation();
+
+    memset (&status, 0, sizeof (status));
+    status.memory_lock = lock_memory (profile.enabled && profile.lock_memory);
+
+    pthread_mutex_unlock (&mutex);
+}
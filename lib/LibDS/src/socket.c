@@ -22,8 +22,12 @@
  */
 
 #include "DS_Utils.h"
+#include "DS_Timer.h"
 #include "DS_Socket.h"
+#include "DS_Context.h"
+#include "DS_Realtime.h"
 
+#include <time.h>
 #include <socky.h>
 #include <assert.h>
 
@@ -35,6 +39,279 @@
     #endif
 #endif
 
+/*
+ * Maximum number of input ports that can be registered at the same time
+ */
+#define MAX_BOUND_PORTS 64
+
+/*
+ * Maximum age (in msecs) of a kernel timestamp, older timestamps are assumed
+ * to come from a step of the system clock and are ignored
+ */
+#define MAX_RX_AGE 100
+
+/*
+ * Holds an input port and the context whose sockets bind it. The sockets
+ * are opened with SO_REUSEPORT, so the kernel would split the datagrams
+ * between two contexts that bind the same port.
+ */
+typedef struct {
+    int port;
+    int count;
+    DS_SocketType type;
+    DS_Context* context;
+} BoundPort;
+
+static BoundPort bound_ports [MAX_BOUND_PORTS];
+static pthread_mutex_t ports_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * Holds the socket hooks of each context
+ */
+typedef struct {
+    int enabled;          /* Set to 1 if the hooks replace the system sockets */
+    DS_SocketHooks hooks; /* Functions used to send and receive data */
+} Sockets;
+
+const DS_StateInfo Sockets_State = {sizeof (Sockets), NULL, NULL};
+
+/**
+ * Returns the socket hooks of the current context
+ */
+static Sockets* state (void)
+{
+    return (Sockets*) DS_ContextState (DS_STATE_SOCKETS);
+}
+
+/**
+ * Returns the hooks that replace the system sockets of the current context,
+ * or \c NULL if the context uses the system sockets
+ */
+static const DS_SocketHooks* current_hooks (void)
+{
+    Sockets* sockets = state();
+
+    if (sockets->enabled && DS_StepMode())
+        return &sockets->hooks;
+
+    return NULL;
+}
+
+/**
+ * Registers the input port of the given socket for the current context.
+ * Returns \c 0 if the port is already used by another context.
+ */
+static int claim_port (DS_Socket* ptr)
+{
+    int i;
+    int free = -1;
+    int claimed = 1;
+    DS_Context* context = DS_CurrentContext();
+
+    if (ptr->in_port <= 0)
+        return 1;
+
+    pthread_mutex_lock (&ports_mutex);
+
+    for (i = 0; i < MAX_BOUND_PORTS; ++i) {
+        BoundPort* entry = &bound_ports [i];
+
+        if (entry->count == 0) {
+            if (free < 0)
+                free = i;
+
+            continue;
+        }
+
+        if (entry->port == ptr->in_port && entry->type == ptr->type) {
+            claimed = (entry->context == context);
+            if (claimed) {
+                ++entry->count;
+                ptr->info.bound_port = ptr->in_port;
+            }
+
+            pthread_mutex_unlock (&ports_mutex);
+            return claimed;
+        }
+    }
+
+    if (free >= 0) {
+        bound_ports [free].port = ptr->in_port;
+        bound_ports [free].count = 1;
+        bound_ports [free].type = ptr->type;
+        bound_ports [free].context = context;
+        ptr->info.bound_port = ptr->in_port;
+    }
+
+    pthread_mutex_unlock (&ports_mutex);
+    return claimed;
+}
+
+/**
+ * Un-registers the input port of the given socket (if it was registered)
+ */
+static void release_port (DS_Socket* ptr)
+{
+    int i;
+
+    if (ptr->info.bound_port <= 0)
+        return;
+
+    pthread_mutex_lock (&ports_mutex);
+
+    for (i = 0; i < MAX_BOUND_PORTS; ++i) {
+        BoundPort* entry = &bound_ports [i];
+        if (entry->count > 0
+                && entry->port == ptr->info.bound_port
+                && entry->type == ptr->type) {
+            --entry->count;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock (&ports_mutex);
+    ptr->info.bound_port = 0;
+}
+
+/**
+ * Returns the time of the system clock (in nsecs), which is the clock used
+ * by the kernel to timestamp the received datagrams
+ */
+static int64_t system_time (void)
+{
+#if defined _WIN32
+    FILETIME time;
+    GetSystemTimeAsFileTime (&time);
+    return ((((int64_t) time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+#else
+    struct timespec time;
+    clock_gettime (CLOCK_REALTIME, &time);
+    return (int64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+#endif
+}
+
+/**
+ * Changes the given integer socket \a option of the given \a sfd, values
+ * of \c 0 are ignored (to keep the default of the operating system)
+ */
+static void set_option (const int sfd, const int level, const int option,
+                        const int value)
+{
+    if (sfd > 0 && value > 0)
+        setsockopt (sfd, level, option, (const char*) &value, sizeof (value));
+}
+
+/**
+ * Returns the value of the given integer socket \a option of the given
+ * \a sfd, or \c 0 if the option cannot be read
+ */
+static int get_option (const int sfd, const int level, const int option)
+{
+    int value = 0;
+    socklen_t len = sizeof (value);
+
+    if (sfd <= 0 || getsockopt (sfd, level, option, (char*) &value, &len) != 0)
+        return 0;
+
+    return value;
+}
+
+/**
+ * Applies the quality of service options of the given socket structure to
+ * its system sockets, and reads back the values that the system applied.
+ * Some options (e.g. the priority or the busy polling) are not available
+ * on every operating system, and may require special permissions.
+ *
+ * \param ptr a pointer to a \c DS_Socket structure
+ */
+static void apply_qos (DS_Socket* ptr)
+{
+    /* Check arguments */
+    assert (ptr);
+
+    int i;
+    int fds [2] = {ptr->info.sock_in, ptr->info.sock_out};
+
+    /* Apply the options to both sockets */
+    for (i = 0; i < 2; ++i) {
+#if defined IP_TOS
+        set_option (fds [i], IPPROTO_IP, IP_TOS, ptr->qos.dscp << 2);
+#endif
+#if defined SO_PRIORITY
+        set_option (fds [i], SOL_SOCKET, SO_PRIORITY, ptr->qos.priority);
+#endif
+#if defined SO_BUSY_POLL
+        set_option (fds [i], SOL_SOCKET, SO_BUSY_POLL, ptr->qos.busy_poll);
+#endif
+        set_option (fds [i], SOL_SOCKET, SO_RCVBUF, ptr->qos.recv_buffer);
+        set_option (fds [i], SOL_SOCKET, SO_SNDBUF, ptr->qos.send_buffer);
+    }
+
+    /* Read the options of the outgoing and incoming sockets */
+    memset (&ptr->info.applied, 0, sizeof (ptr->info.applied));
+#if defined IP_TOS
+    ptr->info.applied.dscp = get_option (ptr->info.sock_out, IPPROTO_IP, IP_TOS) >> 2;
+#endif
+#if defined SO_PRIORITY
+    ptr->info.applied.priority = get_option (ptr->info.sock_out, SOL_SOCKET, SO_PRIORITY);
+#endif
+#if defined SO_BUSY_POLL
+    ptr->info.applied.busy_poll = get_option (ptr->info.sock_in, SOL_SOCKET, SO_BUSY_POLL);
+#endif
+    ptr->info.applied.recv_buffer = get_option (ptr->info.sock_in, SOL_SOCKET, SO_RCVBUF);
+    ptr->info.applied.send_buffer = get_option (ptr->info.sock_out, SOL_SOCKET, SO_SNDBUF);
+}
+
+/**
+ * Reads a datagram from the given \a sfd into \a data and registers the
+ * address of the sender in \a peer. If the system supports it, the time at
+ * which the kernel received the datagram is copied to \a stamp.
+ *
+ * \returns the number of received bytes, or \c -1 on failure
+ */
+static int read_datagram (const int sfd, char* data, const int len,
+                          struct sockaddr_storage* peer, socklen_t* peer_len,
+                          int64_t* stamp)
+{
+#if defined SO_TIMESTAMPNS
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr* cmsg;
+    char control [CMSG_SPACE (sizeof (struct timespec))];
+
+    iov.iov_base = data;
+    iov.iov_len = len;
+
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_name = peer;
+    msg.msg_namelen = *peer_len;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof (control);
+
+    int read = recvmsg (sfd, &msg, 0);
+    *peer_len = msg.msg_namelen;
+
+    /* Get the kernel timestamp from the control messages */
+    if (read > 0) {
+        for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET &&
+                cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec time;
+                memcpy (&time, CMSG_DATA (cmsg), sizeof (time));
+                *stamp = (int64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+            }
+        }
+    }
+
+    return read;
+#else
+    (void) stamp;
+    return recvfrom (sfd, data, len, 0, (struct sockaddr*) peer, peer_len);
+#endif
+}
+
 /**
  * Copies the received data from the socket in its data buffer
  */
@@ -45,20 +322,30 @@ static void read_socket (DS_Socket* ptr)
 
     /* Initialize temporary buffer */
     int read = -1;
+    int64_t stamp = 0;
     char data [4096] = {0};
 
     /* Read TCP socket */
     if (ptr->type == DS_SOCKET_TCP)
         read = recv (ptr->info.sock_in, data, sizeof (data), 0);
 
-    /* Read UDP socket */
+    /* Read UDP socket and register the address of the sender */
     if (ptr->type == DS_SOCKET_UDP) {
-        read = udp_recvfrom (ptr->info.sock_in, data, sizeof (data),
-                             ptr->address, ptr->info.in_service, 0);
+        struct sockaddr_storage peer;
+        socklen_t peer_len = sizeof (peer);
+
+        read = read_datagram (ptr->info.sock_in, data, sizeof (data),
+                              &peer, &peer_len, &stamp);
+
+        if (read > 0) {
+            getnameinfo ((struct sockaddr*) &peer, peer_len, ptr->info.peer,
+                         sizeof (ptr->info.peer), NULL, 0, NI_NUMERICHOST);
+        }
     }
 
     /* We received some data, copy it to socket's buffer */
     if (read > 0) {
+        ptr->info.rx_stamp = stamp > 0 ? stamp : system_time();
         ptr->info.buffer_size = read;
         memset (ptr->info.buffer, 0, ptr->info.buffer_size);
 
@@ -69,13 +356,40 @@ static void read_socket (DS_Socket* ptr)
 }
 
 /**
- * Runs the server socket loop, which uses the \c select() function
- * to copy received data into the socket's buffer only when the
- * operating system detects that the socket received some data.
+ * Copies the data given by the receive hook of the current context into the
+ * socket's buffer
+ */
+static void read_hooked_socket (DS_Socket* ptr)
+{
+    /* Check arguments */
+    assert (ptr);
+
+    /* The context has no receive hook */
+    const DS_SocketHooks* hooks = current_hooks();
+    if (!hooks || !hooks->receive)
+        return;
+
+    /* Read the data and the address of the sender */
+    char peer [sizeof (ptr->info.peer)] = {0};
+    int read = hooks->receive (ptr, ptr->info.buffer,
+                               sizeof (ptr->info.buffer),
+                               peer, sizeof (peer) - 1);
+
+    /* We received some data */
+    if (read > 0) {
+        ptr->info.rx_stamp = system_time();
+        ptr->info.buffer_size = DS_Min (read, (int) sizeof (ptr->info.buffer));
+        memcpy (ptr->info.peer, peer, sizeof (peer));
+    }
+}
+
+/**
+ * Waits up to the given number of \a usecs for the socket to receive some
+ * data, and copies the received data into the socket's buffer
  *
  * \param ptr a pointer to a \c DS_Socket structure
  */
-static void server_loop (DS_Socket* ptr)
+static void poll_socket (DS_Socket* ptr, const int usecs)
 {
     /* Check arguments */
     assert (ptr);
@@ -85,41 +399,55 @@ static void server_loop (DS_Socket* ptr)
     fd_set set;
     struct timeval tv;
 
-    /* Disable socket blocking */
-#ifndef _WIN32
-    set_socket_block (ptr->info.sock_in, 0);
-#endif
+    tv.tv_sec = 0;
+    tv.tv_usec = usecs;
 
-    /* Run the server while the socket is valid */
-    while (ptr->info.server_init && ptr->info.sock_in > 0) {
-        tv.tv_sec = 0;
-        tv.tv_usec = 5000 * 100;
-
-        FD_ZERO (&set);
-        FD_SET (ptr->info.sock_in, &set);
+    FD_ZERO (&set);
+    FD_SET (ptr->info.sock_in, &set);
 
 #if defined _WIN32
-        fd = 0;
+    fd = 0;
 #else
-        fd = ptr->info.sock_in + 1;
+    fd = ptr->info.sock_in + 1;
 #endif
 
-        rc = select (fd, &set, NULL, NULL, &tv);
-        if (rc > 0 && FD_ISSET (ptr->info.sock_in, &set))
-            read_socket (ptr);
+    rc = select (fd, &set, NULL, NULL, &tv);
+    if (rc > 0 && FD_ISSET (ptr->info.sock_in, &set))
+        read_socket (ptr);
+}
+
+/**
+ * Runs the server socket loop, which uses the \c select() function
+ * to copy received data into the socket's buffer only when the
+ * operating system detects that the socket received some data.
+ *
+ * \param ptr a pointer to a \c DS_Socket structure
+ */
+static void server_loop (DS_Socket* ptr)
+{
+    /* Check arguments */
+    assert (ptr);
+
+    DS_RealtimeThread realtime;
+    memset (&realtime, 0, sizeof (realtime));
+
+    /* Run the server while the socket is valid */
+    while (ptr->info.running && ptr->info.server_init &&
+           ptr->info.sock_in > 0) {
+        Realtime_Update (&realtime);
+        poll_socket (ptr, 50 * 1000);
     }
 }
 
 /**
- * Initializes the given socket structure
+ * Opens the system sockets of the given socket structure
  *
- * \param data raw pointer to a \c DS_Socket structure
+ * \param ptr a pointer to a \c DS_Socket structure
  */
-static void* create_socket (void* data)
+static void open_socket (DS_Socket* ptr)
 {
     /* Check arguments */
-    assert (data);
-    DS_Socket* ptr = (DS_Socket*) data;
+    assert (ptr);
 
     /* Ensure that buffer and service strings are set to 0 */
     memset (ptr->info.buffer, 0, sizeof (ptr->info.buffer));
@@ -143,11 +471,39 @@ static void* create_socket (void* data)
         ptr->info.sock_in = create_server_udp (ptr->info.in_service, SOCKY_IPv4, 0);
     }
 
+    /* Apply the quality of service options */
+    apply_qos (ptr);
+
+    /* Ask the kernel to timestamp the received datagrams */
+#if defined SO_TIMESTAMPNS
+    if (ptr->type == DS_SOCKET_UDP)
+        set_option (ptr->info.sock_in, SOL_SOCKET, SO_TIMESTAMPNS, 1);
+#endif
+
     /* Update initialized states */
     ptr->info.server_init = (ptr->info.sock_in > 0);
     ptr->info.client_init = (ptr->info.sock_out > 0);
 
-    /* Start server loop */
+    /* Disable socket blocking */
+#ifndef _WIN32
+    if (ptr->info.server_init)
+        set_socket_block (ptr->info.sock_in, 0);
+#endif
+}
+
+/**
+ * Initializes the given socket structure and runs its server loop
+ *
+ * \param data raw pointer to a \c DS_Socket structure
+ */
+static void* create_socket (void* data)
+{
+    /* Check arguments */
+    assert (data);
+    DS_Socket* ptr = (DS_Socket*) data;
+
+    /* Open the socket and start the server loop */
+    open_socket (ptr);
     server_loop (ptr);
 
     /* Exit */
@@ -178,6 +534,7 @@ DS_Socket* DS_SocketEmpty (void)
 
     /* Fill strings with 0 */
     memset (socket->address, 0, sizeof (socket->address));
+    memset (socket->info.peer, 0, sizeof (socket->info.peer));
     memset (socket->info.buffer, 0, sizeof (socket->info.buffer));
     memset (socket->info.in_service, 0, sizeof (socket->info.in_service));
     memset (socket->info.out_service, 0, sizeof (socket->info.out_service));
@@ -217,9 +574,38 @@ void DS_SocketOpen (DS_Socket* ptr)
     if (ptr->disabled)
         return;
 
+    /* The hooks of the context replace the system sockets */
+    if (current_hooks()) {
+        ptr->info.polled = 1;
+        ptr->info.hooked = 1;
+        ptr->info.sock_in = -1;
+        ptr->info.sock_out = -1;
+        ptr->info.server_init = 1;
+        ptr->info.client_init = 1;
+        return;
+    }
+
+    /* Another context uses the input port, it would steal our data */
+    if (!claim_port (ptr)) {
+        DS_String caption = DS_StrNew ("LibDS");
+        DS_String message = DS_StrFormat ("Port %d is already used by another "
+                                          "DS context!", ptr->in_port);
+        DS_ShowMessageBox (&caption, &message, DS_ICON_ERROR);
+        DS_StrRmBuf (&caption);
+        DS_StrRmBuf (&message);
+        return;
+    }
+
+    /* Open the socket in this thread, it is read by DS_SocketRead() */
+    ptr->info.polled = DS_StepMode();
+    if (ptr->info.polled) {
+        open_socket (ptr);
+        return;
+    }
+
     /* Initialize the socket in another thread */
-    pthread_t thread;
-    int error = pthread_create (&thread, NULL,
+    ptr->info.running = 1;
+    int error = pthread_create (&ptr->info.thread, NULL,
                                 &create_socket, (void*) ptr);
 
     /* Warn the user when the socket cannot start */
@@ -246,10 +632,20 @@ void DS_SocketClose (DS_Socket* ptr)
     /* Check arguments */
     assert (ptr);
 
+    /* Wait for the socket thread to finish */
+    if (ptr->info.running) {
+        ptr->info.running = 0;
+        pthread_join (ptr->info.thread, NULL);
+    }
+
     /* Reset socket properties */
+    ptr->info.hooked = 0;
     ptr->info.server_init = 0;
     ptr->info.client_init = 0;
 
+    /* Allow other contexts to use the input port */
+    release_port (ptr);
+
     /* Close sockets */
 #if defined (__ANDROID__)
     socket_close_threaded (ptr->info.sock_in);
@@ -262,16 +658,21 @@ void DS_SocketClose (DS_Socket* ptr)
     /* Reset socket information structure */
     ptr->info.sock_in = -1;
     ptr->info.sock_out = -1;
+    ptr->info.rx_time = 0;
+    ptr->info.rx_stamp = 0;
     ptr->info.buffer_size = 0;
 
-    /* Reset strings */
+    /* Reset strings and reported options */
+    memset (&ptr->info.applied, 0, sizeof (ptr->info.applied));
+    memset (ptr->info.peer, 0, sizeof (ptr->info.peer));
     memset (ptr->info.buffer, 0, sizeof (ptr->info.buffer));
     memset (ptr->info.in_service, 0, sizeof (ptr->info.in_service));
     memset (ptr->info.out_service, 0, sizeof (ptr->info.out_service));
 }
 
 /**
- * Returns any data received by the given socket
+ * Returns any data received by the given socket, the time at which the data
+ * was received (as given by \c DS_Now()) is copied to \c info.rx_time.
  *
  * \param ptr pointer to a \c DS_Socket structure
  */
@@ -284,6 +685,12 @@ DS_String DS_SocketRead (DS_Socket* ptr)
     if ((ptr->info.server_init == 0) || (ptr->disabled == 1))
         return DS_StrNewLen (0);
 
+    /* Socket has no thread, check if it received something */
+    if (ptr->info.hooked)
+        read_hooked_socket (ptr);
+    else if (ptr->info.polled)
+        poll_socket (ptr, 0);
+
     /* Copy the current buffer and clear it */
     if (ptr->info.buffer_size > 0) {
         DS_String buffer = DS_StrNewLen (ptr->info.buffer_size);
@@ -293,6 +700,17 @@ DS_String DS_SocketRead (DS_Socket* ptr)
         for (i = 0; i < (int) ptr->info.buffer_size; ++i)
             DS_StrSetChar (&buffer, i, ptr->info.buffer [i]);
 
+        /* Convert the arrival time to the clock of the current context, the
+         * step mode and custom clocks are not related to the system clock.
+         * The system clock may also be stepped (e.g. by NTP) between the
+         * arrival and the read, so out of range ages are not trusted. */
+        int64_t age = system_time() - ptr->info.rx_stamp;
+        if (DS_StepMode() || DS_CustomClock() ||
+                age < 0 || age > (int64_t) MAX_RX_AGE * 1000000)
+            age = 0;
+
+        ptr->info.rx_time = DS_Now() - age;
+
         /* Clear buffer info */
         memset (ptr->info.buffer, 0, ptr->info.buffer_size);
         ptr->info.buffer_size = 0;
@@ -314,10 +732,30 @@ DS_String DS_SocketRead (DS_Socket* ptr)
  * \returns number of bytes written on success, -1 on failure
  */
 int DS_SocketSend (const DS_Socket* ptr, const DS_String* data)
+{
+    /* Check arguments */
+    assert (ptr);
+
+    /* Send data to the socket's address */
+    return DS_SocketSendTo (ptr, data, ptr->address);
+}
+
+/**
+ * Sends the given \a data to the given \a address using the given socket,
+ * this is used to probe several addresses with the same socket.
+ *
+ * \note TCP sockets ignore the \a address and send the data to the host
+ *       that they are connected to
+ *
+ * \returns number of bytes written on success, -1 on failure
+ */
+int DS_SocketSendTo (const DS_Socket* ptr, const DS_String* data,
+                     const char* address)
 {
     /* Check arguments */
     assert (ptr);
     assert (data);
+    assert (address);
 
     /* Socket is disabled or uninitialized */
     if ((ptr->info.client_init == 0) || ptr->disabled)
@@ -332,14 +770,22 @@ int DS_SocketSend (const DS_Socket* ptr, const DS_String* data)
     int len = DS_StrLen (data);
     char* bytes = DS_StrToChar (data);
 
+    /* Send data using the hooks of the context */
+    if (ptr->info.hooked) {
+        const DS_SocketHooks* hooks = current_hooks();
+        bytes_written = -1;
+        if (hooks && hooks->send)
+            bytes_written = hooks->send (ptr, address, bytes, len);
+    }
+
     /* Send data using TCP */
-    if (ptr->type == DS_SOCKET_TCP)
+    else if (ptr->type == DS_SOCKET_TCP)
         bytes_written = send (ptr->info.sock_out, bytes, len, 0);
 
     /* Send data using UDP */
     else if (ptr->type == DS_SOCKET_UDP) {
         bytes_written = udp_sendto (ptr->info.sock_out, bytes, len,
-                                    ptr->address, ptr->info.out_service, 0);
+                                    address, ptr->info.out_service, 0);
     }
 
     /* Delete temp. buffer */
@@ -368,7 +814,35 @@ void DS_SocketChangeAddress (DS_Socket* ptr, const char* address)
     memset (ptr->address, 0, sizeof (ptr->address));
     memcpy (ptr->address, address, strlen (address));
 
+    /* UDP sockets look up the address on each datagram, keep them open */
+    if (ptr->type == DS_SOCKET_UDP && ptr->info.server_init &&
+        ptr->info.client_init)
+        return;
+
     /* Re-open the socket */
     DS_SocketClose (ptr);
     DS_SocketOpen (ptr);
 }
+
+/**
+ * Replaces the system sockets of the current context with the given
+ * \a hooks, set \a hooks to \c NULL to use the system sockets again.
+ *
+ * \note The hooks only apply to contexts in step mode (see
+ *       \c DS_SetStepMode()) and to the sockets opened after calling this
+ *       function, call it before \c DS_ConfigureProtocol()
+ */
+void DS_SetSocketHooks (const DS_SocketHooks* hooks)
+{
+    Sockets* sockets = state();
+
+    if (hooks) {
+        sockets->enabled = 1;
+        sockets->hooks = *hooks;
+    }
+
+    else {
+        sockets->enabled = 0;
+        memset (&sockets->hooks, 0, sizeof (sockets->hooks));
+    }
+}
@@ -21,9 +21,11 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include "LibDS.h"
 #include "DS_Utils.h"
 #include "DS_Array.h"
 #include "DS_Timer.h"
+#include "DS_Context.h"
 
 #include <stdio.h>
 #include <assert.h>
@@ -31,12 +33,50 @@
 #if defined _WIN32
     #include <windows.h>
 #else
+    #include <time.h>
     #include <unistd.h>
 #endif
 
 static DS_Array timers;
 static int running = 0;
 
+/*
+ * Holds the clock of each context
+ */
+typedef struct {
+    DS_Clock clock;       /* Custom clock, NULL to use the default clock */
+    int step_mode;        /* Set to 1 if the context is driven by DS_Step() */
+    int64_t virtual_time; /* Time of the step mode clock (in nsecs) */
+} Timers;
+
+const DS_StateInfo Timers_State = {sizeof (Timers), NULL, NULL};
+
+/**
+ * Returns the clock of the current context
+ */
+static Timers* state (void)
+{
+    return (Timers*) DS_ContextState (DS_STATE_TIMERS);
+}
+
+/**
+ * Returns the time of the monotonic clock of the operating system (in nsecs)
+ */
+static int64_t monotonic_clock (void)
+{
+#if defined _WIN32
+    LARGE_INTEGER count;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter (&count);
+    QueryPerformanceFrequency (&frequency);
+    return (int64_t) ((double) count.QuadPart * 1e9 / frequency.QuadPart);
+#else
+    struct timespec time;
+    clock_gettime (CLOCK_MONOTONIC, &time);
+    return ((int64_t) time.tv_sec * 1000000000) + time.tv_nsec;
+#endif
+}
+
 /**
  * Updates the properties of the given \a timer
  * This function is called in a separate thread for each timer that we use.
@@ -49,14 +89,8 @@ static void* update_timer (void* ptr)
     assert (ptr);
     DS_Timer* timer = (DS_Timer*) ptr;
 
-    while (running == 1) {
-        if (timer->enabled && timer->time > 0 && !timer->expired) {
-            timer->elapsed += timer->precision;
-
-            if (timer->elapsed >= timer->time)
-                timer->expired = 1;
-        }
-
+    while (running == 1 && timer->initialized) {
+        DS_TimerStep (timer, timer->precision);
         DS_Sleep (timer->precision);
     }
 
@@ -83,6 +117,77 @@ void Timers_Close (void)
     DS_ArrayFree (&timers);
 }
 
+/**
+ * Advances the step mode clock of the current context by the given number
+ * of \a millisecs, this function is called by \c DS_Step()
+ */
+void Timers_Step (const int millisecs)
+{
+    state()->virtual_time += (int64_t) millisecs * 1000000;
+}
+
+/**
+ * Returns the current time (in nsecs) of the clock of the current context:
+ *    - The custom clock set with \c DS_SetClock()
+ *    - The time advanced by \c DS_Step() if the context is in step mode
+ *    - The monotonic clock of the operating system otherwise
+ */
+int64_t DS_Now (void)
+{
+    Timers* timers = state();
+
+    if (timers->clock)
+        return timers->clock();
+
+    if (timers->step_mode)
+        return timers->virtual_time;
+
+    return monotonic_clock();
+}
+
+/**
+ * Returns \c 1 if the current context is driven by \c DS_Step()
+ */
+int DS_StepMode (void)
+{
+    return state()->step_mode;
+}
+
+/**
+ * Returns the custom clock of the current context, or \c NULL if the
+ * context uses the default clock
+ */
+DS_Clock DS_CustomClock (void)
+{
+    return state()->clock;
+}
+
+/**
+ * Changes the \a clock used by the current context, set it to \c NULL to
+ * use the default clock
+ */
+void DS_SetClock (const DS_Clock clock)
+{
+    state()->clock = clock;
+}
+
+/**
+ * Enables or disables the step mode of the current context. In step mode,
+ * the context has no timer or protocol threads, and the application must
+ * call \c DS_Step() to advance the timers and to send and receive packets.
+ * This allows the application to simulate a whole match deterministically
+ * (and faster than real time).
+ *
+ * \note This function has no effect after calling \c DS_Init()
+ */
+void DS_SetStepMode (const int enabled)
+{
+    if (!DS_Initialized()) {
+        state()->step_mode = (enabled > 0);
+        state()->virtual_time = 0;
+    }
+}
+
 /**
  * Pauses the execution state of the program/thread for the given
  * number of \a millisecs.
@@ -110,6 +215,24 @@ void DS_TimerStop (DS_Timer* timer)
     timer->elapsed = 0;
 }
 
+/**
+ * Stops the thread of the given \a timer and waits until it finishes, after
+ * calling this function the \a timer can be safely de-allocated
+ */
+void DS_TimerClose (DS_Timer* timer)
+{
+    assert (timer);
+
+    if (timer->initialized) {
+        timer->initialized = 0;
+
+        if (!timer->manual)
+            pthread_join (timer->thread, NULL);
+    }
+
+    DS_TimerStop (timer);
+}
+
 /**
  * Resets and enables the given \a timer
  */
@@ -133,6 +256,22 @@ void DS_TimerReset (DS_Timer* timer)
     timer->elapsed = 0;
 }
 
+/**
+ * Adds the given number of \a millisecs to the elapsed time of the given
+ * \a timer (if it is enabled and has not expired yet)
+ */
+void DS_TimerStep (DS_Timer* timer, const int millisecs)
+{
+    assert (timer);
+
+    if (timer->enabled && timer->time > 0 && !timer->expired) {
+        timer->elapsed += millisecs;
+
+        if (timer->elapsed >= timer->time)
+            timer->expired = 1;
+    }
+}
+
 /**
  * Initializes the given \a timer with the given \a time and \a precision.
  * The timers are updated using a threaded while loop (that sleeps the number
@@ -143,6 +282,9 @@ void DS_TimerReset (DS_Timer* timer)
  * A word of advice, using a higher \a precision (lower value in msecs) will
  * result in increased CPU usage, this thing does not have morals and will eat
  * the whole cake if you allow it.
+ *
+ * In step mode (see \c DS_SetStepMode()), no thread is created and the
+ * timer is advanced with \c DS_TimerStep().
  */
 void DS_TimerInit (DS_Timer* timer, const int time, const int precision)
 {
@@ -160,10 +302,14 @@ void DS_TimerInit (DS_Timer* timer, const int time, const int precision)
     timer->time = time;
     timer->initialized = 1;
     timer->precision = precision;
+    timer->manual = DS_StepMode();
+
+    /* Timer is advanced with DS_TimerStep() */
+    if (timer->manual)
+        return;
 
     /* Configure the thread */
-    pthread_t thread;
-    int error = pthread_create (&thread, NULL,
+    int error = pthread_create (&timer->thread, NULL,
                                 &update_timer, (void*) timer);
 
     /* Check if thread was started */
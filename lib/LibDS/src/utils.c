@@ -121,7 +121,7 @@ void DS_ShowMessageBox (const DS_String* caption,
     DS_FREE (wmsg);
 #else
     /* Get icon text */
-    char* cico;
+    const char* cico;
     switch (icon) {
     case DS_ICON_ERROR:
         cico = "ERROR";
@@ -139,9 +139,6 @@ void DS_ShowMessageBox (const DS_String* caption,
 
     /* Log message to stderr */
     fprintf (stderr, "%s: %s\n", cico, cmsg);
-
-    /* Free icon text memory */
-    DS_FREE (cico);
 #endif
 
     /* Free resources */
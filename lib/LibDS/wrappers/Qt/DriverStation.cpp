@@ -33,6 +33,25 @@
 
 #define LOG qDebug() << "DS Client:"
 
+/* Maximum time (in msecs) that a change waits for a frame to be rendered */
+#define PUBLISH_TIMEOUT 100
+
+/**
+ * Configures the timer used to publish the pending changes when no frames
+ * are being rendered (e.g. when the window is minimized)
+ */
+DriverStation::DriverStation()
+{
+    m_portOffset = 0;
+    m_pendingChanges = 0;
+    m_frameSynchronized = false;
+
+    m_publishTimer.setSingleShot (true);
+    m_publishTimer.setInterval (PUBLISH_TIMEOUT);
+    connect (&m_publishTimer, SIGNAL (timeout()),
+             this,              SLOT (publishChanges()));
+}
+
 /**
  * Thar shall be only one tavern that manages
  * th' Driver Station interface
@@ -152,6 +171,14 @@ int DriverStation::teamNumber() const
     return DS_GetTeamNumber();
 }
 
+/**
+ * Returns the number that is added to the input ports of the protocols
+ */
+int DriverStation::portOffset() const
+{
+    return m_portOffset;
+}
+
 /**
  * Returns the number of joysticks registered with the Driver Station
  */
@@ -494,6 +521,14 @@ QString DriverStation::elapsedTime()
     return m_elapsedTime;
 }
 
+/**
+ * Returns \c true if the telemetry changes are published once per frame
+ */
+bool DriverStation::frameSynchronized() const
+{
+    return m_frameSynchronized;
+}
+
 /**
  * Returns the current status of the robot/DS.
  * This string is meant to be used directly by the clien application,
@@ -574,6 +609,42 @@ QStringList DriverStation::protocols() const
     return list;
 }
 
+/**
+ * Returns the local ports that the given \a protocol listens on (with the
+ * port offset applied), without loading the protocol
+ */
+QList<int> DriverStation::inputPorts (const Protocol protocol) const
+{
+    DS_Protocol ptr;
+    switch (protocol) {
+    case Protocol2014:
+        ptr = DS_GetProtocolFRC_2014();
+        break;
+    case Protocol2015:
+        ptr = DS_GetProtocolFRC_2015();
+        break;
+    case Protocol2016:
+        ptr = DS_GetProtocolFRC_2016();
+        break;
+    default:
+        return QList<int>();
+    }
+
+    QList<int> ports;
+    const DS_Socket* sockets [4] = {
+        &ptr.fms_socket, &ptr.radio_socket,
+        &ptr.robot_socket, &ptr.netconsole_socket
+    };
+
+    for (int i = 0; i < 4; ++i) {
+        if (sockets [i]->in_port > 0 && !sockets [i]->disabled)
+            ports.append (sockets [i]->in_port + m_portOffset);
+    }
+
+    DS_StrRmBuf (&ptr.name);
+    return ports;
+}
+
 /**
  * Returns the number of sent FMS bytes since the current
  * protocol was loaded
@@ -655,6 +726,145 @@ int DriverStation::getNumButtons (const int joystick) const
     return DS_GetJoystickNumButtons (joystick);
 }
 
+/**
+ * Returns the latency distribution of each stage of the input-to-wire path
+ * (input, encode, send and total). Each item is a map with the following
+ * values (times are given in milliseconds):
+ *
+ * - \c name:    the name of the stage
+ * - \c count:   the number of samples
+ * - \c average: the average latency
+ * - \c maximum: the largest latency
+ * - \c p50, \c p95 and \c p99: the upper bound of the percentiles
+ * - \c buckets: the number of samples of each histogram bucket, bucket N
+ *               holds the samples between 2^N and 2^(N+1) microseconds
+ */
+QVariantList DriverStation::latencyStats() const
+{
+    QVariantList list;
+    QStringList names;
+    names.append (tr ("Input"));
+    names.append (tr ("Encode"));
+    names.append (tr ("Send"));
+    names.append (tr ("Total"));
+    names.append (tr ("Queue"));
+    names.append (tr ("Round trip"));
+
+    for (int stage = 0; stage < DS_LATENCY_STAGES; ++stage) {
+        DS_LatencyHistogram histogram;
+        DS_GetLatencyHistogram ((DS_LatencyStage) stage, &histogram);
+
+        QVariantMap map;
+        QVariantList buckets;
+        map.insert ("name", names.at (stage));
+        map.insert ("count", histogram.count);
+        map.insert ("maximum", histogram.max / 1e6);
+        map.insert ("average", histogram.count > 0 ?
+                    histogram.total / 1e6 / histogram.count : 0);
+
+        /* Get the buckets and the percentiles */
+        qreal percentiles [] = {0.50, 0.95, 0.99};
+        qreal values [] = {0, 0, 0};
+        quint64 cumulative = 0;
+        for (int i = 0; i < DS_LATENCY_BUCKETS; ++i) {
+            buckets.append (histogram.buckets [i]);
+            cumulative += histogram.buckets [i];
+
+            for (int j = 0; j < 3; ++j) {
+                if (values [j] == 0 && histogram.count > 0 &&
+                        cumulative >= percentiles [j] * histogram.count)
+                    values [j] = (2 << i) / 1e3;
+            }
+        }
+
+        map.insert ("p50", values [0]);
+        map.insert ("p95", values [1]);
+        map.insert ("p99", values [2]);
+        map.insert ("buckets", buckets);
+        list.append (map);
+    }
+
+    return list;
+}
+
+/**
+ * Returns the quality of service options of the FMS and robot sockets of
+ * the current protocol. Each item is a map with the following values:
+ *
+ * - \c name:       the name of the socket
+ * - \c dscp:       the requested and applied DiffServ code points
+ * - \c priority:   the requested and applied queueing priorities
+ * - \c recvBuffer: the applied receive buffer size (in bytes)
+ * - \c sendBuffer: the applied send buffer size (in bytes)
+ * - \c busyPoll:   the applied busy polling time (in usecs)
+ *
+ * The requested values are given as \c requestedDscp and
+ * \c requestedPriority. An applied value that differs from the requested
+ * one means that the system rejected the option.
+ */
+QVariantList DriverStation::socketQoS() const
+{
+    QVariantList list;
+    DS_Protocol* protocol = DS_CurrentProtocol();
+
+    if (!protocol)
+        return list;
+
+    QList<const DS_Socket*> sockets;
+    QStringList names;
+    sockets.append (&protocol->fms_socket);
+    sockets.append (&protocol->robot_socket);
+    names.append (tr ("FMS"));
+    names.append (tr ("Robot"));
+
+    for (int i = 0; i < sockets.count(); ++i) {
+        const DS_Socket* socket = sockets.at (i);
+
+        QVariantMap map;
+        map.insert ("name", names.at (i));
+        map.insert ("requestedDscp", socket->qos.dscp);
+        map.insert ("requestedPriority", socket->qos.priority);
+        map.insert ("dscp", socket->info.applied.dscp);
+        map.insert ("priority", socket->info.applied.priority);
+        map.insert ("recvBuffer", socket->info.applied.recv_buffer);
+        map.insert ("sendBuffer", socket->info.applied.send_buffer);
+        map.insert ("busyPoll", socket->info.applied.busy_poll);
+        list.append (map);
+    }
+
+    return list;
+}
+
+/**
+ * Returns the state of the real-time profile of the protocol and socket
+ * threads, as a map with the following values:
+ *
+ * - \c enabled:    \c true if the profile is enabled
+ * - \c scheduler:  the result of the real-time priority
+ * - \c nice:       the result of the nice value (used if the priority is
+ *                  denied)
+ * - \c affinity:   the result of the CPU affinity
+ * - \c memoryLock: the result of the memory lock
+ *
+ * Each result is a \c DS_RealtimeResult value (0 = not requested,
+ * 1 = applied, 2 = denied, 3 = unsupported).
+ */
+QVariantMap DriverStation::realtimeStatus() const
+{
+    DS_RealtimeStatus status;
+    DS_RealtimeProfile profile;
+    DS_GetRealtimeStatus (&status);
+    DS_GetRealtimeProfile (&profile);
+
+    QVariantMap map;
+    map.insert ("enabled", profile.enabled != 0);
+    map.insert ("scheduler", status.scheduler);
+    map.insert ("nice", status.nice);
+    map.insert ("affinity", status.affinity);
+    map.insert ("memoryLock", status.memory_lock);
+    return map;
+}
+
 /**
  * Initializes the LibDS system and instructs the class to close the LibDS
  * before the Qt application is closed.
@@ -689,6 +899,39 @@ void DriverStation::resetJoysticks()
     emit joystickCountChanged();
 }
 
+/**
+ * Emits the notify signals of the telemetry values that changed since the
+ * last call. When frame synchronization is enabled, this function should be
+ * called once per frame (e.g. when the QML window has finished animating).
+ */
+void DriverStation::publishChanges()
+{
+    int changes = m_pendingChanges;
+    m_pendingChanges = 0;
+    m_publishTimer.stop();
+
+    if (changes & VoltageChange)
+        emit voltageChanged (voltage());
+    if (changes & CanUsageChange)
+        emit canUsageChanged (canUsage());
+    if (changes & CpuUsageChange)
+        emit cpuUsageChanged (cpuUsage());
+    if (changes & RamUsageChange)
+        emit ramUsageChanged (ramUsage());
+    if (changes & DiskUsageChange)
+        emit diskUsageChanged (diskUsage());
+    if (changes & StatusChange)
+        emit statusChanged (generalStatus());
+}
+
+/**
+ * Clears the latency statistics of the input-to-wire path
+ */
+void DriverStation::resetLatencyStats()
+{
+    DS_ResetLatency();
+}
+
 /**
  * Restarts the robot code process in the robot controller
  */
@@ -727,6 +970,19 @@ void DriverStation::setTeamNumber (const int number)
     emit teamNumberChanged (number);
 }
 
+/**
+ * Changes the number that is added to the input ports of the protocols, so
+ * that several driver stations can run on the same computer (each one with
+ * its own simulated robot, which must send its packets to these ports).
+ *
+ * \note The offset is applied when the next protocol is loaded
+ */
+void DriverStation::setPortOffset (const int offset)
+{
+    LOG << "Changing port offset to" << offset;
+    m_portOffset = qMax (offset, 0);
+}
+
 /**
  * De-allocates the current protocol and loads the given \a protocol
  *
@@ -734,7 +990,17 @@ void DriverStation::setTeamNumber (const int number)
  */
 void DriverStation::loadProtocol (const DS_Protocol& protocol)
 {
-    DS_ConfigureProtocol (&protocol);
+    DS_Protocol copy = protocol;
+    if (copy.fms_socket.in_port > 0)
+        copy.fms_socket.in_port += m_portOffset;
+    if (copy.radio_socket.in_port > 0)
+        copy.radio_socket.in_port += m_portOffset;
+    if (copy.robot_socket.in_port > 0)
+        copy.robot_socket.in_port += m_portOffset;
+    if (copy.netconsole_socket.in_port > 0)
+        copy.netconsole_socket.in_port += m_portOffset;
+
+    DS_ConfigureProtocol (&copy);
 
     setCustomFMSAddress (customFMSAddress());
     setCustomRadioAddress (customRadioAddress());
@@ -895,6 +1161,35 @@ void DriverStation::setEmergencyStopped (const bool stopped)
     DS_SetEmergencyStopped (stopped);
 }
 
+/**
+ * Enables or disables frame synchronization. When enabled, the voltage,
+ * robot usage and status changes are gathered and only notified when
+ * \c publishChanges() is called, so that each property is notified (and
+ * each QML binding is evaluated) at most once per frame.
+ *
+ * The \c changesPending() signal is emitted when the first change is
+ * gathered, so that the application can request a new frame.
+ */
+void DriverStation::setFrameSynchronized (const bool synchronized)
+{
+    m_frameSynchronized = synchronized;
+
+    if (!synchronized)
+        publishChanges();
+}
+
+/**
+ * Enables or disables the real-time profile of the protocol and socket
+ * threads, which gives them a higher priority than the UI threads
+ */
+void DriverStation::setRealtimeEnabled (const bool enabled)
+{
+    DS_RealtimeProfile profile;
+    DS_GetRealtimeProfile (&profile);
+    profile.enabled = enabled;
+    DS_SetRealtimeProfile (&profile);
+}
+
 /**
  * Forces the LibDS to use the given \a address to communicate with the FMS
  */
@@ -955,6 +1250,38 @@ void DriverStation::addJoystick (int axes, int hats, int buttons)
     emit joystickCountChanged();
 }
 
+/**
+ * Registers a joystick in the given \a joystick slot, the other joysticks
+ * keep their slots
+ *
+ * \param joystick the slot of the joystick (e.g. 0 for Joystick 0)
+ * \param axes the number of axes of the joystick
+ * \param hats the number of hats/povs of the joystick
+ * \param buttons the number of buttons of the joystick
+ */
+void DriverStation::setJoystick (int joystick, int axes, int hats, int buttons)
+{
+    DS_JoysticksSet (joystick, axes, hats, buttons);
+
+    LOG << "Registered joystick" << joystick << "with"
+        << axes << "axes,"
+        << hats << "hats and"
+        << buttons << "buttons";
+
+    emit joystickCountChanged();
+}
+
+/**
+ * Removes the joystick in the given \a joystick slot, the other joysticks
+ * keep their slots
+ */
+void DriverStation::removeJoystick (int joystick)
+{
+    LOG << "Removing joystick" << joystick;
+    DS_JoysticksRemove (joystick);
+    emit joystickCountChanged();
+}
+
 /**
  * Updates the \a angle of the given \a hat of the given \a joystick
  *
@@ -1009,6 +1336,9 @@ void DriverStation::quitDS()
 /**
  * Polls for new LibDS events and emits Qt signals as appropiate.
  * This function is called every 5 milliseconds.
+ *
+ * The \c *Sampled() signals are emitted for every LibDS event (even if
+ * frame synchronization is enabled), so that loggers get every sample.
  */
 void DriverStation::processEvents()
 {
@@ -1040,19 +1370,24 @@ void DriverStation::processEvents()
             emit robotCodeChanged (event.robot.code);
             break;
         case DS_ROBOT_VOLTAGE_CHANGED:
-            emit voltageChanged (event.robot.voltage);
+            emit voltageSampled (event.robot.voltage);
+            notifyChange (VoltageChange);
             break;
         case DS_ROBOT_CAN_UTIL_CHANGED:
-            emit canUsageChanged (event.robot.can_util);
+            emit canUsageSampled (event.robot.can_util);
+            notifyChange (CanUsageChange);
             break;
         case DS_ROBOT_CPU_INFO_CHANGED:
-            emit cpuUsageChanged (event.robot.cpu_usage);
+            emit cpuUsageSampled (event.robot.cpu_usage);
+            notifyChange (CpuUsageChange);
             break;
         case DS_ROBOT_RAM_INFO_CHANGED:
-            emit ramUsageChanged (event.robot.ram_usage);
+            emit ramUsageSampled (event.robot.ram_usage);
+            notifyChange (RamUsageChange);
             break;
         case DS_ROBOT_DISK_INFO_CHANGED:
-            emit diskUsageChanged (event.robot.disk_usage);
+            emit diskUsageSampled (event.robot.disk_usage);
+            notifyChange (DiskUsageChange);
             break;
         case DS_ROBOT_STATION_CHANGED:
             emit stationChanged();
@@ -1063,7 +1398,7 @@ void DriverStation::processEvents()
             emit emergencyStoppedChanged (event.robot.estopped);
             break;
         case DS_STATUS_STRING_CHANGED:
-            emit statusChanged (QString::fromUtf8 (DS_GetStatusString()));
+            notifyChange (StatusChange);
             break;
         default:
             break;
@@ -1109,6 +1444,26 @@ void DriverStation::updateElapsedTime()
                         this, SLOT (updateElapsedTime()));
 }
 
+/**
+ * Notifies the given \a change immediately, or gathers it until the next
+ * call to \c publishChanges() if frame synchronization is enabled
+ */
+void DriverStation::notifyChange (const Change change)
+{
+    if (!m_frameSynchronized) {
+        m_pendingChanges = change;
+        publishChanges();
+        return;
+    }
+
+    if (m_pendingChanges == 0) {
+        m_publishTimer.start();
+        emit changesPending();
+    }
+
+    m_pendingChanges |= change;
+}
+
 /**
  * Returns a valid network \a address
  */
@@ -28,8 +28,10 @@
 #endif
 
 #include <QTime>
+#include <QTimer>
 #include <QObject>
 #include <QStringList>
+#include <QVariantMap>
 #include <DS_Protocol.h>
 
 class DriverStation : public QObject
@@ -167,8 +169,12 @@ class DriverStation : public QObject
                 NOTIFY controlModeChanged)
     Q_PROPERTY (bool canBeEnabled
                 READ canBeEnabled)
+    Q_PROPERTY (bool frameSynchronized
+                READ frameSynchronized
+                WRITE setFrameSynchronized)
 
 public:
+    DriverStation();
     static DriverStation* getInstance();
 
     enum Control {
@@ -220,6 +226,7 @@ public:
     static QString libDSVersion();
 
     int teamNumber() const;
+    int portOffset() const;
     int joystickCount() const;
 
     int cpuUsage() const;
@@ -260,6 +267,7 @@ public:
     QString defaultRobotAddress() const;
 
     QString elapsedTime();
+    bool frameSynchronized() const;
     QString generalStatus() const;
     QString customFMSAddress() const;
     QString customRadioAddress() const;
@@ -267,6 +275,7 @@ public:
 
     QStringList stations() const;
     QStringList protocols() const;
+    QList<int> inputPorts (const Protocol protocol) const;
 
     Q_INVOKABLE unsigned long sentFMSBytes() const;
     Q_INVOKABLE unsigned long sentRadioBytes() const;
@@ -279,13 +288,20 @@ public:
     Q_INVOKABLE int getNumHats (const int joystick) const;
     Q_INVOKABLE int getNumButtons (const int joystick) const;
 
+    Q_INVOKABLE QVariantList latencyStats() const;
+    Q_INVOKABLE QVariantList socketQoS() const;
+    Q_INVOKABLE QVariantMap realtimeStatus() const;
+
 public slots:
     void start();
     void rebootRobot();
     void resetJoysticks();
+    void publishChanges();
+    void resetLatencyStats();
     void restartRobotCode();
     void setEnabled (const bool enabled);
     void setTeamNumber (const int number);
+    void setPortOffset (const int offset);
     void loadProtocol (const DS_Protocol& protocol);
     void setControlMode (const Control mode);
     void setProtocol (const Protocol protocol);
@@ -293,12 +309,16 @@ public slots:
     void setTeamAlliance (const Alliance alliance);
     void setTeamPosition (const Position position);
     void setEmergencyStopped (const bool stopped);
+    void setFrameSynchronized (const bool synchronized);
+    void setRealtimeEnabled (const bool enabled);
     void setCustomFMSAddress (const QString& address);
     void setCustomRadioAddress (const QString& address);
     void setCustomRobotAddress (const QString& address);
     void sendNetConsoleMessage (const QString& message);
 
+    void removeJoystick (int joystick);
     void addJoystick (int axes, int hats, int buttons);
+    void setJoystick (int joystick, int axes, int hats, int buttons);
     void setJoystickHat (int joystick, int hat, int angle);
     void setJoystickAxis (int joystick, int axis, float value);
     void setJoystickButton (int joystick, int button, bool pressed);
@@ -310,9 +330,20 @@ private slots:
     void updateElapsedTime();
 
 private:
+    enum Change {
+        VoltageChange   = 0x01,
+        CanUsageChange  = 0x02,
+        CpuUsageChange  = 0x04,
+        RamUsageChange  = 0x08,
+        DiskUsageChange = 0x10,
+        StatusChange    = 0x20,
+    };
+
+    void notifyChange (const Change change);
     QString getAddress (const QString& address);
 
 signals:
+    void changesPending();
     void stationChanged();
     void protocolChanged();
     void fmsAddressChanged();
@@ -323,11 +354,16 @@ signals:
     void cpuUsageChanged (const int usage);
     void ramUsageChanged (const int usage);
     void diskUsageChanged (const int usage);
+    void canUsageSampled (const int usage);
+    void cpuUsageSampled (const int usage);
+    void ramUsageSampled (const int usage);
+    void diskUsageSampled (const int usage);
     void enabledChanged (const bool enabled);
     void newMessage (const QString& message);
     void teamNumberChanged (const int number);
     void statusChanged (const QString& status);
     void voltageChanged (const float voltage);
+    void voltageSampled (const float voltage);
     void robotCodeChanged (const bool robotCode);
     void controlModeChanged (const Control mode);
     void allianceChanged (const Alliance alliance);
@@ -341,6 +377,11 @@ signals:
 private:
     QTime m_time;
     QString m_elapsedTime;
+
+    int m_portOffset;
+    int m_pendingChanges;
+    bool m_frameSynchronized;
+    QTimer m_publishTimer;
 };
 
 #endif
@@ -30,6 +30,7 @@
 #include <QDebug>
 #include <QTimer>
 #include <QSysInfo>
+#include <QSettings>
 #include <QDateTime>
 #include <QJsonArray>
 #include <QJsonObject>
@@ -65,7 +66,10 @@ DSEventLogger::DSEventLogger()
     m_init = 0;
     m_dump = NULL;
     m_currentLog = "";
+    m_currentTelemetry = "";
 
+    registerChannels();
+    loadLimits();
     init();
 
     saveDataLoop();
@@ -73,11 +77,12 @@ DSEventLogger::DSEventLogger()
 }
 
 /**
- * Closes the log file
+ * Closes the log files
  */
 DSEventLogger::~DSEventLogger()
 {
     saveData();
+    m_telemetry.close();
 }
 
 /**
@@ -100,6 +105,44 @@ QString DSEventLogger::logsPath() const
                  qApp->applicationVersion().toLower());
 }
 
+/**
+ * Returns the path of the telemetry log of the current session
+ */
+QString DSEventLogger::currentTelemetryLog() const
+{
+    return m_currentTelemetry;
+}
+
+/**
+ * Returns the in-memory history of the telemetry channels
+ */
+const DSTelemetryHistory* DSEventLogger::history() const
+{
+    return &m_history;
+}
+
+/**
+ * Returns the most recent NetConsole messages
+ */
+const DSRingBuffer<QPair<qint64, QString>>* DSEventLogger::messages() const
+{
+    return &m_messages;
+}
+
+/**
+ * Returns the number of bytes used by the in-memory telemetry history and
+ * the recent NetConsole messages
+ */
+qint64 DSEventLogger::memoryUsage() const
+{
+    qint64 usage = m_history.memoryUsage() + m_messages.memoryUsage();
+
+    for (int i = 0; i < m_messages.count(); ++i)
+        usage += m_messages.at (i).second.capacity() * sizeof (QChar);
+
+    return usage;
+}
+
 /**
  * Calls the appropiate functions to display the \a data on the console
  * and write it on the log file
@@ -199,15 +242,22 @@ void DSEventLogger::init()
         if (!dir.exists())
             dir.mkpath (".");
 
-        /* Get dump file path */
-        m_currentLog = QString ("%1/%2.log")
+        /* Get dump file path (the PID avoids overwriting the logs of
+         * another instance started in the same second) */
+        m_currentLog = QString ("%1/%2 - %3.log")
                        .arg (path)
-                       .arg (GET_DATE_TIME ("HH_mm_ss AP"));
+                       .arg (GET_DATE_TIME ("HH_mm_ss AP"))
+                       .arg (qApp->applicationPid());
 
         /* Open dump file */
         m_dump = fopen (m_currentLog.toStdString().c_str(), "w");
         m_dump = !m_dump ? stderr : m_dump;
 
+        /* Open telemetry file (next to the dump file) */
+        m_currentTelemetry = m_currentLog;
+        m_currentTelemetry.replace (m_currentTelemetry.length() - 4, 4, ".tlm");
+        m_telemetry.open (m_currentTelemetry, currentTime());
+
         /* Get OS information */
         QString sysV;
 #if QT_VERSION >= QT_VERSION_CHECK (5, 4, 0)
@@ -265,6 +315,42 @@ void DSEventLogger::openCurrentLog()
         QDesktopServices::openUrl (QUrl::fromLocalFile (m_currentLog));
 }
 
+/**
+ * Changes the number of NetConsole messages kept in memory
+ */
+void DSEventLogger::setMessageLimit (int messages)
+{
+    m_messages.setCapacity (messages);
+
+    QSettings settings (qApp->organizationName(), qApp->applicationName());
+    settings.setValue ("EventLogger/Messages", messages);
+
+    LOG << "Message limit set to" << messages
+        << "- memory usage:" << memoryUsage() << "bytes";
+}
+
+/**
+ * Changes the number of full-resolution \a samples, 1-second buckets and
+ * 10-second buckets kept in memory for each telemetry channel
+ */
+void DSEventLogger::setHistoryLimits (int samples, int seconds, int tens)
+{
+    DSTelemetryHistory::Limits limits;
+    limits.samples = samples;
+    limits.seconds = seconds;
+    limits.tens = tens;
+
+    m_history.setLimits (limits);
+
+    QSettings settings (qApp->organizationName(), qApp->applicationName());
+    settings.setValue ("EventLogger/Samples", samples);
+    settings.setValue ("EventLogger/Seconds", seconds);
+    settings.setValue ("EventLogger/Tens", tens);
+
+    LOG << "History limits set to" << samples << seconds << tens
+        << "- memory usage:" << memoryUsage() << "bytes";
+}
+
 /**
  * Saves the log data to the disk and schedules another call in the future
  */
@@ -279,8 +365,7 @@ void DSEventLogger::saveDataLoop()
  */
 void DSEventLogger::onCANUsageChanged (int usage)
 {
-    Q_UNUSED (usage);
-    m_canUsageLog.append (qMakePair<qint64, int> (currentTime(), usage));
+    append (ChannelCANUsage, usage);
 }
 
 /**
@@ -288,8 +373,7 @@ void DSEventLogger::onCANUsageChanged (int usage)
  */
 void DSEventLogger::onCPUUsageChanged (int usage)
 {
-    Q_UNUSED (usage);
-    m_cpuUsageLog.append (qMakePair<qint64, int> (currentTime(), usage));
+    append (ChannelCPUUsage, usage);
 }
 
 /**
@@ -297,8 +381,7 @@ void DSEventLogger::onCPUUsageChanged (int usage)
  */
 void DSEventLogger::onRAMUsageChanged (int usage)
 {
-    Q_UNUSED (usage);
-    m_ramUsageLog.append (qMakePair<qint64, int> (currentTime(), usage));
+    append (ChannelRAMUsage, usage);
 }
 
 /**
@@ -306,8 +389,12 @@ void DSEventLogger::onRAMUsageChanged (int usage)
  */
 void DSEventLogger::onNewMessage (QString message)
 {
-    Q_UNUSED (message);
-    m_messagesLog.append (qMakePair<qint64, QString> (currentTime(), message));
+    m_messages.append (qMakePair (currentTime(), message));
+
+    if (m_dump) {
+        fprintf (m_dump, PRINT_FMT, "", "NETCONSOLE", PRINT (message));
+        fflush (m_dump);
+    }
 }
 
 /**
@@ -315,8 +402,7 @@ void DSEventLogger::onNewMessage (QString message)
  */
 void DSEventLogger::onDiskUsageChanged (int usage)
 {
-    Q_UNUSED (usage);
-    m_diskUsageLog.append (qMakePair<qint64, int> (currentTime(), usage));
+    append (ChannelDiskUsage, usage);
 }
 
 /**
@@ -325,7 +411,7 @@ void DSEventLogger::onDiskUsageChanged (int usage)
 void DSEventLogger::onEnabledChanged (bool enabled)
 {
     LOG << "Robot enabled state set to" << enabled;
-    m_enabledLog.append (qMakePair<qint64, bool> (currentTime(), enabled));
+    append (ChannelEnabled, (int) enabled);
 }
 
 /**
@@ -341,8 +427,7 @@ void DSEventLogger::onTeamNumberChanged (int number)
  */
 void DSEventLogger::onVoltageChanged (float voltage)
 {
-    Q_UNUSED (voltage);
-    m_voltageLog.append (qMakePair<qint64, float> (currentTime(), voltage));
+    append (ChannelVoltage, voltage);
 }
 
 /**
@@ -351,7 +436,7 @@ void DSEventLogger::onVoltageChanged (float voltage)
 void DSEventLogger::onRobotCodeChanged (bool robotCode)
 {
     LOG << "Robot code status set to" << robotCode;
-    m_robotCodeLog.append (qMakePair<qint64, bool> (currentTime(), robotCode));
+    append (ChannelRobotCode, (int) robotCode);
 }
 
 /**
@@ -360,7 +445,7 @@ void DSEventLogger::onRobotCodeChanged (bool robotCode)
 void DSEventLogger::onFMSCommunicationsChanged (bool connected)
 {
     LOG << "FMS communications set to" << connected;
-    m_fmsCommsLog.append (qMakePair<qint64, bool> (currentTime(), connected));
+    append (ChannelFMSComms, (int) connected);
 }
 
 /**
@@ -369,7 +454,7 @@ void DSEventLogger::onFMSCommunicationsChanged (bool connected)
 void DSEventLogger::onRadioCommunicationsChanged (bool connected)
 {
     LOG << "Radio communications set to" << connected;
-    m_radioCommsLog.append (qMakePair<qint64, bool> (currentTime(), connected));
+    append (ChannelRadioComms, (int) connected);
 }
 
 /**
@@ -378,7 +463,7 @@ void DSEventLogger::onRadioCommunicationsChanged (bool connected)
 void DSEventLogger::onRobotCommunicationsChanged (bool connected)
 {
     LOG << "Robot communications set to" << connected;
-    m_robotCommsLog.append (qMakePair<qint64, bool> (currentTime(), connected));
+    append (ChannelRobotComms, (int) connected);
 }
 
 /**
@@ -387,8 +472,7 @@ void DSEventLogger::onRobotCommunicationsChanged (bool connected)
 void DSEventLogger::onEmergencyStoppedChanged (bool emergencyStopped)
 {
     LOG << "ESTOP set to" << emergencyStopped;
-    m_emergencyStopLog.append (qMakePair<qint64, bool> (currentTime(),
-                               emergencyStopped));
+    append (ChannelEmergencyStop, (int) emergencyStopped);
 }
 
 /**
@@ -397,8 +481,7 @@ void DSEventLogger::onEmergencyStoppedChanged (bool emergencyStopped)
 void DSEventLogger::onControlModeChanged (DriverStation::Control mode)
 {
     LOG << "Robot control mode set to" << mode;
-    m_controlModeLog.append (qMakePair<qint64, int> (currentTime(),
-                                                     (int) mode));
+    append (ChannelControlMode, (int) mode);
 }
 
 /**
@@ -418,10 +501,72 @@ void DSEventLogger::onPositionChanged (DriverStation::Position position)
 }
 
 /**
- * Saves the current log information to a local file using the JSON format
+ * Writes the pending telemetry samples to the disk. Since the telemetry
+ * blocks are re-written in place, this function is cheap to call often.
  */
 void DSEventLogger::saveData()
 {
+    m_telemetry.flush();
+}
+
+/**
+ * Registers the telemetry channels, the registration order must match the
+ * order of the \c Channels enum
+ */
+void DSEventLogger::registerChannels()
+{
+    m_telemetry.addChannel ("CAN Usage",      DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("CPU Usage",      DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("RAM Usage",      DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("Disk Usage",     DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("Voltage",        DSTelemetryLog::Float);
+    m_telemetry.addChannel ("Enabled",        DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("Robot Code",     DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("FMS Comms",      DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("Radio Comms",    DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("Robot Comms",    DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("Emergency Stop", DSTelemetryLog::Integer);
+    m_telemetry.addChannel ("Control Mode",   DSTelemetryLog::Integer);
+
+    m_history.setChannelCount (ChannelCount);
+}
+
+/**
+ * Reads the limits of the in-memory history and of the NetConsole messages
+ * from the application settings (the limits are saved when they are changed
+ * with \c setHistoryLimits() and \c setMessageLimit())
+ */
+void DSEventLogger::loadLimits()
+{
+    QSettings settings (qApp->organizationName(), qApp->applicationName());
+    DSTelemetryHistory::Limits limits = m_history.limits();
+
+    limits.samples = settings.value ("EventLogger/Samples", limits.samples).toInt();
+    limits.seconds = settings.value ("EventLogger/Seconds", limits.seconds).toInt();
+    limits.tens = settings.value ("EventLogger/Tens", limits.tens).toInt();
+
+    m_history.setLimits (limits);
+    m_messages.setCapacity (settings.value ("EventLogger/Messages", 500).toInt());
+}
+
+/**
+ * Writes the given integer \a value to the telemetry log and the history
+ */
+void DSEventLogger::append (const int channel, const int value)
+{
+    qint64 time = currentTime();
+    m_telemetry.append (channel, time, value);
+    m_history.append (channel, time, value);
+}
+
+/**
+ * Writes the given float \a value to the telemetry log and the history
+ */
+void DSEventLogger::append (const int channel, const float value)
+{
+    qint64 time = currentTime();
+    m_telemetry.append (channel, time, value);
+    m_history.append (channel, time, value);
 }
 
 /**
@@ -432,21 +577,21 @@ void DSEventLogger::connectSlots()
 {
     DriverStation* ds = DriverStation::getInstance();
 
-    connect (ds,   &DriverStation::canUsageChanged,
+    connect (ds,   &DriverStation::canUsageSampled,
              this, &DSEventLogger::onCANUsageChanged);
-    connect (ds,   &DriverStation::cpuUsageChanged,
+    connect (ds,   &DriverStation::cpuUsageSampled,
              this, &DSEventLogger::onCPUUsageChanged);
-    connect (ds,   &DriverStation::ramUsageChanged,
+    connect (ds,   &DriverStation::ramUsageSampled,
              this, &DSEventLogger::onRAMUsageChanged);
     connect (ds,   &DriverStation::newMessage,
              this, &DSEventLogger::onNewMessage);
-    connect (ds,   &DriverStation::diskUsageChanged,
+    connect (ds,   &DriverStation::diskUsageSampled,
              this, &DSEventLogger::onDiskUsageChanged);
     connect (ds,   &DriverStation::enabledChanged,
              this, &DSEventLogger::onEnabledChanged);
     connect (ds,   &DriverStation::teamNumberChanged,
              this, &DSEventLogger::onTeamNumberChanged);
-    connect (ds,   &DriverStation::voltageChanged,
+    connect (ds,   &DriverStation::voltageSampled,
              this, &DSEventLogger::onVoltageChanged);
     connect (ds,   &DriverStation::robotCodeChanged,
              this, &DSEventLogger::onRobotCodeChanged);
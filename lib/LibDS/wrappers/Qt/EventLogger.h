@@ -25,6 +25,9 @@
 #include <QElapsedTimer>
 
 #include "DriverStation.h"
+#include "RingBuffer.h"
+#include "TelemetryLog.h"
+#include "TelemetryHistory.h"
 
 class DSEventLogger : public QObject
 {
@@ -34,6 +37,11 @@ public:
     static DSEventLogger* getInstance();
 
     QString logsPath() const;
+    QString currentTelemetryLog() const;
+    const DSTelemetryHistory* history() const;
+    const DSRingBuffer<QPair<qint64, QString>>* messages() const;
+
+    Q_INVOKABLE qint64 memoryUsage() const;
     static void messageHandler (QtMsgType type,
                                 const QMessageLogContext& context,
                                 const QString& data);
@@ -48,6 +56,8 @@ public slots:
     void init();
     void openLogsPath();
     void openCurrentLog();
+    void setMessageLimit (int messages);
+    void setHistoryLimits (int samples, int seconds, int tens);
 
 private slots:
     void saveDataLoop();
@@ -69,8 +79,28 @@ private slots:
     void onPositionChanged (DriverStation::Position position);
 
 private:
+    enum Channels {
+        ChannelCANUsage,
+        ChannelCPUUsage,
+        ChannelRAMUsage,
+        ChannelDiskUsage,
+        ChannelVoltage,
+        ChannelEnabled,
+        ChannelRobotCode,
+        ChannelFMSComms,
+        ChannelRadioComms,
+        ChannelRobotComms,
+        ChannelEmergencyStop,
+        ChannelControlMode,
+        ChannelCount,
+    };
+
     void saveData();
     void connectSlots();
+    void loadLimits();
+    void registerChannels();
+    void append (const int channel, const int value);
+    void append (const int channel, const float value);
     qint64 currentTime();
 
 private:
@@ -78,18 +108,8 @@ private:
     FILE* m_dump;
     QString m_currentLog;
     QElapsedTimer m_timer;
-
-    QList<QPair<qint64, int>> m_canUsageLog;
-    QList<QPair<qint64, int>> m_cpuUsageLog;
-    QList<QPair<qint64, int>> m_ramUsageLog;
-    QList<QPair<qint64, bool>> m_enabledLog;
-    QList<QPair<qint64, int>> m_diskUsageLog;
-    QList<QPair<qint64, float>> m_voltageLog;
-    QList<QPair<qint64, bool>> m_fmsCommsLog;
-    QList<QPair<qint64, bool>> m_robotCodeLog;
-    QList<QPair<qint64, bool>> m_radioCommsLog;
-    QList<QPair<qint64, bool>> m_robotCommsLog;
-    QList<QPair<qint64, int>> m_controlModeLog;
-    QList<QPair<qint64, QString>> m_messagesLog;
-    QList<QPair<qint64, bool>> m_emergencyStopLog;
+    QString m_currentTelemetry;
+    DSTelemetryLog m_telemetry;
+    DSTelemetryHistory m_history;
+    DSRingBuffer<QPair<qint64, QString>> m_messages;
 };
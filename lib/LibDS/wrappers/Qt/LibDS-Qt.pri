@@ -13,8 +13,19 @@ include ($$PWD/../../LibDS.pri)
 
 HEADERS += \
     $$PWD/DriverStation.h \
-    $$PWD/EventLogger.h
+    $$PWD/EventLogger.h \
+    $$PWD/NetConsoleModel.h \
+    $$PWD/RingBuffer.h \
+    $$PWD/TelemetryHistory.h \
+    $$PWD/TelemetryLog.h \
+    $$PWD/TelemetryModel.h \
+    $$PWD/TelemetryReader.h
 
 SOURCES += \
     $$PWD/DriverStation.cpp \
-    $$PWD/EventLogger.cpp
+    $$PWD/EventLogger.cpp \
+    $$PWD/NetConsoleModel.cpp \
+    $$PWD/TelemetryHistory.cpp \
+    $$PWD/TelemetryLog.cpp \
+    $$PWD/TelemetryModel.cpp \
+    $$PWD/TelemetryReader.cpp
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "NetConsoleModel.h"
+#include "DriverStation.h"
+
+#include <QUrl>
+#include <QFile>
+#include <QDateTime>
+#include <QTextStream>
+#include <QTextDocument>
+#include <QTextDocumentFragment>
+
+/* Default number of messages kept in memory */
+#define DEFAULT_LIMIT 5000
+
+/**
+ * Allocates the message buffer and starts receiving NetConsole messages
+ */
+DSNetConsoleModel::DSNetConsoleModel (QObject* parent) :
+    QAbstractListModel (parent)
+{
+    m_first = 0;
+    m_messages.setCapacity (DEFAULT_LIMIT);
+
+    connect (DriverStation::getInstance(), &DriverStation::newMessage,
+             this,                         &DSNetConsoleModel::append);
+}
+
+/**
+ * Returns the number of messages that match the filter
+ */
+int DSNetConsoleModel::rowCount (const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    if (m_filter.isEmpty())
+        return m_messages.count();
+
+    return m_rows.count();
+}
+
+/**
+ * Returns the time, text or format of the message at the given \a index
+ */
+QVariant DSNetConsoleModel::data (const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount())
+        return QVariant();
+
+    const Message& message = messageAt (index.row());
+
+    switch (role) {
+    case TimeRole:
+        return message.time;
+    case MessageRole:
+        return message.message;
+    case PlainTextRole:
+        return message.plainText;
+    case RichTextRole:
+        return message.richText;
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * Returns the names of the roles used by the QML delegates
+ */
+QHash<int, QByteArray> DSNetConsoleModel::roleNames() const
+{
+    QHash<int, QByteArray> names;
+    names.insert (TimeRole,      "time");
+    names.insert (MessageRole,   "message");
+    names.insert (PlainTextRole, "plainText");
+    names.insert (RichTextRole,  "richText");
+    return names;
+}
+
+/**
+ * Returns the maximum number of messages kept in memory
+ */
+int DSNetConsoleModel::limit() const
+{
+    return m_messages.capacity();
+}
+
+/**
+ * Returns the number of messages that match the filter
+ */
+int DSNetConsoleModel::count() const
+{
+    return rowCount();
+}
+
+/**
+ * Returns the number of messages kept in memory
+ */
+int DSNetConsoleModel::totalCount() const
+{
+    return m_messages.count();
+}
+
+/**
+ * Returns the text used to filter the messages
+ */
+QString DSNetConsoleModel::filter() const
+{
+    return m_filter;
+}
+
+/**
+ * Returns the plain text of the messages that match the filter, used to
+ * copy the console output to the clipboard
+ */
+QString DSNetConsoleModel::toPlainText() const
+{
+    QString text;
+    for (int i = 0; i < rowCount(); ++i)
+        text.append (messageAt (i).plainText + "\n");
+
+    return text;
+}
+
+/**
+ * Writes all the messages kept in memory (ignoring the filter) to the
+ * file at the given \a path, which may also be a local file URL
+ *
+ * \returns \c true on success
+ */
+bool DSNetConsoleModel::exportToFile (const QString& path) const
+{
+    QUrl url (path);
+    QFile file (url.isLocalFile() ? url.toLocalFile() : path);
+
+    if (!file.open (QFile::WriteOnly | QFile::Text))
+        return false;
+
+    QTextStream stream (&file);
+    for (int i = 0; i < m_messages.count(); ++i) {
+        const Message& message = m_messages.at (i);
+        stream << QDateTime::fromMSecsSinceEpoch (message.time).toString (
+                   "yyyy-MM-dd hh:mm:ss.zzz")
+               << "  " << message.plainText << "\n";
+    }
+
+    stream.flush();
+    return file.error() == QFile::NoError;
+}
+
+/**
+ * Returns the row of the next message (starting at \a from) that contains
+ * the given \a text, the search wraps around the end of the model.
+ *
+ * \returns -1 if no message contains the \a text
+ */
+int DSNetConsoleModel::find (const QString& text, const int from,
+                             const bool backwards) const
+{
+    int rows = rowCount();
+    if (text.isEmpty() || rows == 0)
+        return -1;
+
+    int start = qBound (0, from, rows - 1);
+    for (int i = 0; i < rows; ++i) {
+        int row = backwards ? (start - i + rows) % rows : (start + i) % rows;
+        if (matches (messageAt (row), text))
+            return row;
+    }
+
+    return -1;
+}
+
+/**
+ * Removes all the messages
+ */
+void DSNetConsoleModel::clear()
+{
+    beginResetModel();
+    m_first += m_messages.count();
+    m_messages.clear();
+    m_rows.clear();
+    endResetModel();
+
+    emit countChanged();
+}
+
+/**
+ * Registers the given \a message, if the buffer is full the oldest message
+ * is removed first
+ */
+void DSNetConsoleModel::append (const QString& message)
+{
+    Message item;
+    item.message = message;
+    item.time = QDateTime::currentMSecsSinceEpoch();
+    item.richText = Qt::mightBeRichText (message);
+
+    if (item.richText)
+        item.plainText = QTextDocumentFragment::fromHtml (message).toPlainText();
+    else
+        item.plainText = message;
+
+    /* Remove the oldest message */
+    if (m_messages.count() == m_messages.capacity()) {
+        bool filtered = !m_filter.isEmpty();
+        bool visible = !filtered || (!m_rows.isEmpty() && m_rows.first() == m_first);
+
+        if (visible)
+            beginRemoveRows (QModelIndex(), 0, 0);
+
+        if (filtered && visible)
+            m_rows.removeFirst();
+
+        ++m_first;
+        m_messages.removeFirst();
+
+        if (visible)
+            endRemoveRows();
+    }
+
+    /* Add the new message */
+    if (matches (item, m_filter)) {
+        int row = rowCount();
+        beginInsertRows (QModelIndex(), row, row);
+
+        m_messages.append (item);
+        if (!m_filter.isEmpty())
+            m_rows.append (m_first + m_messages.count() - 1);
+
+        endInsertRows();
+    }
+
+    else
+        m_messages.append (item);
+
+    emit countChanged();
+}
+
+/**
+ * Changes the maximum number of messages kept in memory, the newest
+ * messages are kept
+ */
+void DSNetConsoleModel::setLimit (const int limit)
+{
+    int capacity = qMax (limit, 1);
+    if (capacity == m_messages.capacity())
+        return;
+
+    beginResetModel();
+
+    QList<Message> messages;
+    int start = qMax (0, m_messages.count() - capacity);
+    for (int i = start; i < m_messages.count(); ++i)
+        messages.append (m_messages.at (i));
+
+    m_first += start;
+    m_messages.setCapacity (capacity);
+    foreach (const Message& message, messages)
+        m_messages.append (message);
+
+    updateRows (QString());
+    endResetModel();
+
+    emit limitChanged();
+    emit countChanged();
+}
+
+/**
+ * Only shows the messages that contain the given \a filter text
+ */
+void DSNetConsoleModel::setFilter (const QString& filter)
+{
+    if (m_filter == filter)
+        return;
+
+    QString previous = m_filter;
+
+    beginResetModel();
+    m_filter = filter;
+    updateRows (previous);
+    endResetModel();
+
+    emit filterChanged();
+    emit countChanged();
+}
+
+/**
+ * Returns the message displayed at the given \a row
+ */
+const DSNetConsoleModel::Message& DSNetConsoleModel::messageAt (
+    const int row) const
+{
+    if (m_filter.isEmpty())
+        return m_messages.at (row);
+
+    return m_messages.at (m_rows.at (row) - m_first);
+}
+
+/**
+ * Returns \c true if the plain text of the \a message contains the given
+ * \a filter text (ignoring the case)
+ */
+bool DSNetConsoleModel::matches (const Message& message,
+                                 const QString& filter) const
+{
+    return filter.isEmpty() || message.plainText.contains (filter,
+                                                           Qt::CaseInsensitive);
+}
+
+/**
+ * Re-builds the list of messages that match the filter. If the new filter
+ * contains the \a previousFilter (e.g. the user typed another letter), only
+ * the messages that matched the previous filter are checked.
+ */
+void DSNetConsoleModel::updateRows (const QString& previousFilter)
+{
+    if (m_filter.isEmpty()) {
+        m_rows.clear();
+        return;
+    }
+
+    if (!previousFilter.isEmpty()
+            && m_filter.contains (previousFilter, Qt::CaseInsensitive)) {
+        QList<qint64> rows;
+        foreach (qint64 index, m_rows) {
+            if (matches (m_messages.at (index - m_first), m_filter))
+                rows.append (index);
+        }
+
+        m_rows = rows;
+        return;
+    }
+
+    m_rows.clear();
+    for (int i = 0; i < m_messages.count(); ++i) {
+        if (matches (m_messages.at (i), m_filter))
+            m_rows.append (m_first + i);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _NETCONSOLE_MODEL_H
+#define _NETCONSOLE_MODEL_H
+
+#include <QList>
+#include <QAbstractListModel>
+
+#include "RingBuffer.h"
+
+/**
+ * Keeps the latest NetConsole messages in a ring buffer and exposes them to
+ * QML as a list model, so that only the visible messages are rendered.
+ *
+ * The model can be filtered with a case-insensitive search string, and the
+ * whole history (regardless of the filter) can be exported to a text file.
+ */
+class DSNetConsoleModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY (int limit
+                READ limit
+                WRITE setLimit
+                NOTIFY limitChanged)
+    Q_PROPERTY (QString filter
+                READ filter
+                WRITE setFilter
+                NOTIFY filterChanged)
+    Q_PROPERTY (int count
+                READ count
+                NOTIFY countChanged)
+    Q_PROPERTY (int totalCount
+                READ totalCount
+                NOTIFY countChanged)
+
+public:
+    enum Roles {
+        TimeRole = Qt::UserRole + 1,
+        MessageRole,
+        PlainTextRole,
+        RichTextRole,
+    };
+
+    DSNetConsoleModel (QObject* parent = Q_NULLPTR);
+
+    int rowCount (const QModelIndex& parent = QModelIndex()) const;
+    QVariant data (const QModelIndex& index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    int limit() const;
+    int count() const;
+    int totalCount() const;
+    QString filter() const;
+
+    Q_INVOKABLE QString toPlainText() const;
+    Q_INVOKABLE bool exportToFile (const QString& path) const;
+    Q_INVOKABLE int find (const QString& text, const int from,
+                          const bool backwards = false) const;
+
+public slots:
+    void clear();
+    void append (const QString& message);
+    void setLimit (const int limit);
+    void setFilter (const QString& filter);
+
+signals:
+    void limitChanged();
+    void countChanged();
+    void filterChanged();
+
+private:
+    struct Message {
+        qint64 time;
+        bool richText;
+        QString message;
+        QString plainText;
+    };
+
+    const Message& messageAt (const int row) const;
+    bool matches (const Message& message, const QString& filter) const;
+    void updateRows (const QString& previousFilter);
+
+private:
+    qint64 m_first;
+    QString m_filter;
+    QList<qint64> m_rows;
+    DSRingBuffer<Message> m_messages;
+};
+
+#endif
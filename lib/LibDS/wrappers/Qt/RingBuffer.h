@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _RING_BUFFER_H
+#define _RING_BUFFER_H
+
+#include <QVector>
+
+/**
+ * Fixed-capacity circular buffer, the storage is allocated once (when the
+ * capacity is set) and the oldest item is overwritten when the buffer is
+ * full, so appending never allocates memory.
+ */
+template <typename T>
+class DSRingBuffer
+{
+public:
+    DSRingBuffer (const int capacity = 0)
+    {
+        setCapacity (capacity);
+    }
+
+    /**
+     * Returns the number of items in the buffer
+     */
+    int count() const
+    {
+        return m_count;
+    }
+
+    /**
+     * Returns the maximum number of items that the buffer can hold
+     */
+    int capacity() const
+    {
+        return m_data.count();
+    }
+
+    /**
+     * Returns \c true if the buffer has no items
+     */
+    bool isEmpty() const
+    {
+        return m_count == 0;
+    }
+
+    /**
+     * Returns the number of bytes reserved by the buffer
+     */
+    qint64 memoryUsage() const
+    {
+        return (qint64) capacity() * sizeof (T);
+    }
+
+    /**
+     * Returns the item at the given \a index, where 0 is the oldest item.
+     * A default-constructed item is returned if the \a index is invalid
+     * (e.g. if the buffer has no capacity).
+     */
+    const T& at (const int index) const
+    {
+        if (index < 0 || index >= m_count) {
+            static const T invalid = T();
+            return invalid;
+        }
+
+        return m_data.at ((m_head + index) % capacity());
+    }
+
+    /**
+     * Returns the newest item of the buffer
+     */
+    const T& last() const
+    {
+        return at (m_count - 1);
+    }
+
+    /**
+     * Removes the oldest item of the buffer
+     */
+    void removeFirst()
+    {
+        if (m_count > 0) {
+            m_head = (m_head + 1) % capacity();
+            --m_count;
+        }
+    }
+
+    /**
+     * Removes all the items of the buffer (the storage is kept)
+     */
+    void clear()
+    {
+        m_head = 0;
+        m_count = 0;
+    }
+
+    /**
+     * Changes the \a capacity of the buffer and removes all its items
+     */
+    void setCapacity (const int capacity)
+    {
+        m_data.resize (qMax (capacity, 0));
+        m_data.squeeze();
+        clear();
+    }
+
+    /**
+     * Appends the given \a item, the oldest item is dropped if the buffer
+     * is full
+     */
+    void append (const T& item)
+    {
+        if (capacity() == 0)
+            return;
+
+        if (m_count < capacity()) {
+            m_data [(m_head + m_count) % capacity()] = item;
+            ++m_count;
+        }
+
+        else {
+            m_data [m_head] = item;
+            m_head = (m_head + 1) % capacity();
+        }
+    }
+
+private:
+    int m_head;
+    int m_count;
+    QVector<T> m_data;
+};
+
+#endif
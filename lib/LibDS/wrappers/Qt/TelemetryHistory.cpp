@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TelemetryHistory.h"
+
+/* Length of the buckets of each tier (in msecs) */
+#define SECOND_PERIOD 1000
+#define TEN_PERIOD    10000
+
+/**
+ * Sets the default limits: 2048 full-resolution samples, one hour of
+ * 1-second buckets and twelve hours of 10-second buckets per channel
+ */
+DSTelemetryHistory::DSTelemetryHistory()
+{
+    m_limits.samples = 2048;
+    m_limits.seconds = 3600;
+    m_limits.tens = 4320;
+}
+
+/**
+ * Returns the number of channels of the history
+ */
+int DSTelemetryHistory::channelCount() const
+{
+    return m_channels.count();
+}
+
+/**
+ * Returns the capacity of each tier
+ */
+DSTelemetryHistory::Limits DSTelemetryHistory::limits() const
+{
+    return m_limits;
+}
+
+/**
+ * Returns the number of bytes reserved by the history, this value only
+ * changes when the limits or the channel count are changed
+ */
+qint64 DSTelemetryHistory::memoryUsage() const
+{
+    qint64 usage = 0;
+
+    foreach (const Channel& channel, m_channels) {
+        usage += sizeof (Channel);
+        usage += channel.samples.memoryUsage();
+        usage += channel.seconds.memoryUsage();
+        usage += channel.tens.memoryUsage();
+    }
+
+    return usage;
+}
+
+/**
+ * Returns the full-resolution samples of the given \a channel
+ */
+const DSRingBuffer<DSTelemetryHistory::Sample>& DSTelemetryHistory::samples (
+    const int channel) const
+{
+    return m_channels.at (channel).samples;
+}
+
+/**
+ * Returns the 1-second buckets of the given \a channel
+ */
+const DSRingBuffer<DSTelemetryHistory::Bucket>& DSTelemetryHistory::seconds (
+    const int channel) const
+{
+    return m_channels.at (channel).seconds;
+}
+
+/**
+ * Returns the 10-second buckets of the given \a channel
+ */
+const DSRingBuffer<DSTelemetryHistory::Bucket>& DSTelemetryHistory::tens (
+    const int channel) const
+{
+    return m_channels.at (channel).tens;
+}
+
+/**
+ * Changes the number of channels and clears the history
+ */
+void DSTelemetryHistory::setChannelCount (const int count)
+{
+    m_channels.resize (qMax (count, 0));
+
+    for (int i = 0; i < m_channels.count(); ++i)
+        resetChannel (&m_channels [i]);
+}
+
+/**
+ * Changes the capacity of each tier and clears the history
+ */
+void DSTelemetryHistory::setLimits (const Limits& limits)
+{
+    m_limits = limits;
+    setChannelCount (channelCount());
+}
+
+/**
+ * Registers a new sample of the given \a channel. Once a second (or ten
+ * seconds) bucket is complete, it is moved to the corresponding tier.
+ */
+void DSTelemetryHistory::append (const int channel, const qint64 time,
+                                 const double value)
+{
+    if (channel < 0 || channel >= m_channels.count())
+        return;
+
+    Channel* ch = &m_channels [channel];
+
+    Sample sample;
+    sample.time = time;
+    sample.value = value;
+    ch->samples.append (sample);
+
+    Bucket bucket;
+    bucket.time = time;
+    bucket.min = value;
+    bucket.max = value;
+
+    Bucket second;
+    Bucket ten;
+    if (feed (&ch->secondTier, SECOND_PERIOD, bucket, &second)) {
+        ch->seconds.append (second);
+
+        if (feed (&ch->tenTier, TEN_PERIOD, second, &ten))
+            ch->tens.append (ten);
+    }
+}
+
+/**
+ * Allocates the buffers of the given \a channel with the current limits
+ */
+void DSTelemetryHistory::resetChannel (Channel* channel)
+{
+    channel->samples.setCapacity (m_limits.samples);
+    channel->seconds.setCapacity (m_limits.seconds);
+    channel->tens.setCapacity (m_limits.tens);
+
+    channel->secondTier.open = false;
+    channel->tenTier.open = false;
+}
+
+/**
+ * Merges the given \a bucket into the open bucket of the given \a tier.
+ * If the \a bucket belongs to a newer period, the open bucket is copied to
+ * \a closed and replaced by \a bucket.
+ *
+ * \returns \c true if a bucket was closed
+ */
+bool DSTelemetryHistory::feed (Tier* tier, const qint64 period,
+                               const Bucket& bucket, Bucket* closed)
+{
+    qint64 slot = bucket.time - (bucket.time % period);
+
+    if (tier->open && tier->current.time == slot) {
+        tier->current.min = qMin (tier->current.min, bucket.min);
+        tier->current.max = qMax (tier->current.max, bucket.max);
+        return false;
+    }
+
+    bool wasOpen = tier->open;
+    if (wasOpen)
+        *closed = tier->current;
+
+    tier->open = true;
+    tier->current = bucket;
+    tier->current.time = slot;
+
+    return wasOpen;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TELEMETRY_HISTORY_H
+#define _TELEMETRY_HISTORY_H
+
+#include <QVector>
+#include "RingBuffer.h"
+
+/**
+ * Keeps the recent history of each telemetry channel in memory using a
+ * fixed amount of memory:
+ *
+ * - The newest samples are kept at full resolution
+ * - Older samples are kept as 1-second min/max buckets
+ * - Even older samples are kept as 10-second min/max buckets
+ */
+class DSTelemetryHistory
+{
+public:
+    struct Sample {
+        qint64 time;
+        double value;
+    };
+
+    struct Bucket {
+        qint64 time;
+        double min;
+        double max;
+    };
+
+    struct Limits {
+        int samples;
+        int seconds;
+        int tens;
+    };
+
+    DSTelemetryHistory();
+
+    int channelCount() const;
+    Limits limits() const;
+    qint64 memoryUsage() const;
+
+    const DSRingBuffer<Sample>& samples (const int channel) const;
+    const DSRingBuffer<Bucket>& seconds (const int channel) const;
+    const DSRingBuffer<Bucket>& tens (const int channel) const;
+
+    void setChannelCount (const int count);
+    void setLimits (const Limits& limits);
+    void append (const int channel, const qint64 time, const double value);
+
+private:
+    struct Tier {
+        Bucket current;
+        bool open;
+    };
+
+    struct Channel {
+        DSRingBuffer<Sample> samples;
+        DSRingBuffer<Bucket> seconds;
+        DSRingBuffer<Bucket> tens;
+
+        Tier secondTier;
+        Tier tenTier;
+    };
+
+    void resetChannel (Channel* channel);
+    bool feed (Tier* tier, const qint64 period, const Bucket& bucket,
+               Bucket* closed);
+
+private:
+    Limits m_limits;
+    QVector<Channel> m_channels;
+};
+
+#endif
@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TelemetryLog.h"
+
+#include <string.h>
+
+/* Number of bits available for samples in each block */
+#define PAYLOAD_BITS ((TLM_BLOCK_SIZE - TLM_BLOCK_HEADER) * 8)
+
+/* Worst case: 36 bits for the timestamp and 44 bits for a float value */
+#define MAX_SAMPLE_BITS 80
+
+/**
+ * Writes the given 16-bit \a value to \a dest using little-endian order
+ */
+static void PUT_U16 (quint8* dest, const quint16 value)
+{
+    for (int i = 0; i < 2; ++i)
+        dest [i] = (quint8) (value >> (i * 8));
+}
+
+/**
+ * Writes the given 32-bit \a value to \a dest using little-endian order
+ */
+static void PUT_U32 (quint8* dest, const quint32 value)
+{
+    for (int i = 0; i < 4; ++i)
+        dest [i] = (quint8) (value >> (i * 8));
+}
+
+/**
+ * Writes the given 64-bit \a value to \a dest using little-endian order
+ */
+static void PUT_U64 (quint8* dest, const quint64 value)
+{
+    for (int i = 0; i < 8; ++i)
+        dest [i] = (quint8) (value >> (i * 8));
+}
+
+/**
+ * Writes the given \a value to \a dest as a little-endian IEEE-754 double
+ */
+static void PUT_F64 (quint8* dest, const double value)
+{
+    quint64 bits;
+    memcpy (&bits, &value, sizeof (bits));
+    PUT_U64 (dest, bits);
+}
+
+/**
+ * Returns the number of leading zero bits of the given \a value
+ */
+static int LEADING_ZEROS (quint32 value)
+{
+    int count = 0;
+    while (count < 32 && !(value & 0x80000000)) {
+        value <<= 1;
+        ++count;
+    }
+
+    return count;
+}
+
+/**
+ * Returns the number of trailing zero bits of the given \a value
+ */
+static int TRAILING_ZEROS (quint32 value)
+{
+    int count = 0;
+    while (count < 32 && !(value & 0x01)) {
+        value >>= 1;
+        ++count;
+    }
+
+    return count;
+}
+
+/**
+ * Returns \c true if the given signed \a value can be represented with
+ * the given number of \a bits
+ */
+static bool FITS (const qint64 value, const int bits)
+{
+    const qint64 limit = (qint64) 1 << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+DSTelemetryLog::DSTelemetryLog()
+{
+    m_startTime = 0;
+    m_nextOffset = TLM_BLOCK_SIZE;
+}
+
+/**
+ * Writes any pending samples and releases the channel buffers
+ */
+DSTelemetryLog::~DSTelemetryLog()
+{
+    close();
+    qDeleteAll (m_channels);
+}
+
+/**
+ * Returns \c true if the log file is open and ready to receive samples
+ */
+bool DSTelemetryLog::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+/**
+ * Registers a new channel with the given \a name and \a type and returns
+ * its ID. Channels must be registered before the log file is opened,
+ * -1 is returned if the channel cannot be registered.
+ */
+int DSTelemetryLog::addChannel (const QString& name, const ChannelType type)
+{
+    if (isOpen() || m_channels.count() >= TLM_MAX_CHANNELS)
+        return -1;
+
+    Channel* channel = new Channel;
+    channel->name = name;
+    channel->type = type;
+    channel->block.count = 0;
+    channel->block.dirty = false;
+
+    m_channels.append (channel);
+    return m_channels.count() - 1;
+}
+
+/**
+ * Creates the log file at the given \a path and writes the file header.
+ * The \a startTime is stored in the header to identify the session.
+ */
+bool DSTelemetryLog::open (const QString& path, const qint64 startTime)
+{
+    close();
+
+    m_file.setFileName (path);
+    if (!m_file.open (QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    m_startTime = startTime;
+    m_nextOffset = TLM_BLOCK_SIZE;
+    writeHeader();
+
+    return true;
+}
+
+/**
+ * Writes any pending samples and closes the log file
+ */
+void DSTelemetryLog::close()
+{
+    if (!isOpen())
+        return;
+
+    flush();
+    m_file.close();
+
+    foreach (Channel* channel, m_channels)
+        channel->block.count = 0;
+}
+
+/**
+ * Writes the blocks that have received samples since the last call to the
+ * disk. Partially filled blocks are re-written in place every time, so that
+ * the file is always readable and memory usage does not grow over time.
+ */
+void DSTelemetryLog::flush()
+{
+    if (!isOpen())
+        return;
+
+    for (int i = 0; i < m_channels.count(); ++i) {
+        if (m_channels.at (i)->block.dirty)
+            writeBlock (i);
+    }
+
+    m_file.flush();
+}
+
+/**
+ * Appends the given integer \a value to the given \a channel
+ */
+void DSTelemetryLog::append (const int channel, const qint64 time,
+                             const int value)
+{
+    appendSample (channel, time, (quint32) value, (double) value);
+}
+
+/**
+ * Appends the given float \a value to the given \a channel
+ */
+void DSTelemetryLog::append (const int channel, const qint64 time,
+                             const float value)
+{
+    quint32 bits;
+    memcpy (&bits, &value, sizeof (bits));
+    appendSample (channel, time, bits, (double) value);
+}
+
+/**
+ * Writes the magic string, format version, block size, session start time
+ * and the channel table to the first block of the file
+ */
+void DSTelemetryLog::writeHeader()
+{
+    quint8 header [TLM_BLOCK_SIZE];
+    memset (header, 0, sizeof (header));
+
+    memcpy (header, TLM_MAGIC, strlen (TLM_MAGIC));
+    PUT_U32 (header + 8, TLM_VERSION);
+    PUT_U32 (header + 12, TLM_BLOCK_SIZE);
+    PUT_U64 (header + 16, (quint64) m_startTime);
+    PUT_U32 (header + 24, (quint32) m_channels.count());
+
+    for (int i = 0; i < m_channels.count(); ++i) {
+        quint8* entry = header + TLM_CHANNEL_OFFSET + (i * TLM_CHANNEL_ENTRY);
+        QByteArray name = m_channels.at (i)->name.toUtf8();
+        name.truncate (TLM_CHANNEL_ENTRY - 2);
+
+        entry [0] = (quint8) m_channels.at (i)->type;
+        memcpy (entry + 1, name.constData(), name.length());
+    }
+
+    m_file.seek (0);
+    m_file.write ((const char*) header, sizeof (header));
+}
+
+/**
+ * Updates the header of the block of the given \a channel and writes the
+ * block at its assigned position in the file
+ */
+void DSTelemetryLog::writeBlock (const int channel)
+{
+    Channel* ch = m_channels.at (channel);
+    Block* block = &ch->block;
+
+    PUT_U32 (block->data + 0, TLM_BLOCK_MAGIC);
+    block->data [4] = (quint8) channel;
+    block->data [5] = (quint8) ch->type;
+    PUT_U16 (block->data + 6, block->count);
+    PUT_U32 (block->data + 8, block->bitPos);
+    PUT_U32 (block->data + 12, 0);
+    PUT_U64 (block->data + 16, (quint64) block->firstTime);
+    PUT_U64 (block->data + 24, (quint64) block->lastTime);
+    PUT_F64 (block->data + 32, block->min);
+    PUT_F64 (block->data + 40, block->max);
+    PUT_F64 (block->data + 48, block->sum);
+
+    m_file.seek (block->offset);
+    m_file.write ((const char*) block->data, TLM_BLOCK_SIZE);
+
+    block->dirty = false;
+}
+
+/**
+ * Writes the current block of the given \a channel to the disk, the next
+ * sample of the channel will be written to a new block
+ */
+void DSTelemetryLog::sealBlock (const int channel)
+{
+    Block* block = &m_channels.at (channel)->block;
+
+    if (block->count > 0)
+        writeBlock (channel);
+
+    block->count = 0;
+}
+
+/**
+ * Reserves space in the file for a new block of the given \a channel,
+ * which begins at the given \a time
+ */
+void DSTelemetryLog::startBlock (const int channel, const qint64 time)
+{
+    Block* block = &m_channels.at (channel)->block;
+    memset (block->data, 0, TLM_BLOCK_SIZE);
+
+    block->dirty = true;
+    block->offset = m_nextOffset;
+    block->bitPos = 0;
+    block->count = 0;
+    block->firstTime = time;
+    block->lastTime = time;
+    block->lastDelta = 0;
+    block->lastValue = 0;
+    block->leading = -1;
+    block->trailing = -1;
+
+    m_nextOffset += TLM_BLOCK_SIZE;
+}
+
+/**
+ * Encodes the given sample and appends it to the current block of the
+ * given \a channel. The \a bits parameter contains the raw representation
+ * of the value, while the \a value is used to update the block summary.
+ */
+void DSTelemetryLog::appendSample (const int channel, const qint64 time,
+                                   const quint32 bits, const double value)
+{
+    if (!isOpen() || channel < 0 || channel >= m_channels.count())
+        return;
+
+    Channel* ch = m_channels.at (channel);
+    Block* block = &ch->block;
+
+    /* Check if the sample can be stored in the current block */
+    if (block->count > 0) {
+        qint64 delta = time - block->lastTime;
+        qint64 dod = delta - block->lastDelta;
+        qint64 diff = (qint64) (qint32) bits - (qint32) block->lastValue;
+
+        bool full = block->bitPos + MAX_SAMPLE_BITS > PAYLOAD_BITS;
+        bool large = !FITS (dod, 32) || (ch->type == Integer && !FITS (diff, 32));
+
+        if (full || large || block->count == 0xFFFF)
+            sealBlock (channel);
+    }
+
+    /* First sample of the block, store it as-is */
+    if (block->count == 0) {
+        startBlock (channel, time);
+        writeBits (block, bits, 32);
+
+        block->min = value;
+        block->max = value;
+        block->sum = value;
+    }
+
+    /* Encode timestamp and value */
+    else {
+        qint64 delta = time - block->lastTime;
+        writeSigned (block, delta - block->lastDelta);
+        block->lastDelta = delta;
+
+        if (ch->type == Integer)
+            writeSigned (block, (qint64) (qint32) bits - (qint32) block->lastValue);
+        else
+            writeXor (block, bits);
+
+        block->min = qMin (block->min, value);
+        block->max = qMax (block->max, value);
+        block->sum += value;
+    }
+
+    /* Update block state */
+    ++block->count;
+    block->dirty = true;
+    block->lastTime = time;
+    block->lastValue = bits;
+}
+
+/**
+ * Writes the given number of \a bits of \a value to the block payload,
+ * starting with the most significant bit
+ */
+void DSTelemetryLog::writeBits (Block* block, const quint64 value,
+                                const int bits)
+{
+    quint8* payload = block->data + TLM_BLOCK_HEADER;
+
+    for (int i = bits - 1; i >= 0; --i) {
+        if ((value >> i) & 0x01)
+            payload [block->bitPos / 8] |= (quint8) (0x80 >> (block->bitPos % 8));
+
+        ++block->bitPos;
+    }
+}
+
+/**
+ * Writes a signed \a value using a variable-length prefix code:
+ *
+ * - '0'                    value is zero
+ * - '10'   + 7 bits        value fits in 7 bits
+ * - '110'  + 9 bits        value fits in 9 bits
+ * - '1110' + 12 bits       value fits in 12 bits
+ * - '1111' + 32 bits       everything else
+ */
+void DSTelemetryLog::writeSigned (Block* block, const qint64 value)
+{
+    if (value == 0)
+        writeBits (block, 0x00, 1);
+
+    else if (FITS (value, 7)) {
+        writeBits (block, 0x02, 2);
+        writeBits (block, (quint64) value & 0x7F, 7);
+    }
+
+    else if (FITS (value, 9)) {
+        writeBits (block, 0x06, 3);
+        writeBits (block, (quint64) value & 0x1FF, 9);
+    }
+
+    else if (FITS (value, 12)) {
+        writeBits (block, 0x0E, 4);
+        writeBits (block, (quint64) value & 0xFFF, 12);
+    }
+
+    else {
+        writeBits (block, 0x0F, 4);
+        writeBits (block, (quint64) value & 0xFFFFFFFF, 32);
+    }
+}
+
+/**
+ * XORs the given float \a value with the previous value of the block and
+ * writes the result using the following code:
+ *
+ * - '0'                    value did not change
+ * - '10'  + bits           the meaningful bits fit in the previous window
+ * - '11'  + 5 bits leading zeros + 5 bits length - 1 + bits
+ */
+void DSTelemetryLog::writeXor (Block* block, const quint32 value)
+{
+    quint32 x = value ^ block->lastValue;
+
+    if (x == 0) {
+        writeBits (block, 0x00, 1);
+        return;
+    }
+
+    int leading = qMin (LEADING_ZEROS (x), 31);
+    int trailing = TRAILING_ZEROS (x);
+
+    if (block->leading >= 0
+            && leading >= block->leading
+            && trailing >= block->trailing) {
+        int length = 32 - block->leading - block->trailing;
+        writeBits (block, 0x02, 2);
+        writeBits (block, x >> block->trailing, length);
+    }
+
+    else {
+        int length = 32 - leading - trailing;
+        writeBits (block, 0x03, 2);
+        writeBits (block, leading, 5);
+        writeBits (block, length - 1, 5);
+        writeBits (block, x >> trailing, length);
+
+        block->leading = leading;
+        block->trailing = trailing;
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TELEMETRY_LOG_H
+#define _TELEMETRY_LOG_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+
+/*
+ * File layout (all integers are little-endian):
+ *
+ * - The first block of the file is the file header, which contains the
+ *   magic string, the format version, the block size, the session start
+ *   time and the name & type of each channel.
+ *
+ * - Every other block holds the samples of a single channel. The block
+ *   header contains the channel ID, the sample count, the time range and
+ *   the min/max/sum of the values of the block, followed by a bit stream
+ *   with the samples themselves.
+ *
+ * - The first sample of each block is stored as-is, the timestamps of the
+ *   following samples are stored as delta-of-deltas and their values are
+ *   stored as deltas (integer channels) or XOR'ed with the previous value
+ *   (float channels).
+ */
+#define TLM_MAGIC            "QDSTLM"
+#define TLM_VERSION          2
+#define TLM_BLOCK_SIZE       4096
+#define TLM_BLOCK_MAGIC      0x4B4C4254
+#define TLM_BLOCK_HEADER     56
+#define TLM_MAX_CHANNELS     64
+#define TLM_CHANNEL_ENTRY    32
+#define TLM_CHANNEL_OFFSET   32
+
+class DSTelemetryLog
+{
+public:
+    enum ChannelType {
+        Integer = 0x00,
+        Float = 0x01,
+    };
+
+    DSTelemetryLog();
+    ~DSTelemetryLog();
+
+    bool isOpen() const;
+
+    int addChannel (const QString& name, const ChannelType type);
+
+    bool open (const QString& path, const qint64 startTime);
+    void close();
+    void flush();
+
+    void append (const int channel, const qint64 time, const int value);
+    void append (const int channel, const qint64 time, const float value);
+
+private:
+    struct Block {
+        quint8 data[TLM_BLOCK_SIZE];
+
+        bool dirty;
+        qint64 offset;
+        quint32 bitPos;
+        quint16 count;
+
+        qint64 firstTime;
+        qint64 lastTime;
+        qint64 lastDelta;
+        quint32 lastValue;
+
+        int leading;
+        int trailing;
+
+        double min;
+        double max;
+        double sum;
+    };
+
+    struct Channel {
+        QString name;
+        ChannelType type;
+        Block block;
+    };
+
+    void writeHeader();
+    void writeBlock (const int channel);
+    void sealBlock (const int channel);
+    void startBlock (const int channel, const qint64 time);
+    void appendSample (const int channel, const qint64 time,
+                       const quint32 bits, const double value);
+
+    void writeBits (Block* block, const quint64 value, const int bits);
+    void writeSigned (Block* block, const qint64 value);
+    void writeXor (Block* block, const quint32 value);
+
+private:
+    QFile m_file;
+    qint64 m_startTime;
+    qint64 m_nextOffset;
+    QList<Channel*> m_channels;
+};
+
+#endif
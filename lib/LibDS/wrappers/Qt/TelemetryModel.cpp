@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TelemetryModel.h"
+#include "EventLogger.h"
+
+#include <QFileInfo>
+#include <QDirIterator>
+
+/**
+ * Initializes the model with the telemetry log of the current session
+ */
+DSTelemetryModel::DSTelemetryModel (QObject* parent) :
+    QAbstractListModel (parent)
+{
+    m_channel = -1;
+    m_buckets = 120;
+    m_windowStart = 0;
+    m_windowLength = 60 * 1000;
+    m_channelName = "Voltage";
+
+    m_summary.count = 0;
+    m_summary.min = 0;
+    m_summary.max = 0;
+    m_summary.avg = 0;
+
+    refresh();
+}
+
+/**
+ * Returns the number of buckets of the current window
+ */
+int DSTelemetryModel::rowCount (const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    return m_data.count();
+}
+
+/**
+ * Returns the time or the summary of the bucket at the given \a index
+ */
+QVariant DSTelemetryModel::data (const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_data.count())
+        return QVariant();
+
+    const DSTelemetryReader::Aggregate& bucket = m_data.at (index.row());
+
+    switch (role) {
+    case TimeRole:
+        return m_windowStart + (index.row() * m_windowLength / m_buckets);
+    case CountRole:
+        return bucket.count;
+    case MinimumRole:
+        return bucket.min;
+    case MaximumRole:
+        return bucket.max;
+    case AverageRole:
+        return bucket.avg;
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * Returns the names of the roles used by the QML delegates
+ */
+QHash<int, QByteArray> DSTelemetryModel::roleNames() const
+{
+    QHash<int, QByteArray> names;
+    names.insert (TimeRole,    "time");
+    names.insert (CountRole,   "count");
+    names.insert (MinimumRole, "minimum");
+    names.insert (MaximumRole, "maximum");
+    names.insert (AverageRole, "average");
+    return names;
+}
+
+/**
+ * Returns the telemetry logs found in the logs directory (newest first)
+ */
+QStringList DSTelemetryModel::logFiles() const
+{
+    return m_logFiles;
+}
+
+/**
+ * Returns the path of the telemetry log being displayed
+ */
+QString DSTelemetryModel::source() const
+{
+    return m_reader.fileName();
+}
+
+/**
+ * Returns the channels of the current telemetry log
+ */
+QStringList DSTelemetryModel::channels() const
+{
+    return m_reader.channels();
+}
+
+/**
+ * Returns the name of the selected channel
+ */
+QString DSTelemetryModel::channel() const
+{
+    return m_channelName;
+}
+
+/**
+ * Returns the time of the first sample of the log (msecs since epoch)
+ */
+qreal DSTelemetryModel::firstTime() const
+{
+    return m_reader.firstTime();
+}
+
+/**
+ * Returns the time of the last sample of the log (msecs since epoch)
+ */
+qreal DSTelemetryModel::lastTime() const
+{
+    return m_reader.lastTime();
+}
+
+/**
+ * Returns the beginning of the displayed window of time
+ */
+qreal DSTelemetryModel::windowStart() const
+{
+    return m_windowStart;
+}
+
+/**
+ * Returns the length of the displayed window of time (in msecs)
+ */
+qreal DSTelemetryModel::windowLength() const
+{
+    return m_windowLength;
+}
+
+/**
+ * Returns the number of buckets in which the window is divided
+ */
+int DSTelemetryModel::buckets() const
+{
+    return m_buckets;
+}
+
+/**
+ * Returns the minimum value of the channel during the displayed window
+ */
+qreal DSTelemetryModel::minimum() const
+{
+    return m_summary.min;
+}
+
+/**
+ * Returns the maximum value of the channel during the displayed window
+ */
+qreal DSTelemetryModel::maximum() const
+{
+    return m_summary.max;
+}
+
+/**
+ * Returns the average value of the channel during the displayed window
+ */
+qreal DSTelemetryModel::average() const
+{
+    return m_summary.avg;
+}
+
+/**
+ * Returns the value that the selected channel had at the given \a time
+ */
+qreal DSTelemetryModel::valueAt (const qreal time) const
+{
+    DSTelemetryReader::Sample sample;
+    if (m_reader.valueAt (m_channel, (qint64) time, &sample))
+        return sample.value;
+
+    return 0;
+}
+
+/**
+ * Re-scans the logs directory and re-maps the current log, so that the
+ * samples written since the last call become visible
+ */
+void DSTelemetryModel::refresh()
+{
+    QStringList files;
+    QDirIterator it (DSEventLogger::getInstance()->logsPath(),
+                     QStringList() << "*.tlm",
+                     QDir::Files,
+                     QDirIterator::Subdirectories);
+
+    QList<QPair<qint64, QString>> found;
+    while (it.hasNext()) {
+        QString path = it.next();
+        found.append (qMakePair (-QFileInfo (path).lastModified().toMSecsSinceEpoch(),
+                                 path));
+    }
+
+    qSort (found);
+    for (int i = 0; i < found.count(); ++i)
+        files.append (found.at (i).second);
+
+    if (m_logFiles != files) {
+        m_logFiles = files;
+        emit logFilesChanged();
+    }
+
+    if (!m_reader.isOpen())
+        setSource (DSEventLogger::getInstance()->currentTelemetryLog());
+
+    else {
+        m_reader.reload();
+        m_channel = m_reader.channelIndex (m_channelName);
+
+        emit rangeChanged();
+        updateBuckets();
+    }
+}
+
+/**
+ * Opens the telemetry log at the given \a source path
+ */
+void DSTelemetryModel::setSource (const QString& source)
+{
+    if (source.isEmpty())
+        return;
+
+    m_reader.open (source);
+    m_channel = m_reader.channelIndex (m_channelName);
+    m_windowStart = qMax (firstTime(), lastTime() - m_windowLength);
+
+    emit sourceChanged();
+    emit rangeChanged();
+    updateBuckets();
+}
+
+/**
+ * Changes the channel displayed by the model
+ */
+void DSTelemetryModel::setChannel (const QString& channel)
+{
+    if (m_channelName != channel) {
+        m_channelName = channel;
+        m_channel = m_reader.channelIndex (channel);
+
+        emit channelChanged();
+        updateBuckets();
+    }
+}
+
+/**
+ * Moves the displayed window of time to the given \a start time
+ */
+void DSTelemetryModel::setWindowStart (const qreal start)
+{
+    if (m_windowStart != start) {
+        m_windowStart = start;
+        updateBuckets();
+    }
+}
+
+/**
+ * Changes the length (in msecs) of the displayed window of time
+ */
+void DSTelemetryModel::setWindowLength (const qreal length)
+{
+    if (m_windowLength != length && length > 0) {
+        m_windowLength = length;
+        updateBuckets();
+    }
+}
+
+/**
+ * Changes the number of \a buckets in which the window is divided
+ */
+void DSTelemetryModel::setBuckets (const int buckets)
+{
+    if (m_buckets != buckets && buckets > 0) {
+        m_buckets = buckets;
+        updateBuckets();
+    }
+}
+
+/**
+ * Re-calculates the summary of each bucket of the displayed window, only
+ * the blocks at the edges of each bucket need to be decoded
+ */
+void DSTelemetryModel::updateBuckets()
+{
+    beginResetModel();
+
+    m_data.clear();
+    qreal step = m_windowLength / m_buckets;
+    qint64 end = (qint64) (m_windowStart + m_windowLength);
+
+    if (m_channel >= 0) {
+        for (int i = 0; i < m_buckets; ++i) {
+            qint64 from = (qint64) (m_windowStart + (i * step));
+            qint64 to = (qint64) (m_windowStart + ((i + 1) * step)) - 1;
+            m_data.append (m_reader.aggregate (m_channel, from, to));
+        }
+    }
+
+    m_summary = m_reader.aggregate (m_channel, (qint64) m_windowStart, end);
+
+    endResetModel();
+    emit windowChanged();
+}
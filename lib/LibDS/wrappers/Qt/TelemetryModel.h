@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TELEMETRY_MODEL_H
+#define _TELEMETRY_MODEL_H
+
+#include <QStringList>
+#include <QAbstractListModel>
+
+#include "TelemetryReader.h"
+
+/**
+ * Exposes the telemetry logs to QML. Each row of the model is a bucket of
+ * the selected window of time, which contains the min/max/avg values of
+ * the selected channel during that bucket.
+ */
+class DSTelemetryModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY (QStringList logFiles
+                READ logFiles
+                NOTIFY logFilesChanged)
+    Q_PROPERTY (QString source
+                READ source
+                WRITE setSource
+                NOTIFY sourceChanged)
+    Q_PROPERTY (QStringList channels
+                READ channels
+                NOTIFY sourceChanged)
+    Q_PROPERTY (QString channel
+                READ channel
+                WRITE setChannel
+                NOTIFY channelChanged)
+    Q_PROPERTY (qreal firstTime
+                READ firstTime
+                NOTIFY rangeChanged)
+    Q_PROPERTY (qreal lastTime
+                READ lastTime
+                NOTIFY rangeChanged)
+    Q_PROPERTY (qreal windowStart
+                READ windowStart
+                WRITE setWindowStart
+                NOTIFY windowChanged)
+    Q_PROPERTY (qreal windowLength
+                READ windowLength
+                WRITE setWindowLength
+                NOTIFY windowChanged)
+    Q_PROPERTY (int buckets
+                READ buckets
+                WRITE setBuckets
+                NOTIFY windowChanged)
+    Q_PROPERTY (qreal minimum
+                READ minimum
+                NOTIFY windowChanged)
+    Q_PROPERTY (qreal maximum
+                READ maximum
+                NOTIFY windowChanged)
+    Q_PROPERTY (qreal average
+                READ average
+                NOTIFY windowChanged)
+
+public:
+    enum Roles {
+        TimeRole = Qt::UserRole + 1,
+        CountRole,
+        MinimumRole,
+        MaximumRole,
+        AverageRole,
+    };
+
+    DSTelemetryModel (QObject* parent = Q_NULLPTR);
+
+    int rowCount (const QModelIndex& parent = QModelIndex()) const;
+    QVariant data (const QModelIndex& index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    QStringList logFiles() const;
+    QString source() const;
+    QStringList channels() const;
+    QString channel() const;
+
+    qreal firstTime() const;
+    qreal lastTime() const;
+    qreal windowStart() const;
+    qreal windowLength() const;
+    int buckets() const;
+
+    qreal minimum() const;
+    qreal maximum() const;
+    qreal average() const;
+
+    Q_INVOKABLE qreal valueAt (const qreal time) const;
+
+public slots:
+    void refresh();
+    void setSource (const QString& source);
+    void setChannel (const QString& channel);
+    void setWindowStart (const qreal start);
+    void setWindowLength (const qreal length);
+    void setBuckets (const int buckets);
+
+signals:
+    void logFilesChanged();
+    void sourceChanged();
+    void channelChanged();
+    void rangeChanged();
+    void windowChanged();
+
+private:
+    void updateBuckets();
+
+private:
+    int m_channel;
+    int m_buckets;
+    qreal m_windowStart;
+    qreal m_windowLength;
+
+    QString m_channelName;
+    QStringList m_logFiles;
+
+    DSTelemetryReader m_reader;
+    DSTelemetryReader::Aggregate m_summary;
+    QVector<DSTelemetryReader::Aggregate> m_data;
+};
+
+#endif
@@ -0,0 +1,564 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "TelemetryReader.h"
+
+#include <string.h>
+
+/* Number of bits available for samples in each block */
+#define PAYLOAD_BITS ((TLM_BLOCK_SIZE - TLM_BLOCK_HEADER) * 8)
+
+/**
+ * Reads a little-endian 16-bit integer from \a src
+ */
+static quint16 GET_U16 (const quint8* src)
+{
+    return (quint16) (src [0] | (src [1] << 8));
+}
+
+/**
+ * Reads a little-endian 32-bit integer from \a src
+ */
+static quint32 GET_U32 (const quint8* src)
+{
+    quint32 value = 0;
+    for (int i = 3; i >= 0; --i)
+        value = (value << 8) | src [i];
+
+    return value;
+}
+
+/**
+ * Reads a little-endian 64-bit integer from \a src
+ */
+static quint64 GET_U64 (const quint8* src)
+{
+    quint64 value = 0;
+    for (int i = 7; i >= 0; --i)
+        value = (value << 8) | src [i];
+
+    return value;
+}
+
+/**
+ * Reads a little-endian IEEE-754 double from \a src
+ */
+static double GET_F64 (const quint8* src)
+{
+    double value;
+    quint64 bits = GET_U64 (src);
+    memcpy (&value, &bits, sizeof (value));
+    return value;
+}
+
+/**
+ * Sign-extends the lower \a bits of the given \a value
+ */
+static qint64 SIGN_EXTEND (const quint64 value, const int bits)
+{
+    const quint64 sign = (quint64) 1 << (bits - 1);
+    return (qint64) ((value ^ sign) - sign);
+}
+
+/**
+ * Reads bits from the payload of a block, starting with the most
+ * significant bit (mirrors the writer of \c DSTelemetryLog)
+ */
+struct BitReader {
+    const quint8* data;
+    quint32 pos;
+    quint32 size;
+
+    quint64 read (const int bits)
+    {
+        quint64 value = 0;
+
+        for (int i = 0; i < bits && pos < size; ++i, ++pos)
+            value = (value << 1) | ((data [pos / 8] >> (7 - (pos % 8))) & 0x01);
+
+        return value;
+    }
+
+    qint64 readSigned()
+    {
+        if (read (1) == 0)
+            return 0;
+        if (read (1) == 0)
+            return SIGN_EXTEND (read (7), 7);
+        if (read (1) == 0)
+            return SIGN_EXTEND (read (9), 9);
+        if (read (1) == 0)
+            return SIGN_EXTEND (read (12), 12);
+
+        return SIGN_EXTEND (read (32), 32);
+    }
+};
+
+DSTelemetryReader::DSTelemetryReader()
+{
+    m_data = NULL;
+    m_size = 0;
+    m_startTime = 0;
+}
+
+/**
+ * Unmaps the log file
+ */
+DSTelemetryReader::~DSTelemetryReader()
+{
+    close();
+}
+
+/**
+ * Returns \c true if a valid telemetry log is currently mapped
+ */
+bool DSTelemetryReader::isOpen() const
+{
+    return m_data != NULL;
+}
+
+/**
+ * Returns the path of the current telemetry log
+ */
+QString DSTelemetryReader::fileName() const
+{
+    return m_file.fileName();
+}
+
+/**
+ * Maps the telemetry log at the given \a path into memory and builds the
+ * block index of each channel. Only the block headers are read here, the
+ * samples are decoded on demand.
+ */
+bool DSTelemetryReader::open (const QString& path)
+{
+    close();
+    m_file.setFileName (path);
+
+    if (!m_file.open (QFile::ReadOnly))
+        return false;
+
+    return reload();
+}
+
+/**
+ * Re-maps the current file, used to pick up the blocks written since the
+ * file was opened (e.g. while the current session is still being logged)
+ */
+bool DSTelemetryReader::reload()
+{
+    if (!m_file.isOpen())
+        return false;
+
+    if (m_data)
+        m_file.unmap (m_data);
+
+    m_channels.clear();
+    m_size = m_file.size();
+    m_data = m_size >= TLM_BLOCK_SIZE ? m_file.map (0, m_size) : NULL;
+
+    if (m_data && buildIndex())
+        return true;
+
+    if (m_data)
+        m_file.unmap (m_data);
+
+    m_data = NULL;
+    m_channels.clear();
+    return false;
+}
+
+/**
+ * Unmaps and closes the current file
+ */
+void DSTelemetryReader::close()
+{
+    if (m_data)
+        m_file.unmap (m_data);
+
+    if (m_file.isOpen())
+        m_file.close();
+
+    m_data = NULL;
+    m_size = 0;
+    m_startTime = 0;
+    m_channels.clear();
+}
+
+/**
+ * Returns the time (in msecs since epoch) in which the log was created
+ */
+qint64 DSTelemetryReader::startTime() const
+{
+    return m_startTime;
+}
+
+/**
+ * Returns the time of the oldest sample of the log
+ */
+qint64 DSTelemetryReader::firstTime() const
+{
+    qint64 time = 0;
+    bool found = false;
+
+    foreach (const Channel& channel, m_channels) {
+        if (!channel.blocks.isEmpty()) {
+            qint64 first = channel.blocks.first().firstTime;
+            time = found ? qMin (time, first) : first;
+            found = true;
+        }
+    }
+
+    return found ? time : m_startTime;
+}
+
+/**
+ * Returns the time of the newest sample of the log
+ */
+qint64 DSTelemetryReader::lastTime() const
+{
+    qint64 time = m_startTime;
+
+    foreach (const Channel& channel, m_channels) {
+        foreach (const BlockInfo& block, channel.blocks)
+            time = qMax (time, block.lastTime);
+    }
+
+    return time;
+}
+
+/**
+ * Returns the number of channels of the log
+ */
+int DSTelemetryReader::channelCount() const
+{
+    return m_channels.count();
+}
+
+/**
+ * Returns the names of the channels of the log
+ */
+QStringList DSTelemetryReader::channels() const
+{
+    QStringList list;
+    foreach (const Channel& channel, m_channels)
+        list.append (channel.name);
+
+    return list;
+}
+
+/**
+ * Returns the ID of the channel with the given \a name, or -1 if the log
+ * does not contain such channel
+ */
+int DSTelemetryReader::channelIndex (const QString& name) const
+{
+    for (int i = 0; i < m_channels.count(); ++i) {
+        if (m_channels.at (i).name == name)
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+ * Returns the name of the given \a channel
+ */
+QString DSTelemetryReader::channelName (const int channel) const
+{
+    if (channel >= 0 && channel < m_channels.count())
+        return m_channels.at (channel).name;
+
+    return "";
+}
+
+/**
+ * Returns the data type of the given \a channel
+ */
+DSTelemetryLog::ChannelType DSTelemetryReader::channelType (const int channel)
+const
+{
+    if (channel >= 0 && channel < m_channels.count())
+        return m_channels.at (channel).type;
+
+    return DSTelemetryLog::Integer;
+}
+
+/**
+ * Obtains the value that the given \a channel had at the given \a time
+ * (that is, the last sample registered before or at \a time). Only the
+ * block that contains the sample is decoded.
+ *
+ * \returns \c false if there are no samples before the given \a time
+ */
+bool DSTelemetryReader::valueAt (const int channel, const qint64 time,
+                                 Sample* sample) const
+{
+    int index = findBlock (channel, time);
+    if (index < 0 || !sample)
+        return false;
+
+    QVector<Sample> list = decode (channel, m_channels.at (channel).blocks.at (
+                                       index));
+
+    for (int i = list.count() - 1; i >= 0; --i) {
+        if (list.at (i).time <= time) {
+            *sample = list.at (i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Returns the samples of the given \a channel between \a from and \a to,
+ * only the blocks that overlap with the given time range are decoded
+ */
+QVector<DSTelemetryReader::Sample> DSTelemetryReader::samples (
+    const int channel, const qint64 from, const qint64 to) const
+{
+    QVector<Sample> list;
+    if (channel < 0 || channel >= m_channels.count())
+        return list;
+
+    const QVector<BlockInfo>& blocks = m_channels.at (channel).blocks;
+    for (int i = qMax (findBlock (channel, from), 0); i < blocks.count(); ++i) {
+        const BlockInfo& block = blocks.at (i);
+
+        if (block.firstTime > to)
+            break;
+        if (block.lastTime < from)
+            continue;
+
+        foreach (const Sample& sample, decode (channel, block)) {
+            if (sample.time >= from && sample.time <= to)
+                list.append (sample);
+        }
+    }
+
+    return list;
+}
+
+/**
+ * Calculates the min/max/avg values of the given \a channel between \a from
+ * and \a to. The summary stored in the header is used for the blocks that
+ * lie completely inside of the time range, so only the blocks at the edges
+ * of the time range need to be decoded.
+ */
+DSTelemetryReader::Aggregate DSTelemetryReader::aggregate (
+    const int channel, const qint64 from, const qint64 to) const
+{
+    double sum = 0;
+    Aggregate result;
+    result.count = 0;
+    result.min = 0;
+    result.max = 0;
+    result.avg = 0;
+
+    if (channel < 0 || channel >= m_channels.count())
+        return result;
+
+    const QVector<BlockInfo>& blocks = m_channels.at (channel).blocks;
+    for (int i = qMax (findBlock (channel, from), 0); i < blocks.count(); ++i) {
+        const BlockInfo& block = blocks.at (i);
+
+        if (block.firstTime > to)
+            break;
+        if (block.lastTime < from)
+            continue;
+
+        /* Block is inside the time range, use the block summary */
+        if (block.firstTime >= from && block.lastTime <= to) {
+            result.min = result.count ? qMin (result.min, block.min) : block.min;
+            result.max = result.count ? qMax (result.max, block.max) : block.max;
+            result.count += block.count;
+            sum += block.sum;
+            continue;
+        }
+
+        /* Block is in the edge of the time range, decode it */
+        foreach (const Sample& sample, decode (channel, block)) {
+            if (sample.time < from || sample.time > to)
+                continue;
+
+            result.min = result.count ? qMin (result.min, sample.value) : sample.value;
+            result.max = result.count ? qMax (result.max, sample.value) : sample.value;
+            result.count += 1;
+            sum += sample.value;
+        }
+    }
+
+    if (result.count > 0)
+        result.avg = sum / result.count;
+
+    return result;
+}
+
+/**
+ * Reads the file header and the headers of every block in the file to
+ * build the sparse time index of each channel
+ */
+bool DSTelemetryReader::buildIndex()
+{
+    const quint8* header = m_data;
+
+    /* Validate file header */
+    if (memcmp (header, TLM_MAGIC, strlen (TLM_MAGIC)) != 0)
+        return false;
+    if (GET_U32 (header + 8) != TLM_VERSION)
+        return false;
+    if (GET_U32 (header + 12) != TLM_BLOCK_SIZE)
+        return false;
+
+    /* Get channel count */
+    quint32 count = GET_U32 (header + 24);
+    if (count > TLM_MAX_CHANNELS)
+        return false;
+
+    /* Read channel table */
+    m_startTime = (qint64) GET_U64 (header + 16);
+    for (quint32 i = 0; i < count; ++i) {
+        const quint8* entry = header + TLM_CHANNEL_OFFSET + (i * TLM_CHANNEL_ENTRY);
+
+        Channel channel;
+        channel.type = (DSTelemetryLog::ChannelType) entry [0];
+        channel.name = QString::fromUtf8 ((const char*) entry + 1,
+                                          strnlen ((const char*) entry + 1,
+                                                   TLM_CHANNEL_ENTRY - 1));
+        m_channels.append (channel);
+    }
+
+    /* Index data blocks (blocks that have not been written yet are skipped) */
+    for (qint64 offset = TLM_BLOCK_SIZE; offset + TLM_BLOCK_SIZE <= m_size;
+            offset += TLM_BLOCK_SIZE) {
+        const quint8* data = m_data + offset;
+
+        if (GET_U32 (data) != TLM_BLOCK_MAGIC || data [4] >= count)
+            continue;
+
+        BlockInfo block;
+        block.data = data;
+        block.count = GET_U16 (data + 6);
+        block.bits = GET_U32 (data + 8);
+        block.firstTime = (qint64) GET_U64 (data + 16);
+        block.lastTime = (qint64) GET_U64 (data + 24);
+        block.min = GET_F64 (data + 32);
+        block.max = GET_F64 (data + 40);
+        block.sum = GET_F64 (data + 48);
+
+        if (block.count > 0 && block.bits <= PAYLOAD_BITS)
+            m_channels [data [4]].blocks.append (block);
+    }
+
+    return true;
+}
+
+/**
+ * Returns the index of the last block of the given \a channel that begins
+ * before or at the given \a time, or -1 if there is no such block
+ */
+int DSTelemetryReader::findBlock (const int channel, const qint64 time) const
+{
+    if (channel < 0 || channel >= m_channels.count())
+        return -1;
+
+    const QVector<BlockInfo>& blocks = m_channels.at (channel).blocks;
+
+    int low = 0;
+    int high = blocks.count() - 1;
+    int result = -1;
+
+    while (low <= high) {
+        int mid = (low + high) / 2;
+
+        if (blocks.at (mid).firstTime <= time) {
+            result = mid;
+            low = mid + 1;
+        }
+
+        else
+            high = mid - 1;
+    }
+
+    return result;
+}
+
+/**
+ * Decodes the samples of the given \a block
+ */
+QVector<DSTelemetryReader::Sample> DSTelemetryReader::decode (
+    const int channel, const BlockInfo& block) const
+{
+    QVector<Sample> list;
+    list.reserve (block.count);
+
+    BitReader reader;
+    reader.data = block.data + TLM_BLOCK_HEADER;
+    reader.size = block.bits;
+    reader.pos = 0;
+
+    bool isFloat = m_channels.at (channel).type == DSTelemetryLog::Float;
+
+    int leading = 0;
+    int trailing = 0;
+    qint64 delta = 0;
+    qint64 time = block.firstTime;
+    quint32 bits = (quint32) reader.read (32);
+
+    for (int i = 0; i < block.count; ++i) {
+        /* Decode timestamp and value (first sample is stored as-is) */
+        if (i > 0) {
+            delta += reader.readSigned();
+            time += delta;
+
+            if (!isFloat)
+                bits = (quint32) ((qint64) (qint32) bits + reader.readSigned());
+
+            else if (reader.read (1)) {
+                if (reader.read (1)) {
+                    leading = (int) reader.read (5);
+                    trailing = 32 - leading - ((int) reader.read (5) + 1);
+                }
+
+                bits ^= (quint32) reader.read (32 - leading - trailing) << trailing;
+            }
+        }
+
+        /* Convert raw bits to value */
+        Sample sample;
+        sample.time = time;
+
+        if (isFloat) {
+            float value;
+            memcpy (&value, &bits, sizeof (value));
+            sample.value = value;
+        }
+
+        else
+            sample.value = (qint32) bits;
+
+        list.append (sample);
+    }
+
+    return list;
+}
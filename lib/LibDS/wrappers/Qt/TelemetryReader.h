@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TELEMETRY_READER_H
+#define _TELEMETRY_READER_H
+
+#include <QFile>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+#include "TelemetryLog.h"
+
+class DSTelemetryReader
+{
+public:
+    struct Sample {
+        qint64 time;
+        double value;
+    };
+
+    struct Aggregate {
+        qint64 count;
+        double min;
+        double max;
+        double avg;
+    };
+
+    DSTelemetryReader();
+    ~DSTelemetryReader();
+
+    bool isOpen() const;
+    QString fileName() const;
+
+    bool open (const QString& path);
+    bool reload();
+    void close();
+
+    qint64 startTime() const;
+    qint64 firstTime() const;
+    qint64 lastTime() const;
+
+    int channelCount() const;
+    QStringList channels() const;
+    int channelIndex (const QString& name) const;
+    QString channelName (const int channel) const;
+    DSTelemetryLog::ChannelType channelType (const int channel) const;
+
+    bool valueAt (const int channel, const qint64 time, Sample* sample) const;
+    QVector<Sample> samples (const int channel,
+                             const qint64 from,
+                             const qint64 to) const;
+    Aggregate aggregate (const int channel,
+                         const qint64 from,
+                         const qint64 to) const;
+
+private:
+    struct BlockInfo {
+        const quint8* data;
+        quint16 count;
+        quint32 bits;
+        qint64 firstTime;
+        qint64 lastTime;
+        double min;
+        double max;
+        double sum;
+    };
+
+    struct Channel {
+        QString name;
+        DSTelemetryLog::ChannelType type;
+        QVector<BlockInfo> blocks;
+    };
+
+    bool buildIndex();
+    int findBlock (const int channel, const qint64 time) const;
+    QVector<Sample> decode (const int channel, const BlockInfo& block) const;
+
+private:
+    QFile m_file;
+    uchar* m_data;
+    qint64 m_size;
+    qint64 m_startTime;
+    QVector<Channel> m_channels;
+};
+
+#endif
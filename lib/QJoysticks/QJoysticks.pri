@@ -29,13 +29,16 @@ INCLUDEPATH += $$PWD/src
 
 HEADERS += \
     $$PWD/src/QJoysticks.h \
+    $$PWD/src/QJoysticks/AxisConditioner.h \
     $$PWD/src/QJoysticks/JoysticksCommon.h \
+    $$PWD/src/QJoysticks/JoysticksQueue.h \
     $$PWD/src/QJoysticks/SDL_Joysticks.h \
     $$PWD/src/QJoysticks/VirtualJoystick.h \
     $$PWD/src/QJoysticks/Android_Joystick.h
 
 SOURCES += \
     $$PWD/src/QJoysticks.cpp \
+    $$PWD/src/QJoysticks/AxisConditioner.cpp \
     $$PWD/src/QJoysticks/SDL_Joysticks.cpp \
     $$PWD/src/QJoysticks/VirtualJoystick.cpp \
     $$PWD/src/QJoysticks/Android_Joystick.cpp
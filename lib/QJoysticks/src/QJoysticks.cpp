@@ -21,8 +21,11 @@
  */
 
 #include <QDebug>
+#include <QTimer>
 #include <QSettings>
+#include <QMutexLocker>
 #include <QJoysticks.h>
+#include <QJoysticks/AxisConditioner.h>
 #include <QJoysticks/SDL_Joysticks.h>
 #include <QJoysticks/VirtualJoystick.h>
 
@@ -32,27 +35,37 @@ QJoysticks::QJoysticks()
     m_sdlJoysticks = new SDL_Joysticks (this);
     m_virtualJoystick = new VirtualJoystick (this);
 
-    /* Configure SDL joysticks */
+    /* Register the event types for queued connections */
+    qRegisterMetaType<QJoystickPOVEvent> ("QJoystickPOVEvent");
+    qRegisterMetaType<QJoystickAxisEvent> ("QJoystickAxisEvent");
+    qRegisterMetaType<QJoystickButtonEvent> ("QJoystickButtonEvent");
+
+    /* Configure SDL joysticks (input events come from the dispatch thread) */
     connect (sdlJoysticks(),    &SDL_Joysticks::POVEvent,
-             this,              &QJoysticks::POVEvent);
+             this,              &QJoysticks::POVEvent,
+             Qt::DirectConnection);
     connect (sdlJoysticks(),    &SDL_Joysticks::axisEvent,
-             this,              &QJoysticks::axisEvent);
+             this,              &QJoysticks::conditionAxisEvent,
+             Qt::DirectConnection);
     connect (sdlJoysticks(),    &SDL_Joysticks::buttonEvent,
-             this,              &QJoysticks::buttonEvent);
-    connect (sdlJoysticks(),    &SDL_Joysticks::countChanged,
-             this,              &QJoysticks::updateInterfaces);
+             this,              &QJoysticks::buttonEvent,
+             Qt::DirectConnection);
+    connect (sdlJoysticks(),    &SDL_Joysticks::joystickAdded,
+             this,              &QJoysticks::onDeviceAdded);
+    connect (sdlJoysticks(),    &SDL_Joysticks::joystickRemoved,
+             this,              &QJoysticks::onDeviceRemoved);
 
     /* Configure virtual joysticks */
     connect (virtualJoystick(), &VirtualJoystick::povEvent,
              this,              &QJoysticks::POVEvent);
     connect (virtualJoystick(), &VirtualJoystick::axisEvent,
-             this,              &QJoysticks::axisEvent);
+             this,              &QJoysticks::conditionAxisEvent);
     connect (virtualJoystick(), &VirtualJoystick::buttonEvent,
              this,              &QJoysticks::buttonEvent);
     connect (virtualJoystick(), &VirtualJoystick::enabledChanged,
              this,              &QJoysticks::updateInterfaces);
 
-    /* React to own signals to create QML signals */
+    /* React to own signals to create QML signals (queued for SDL events) */
     connect (this, &QJoysticks::POVEvent,
              this, &QJoysticks::onPOVEvent);
     connect (this, &QJoysticks::axisEvent,
@@ -60,17 +73,28 @@ QJoysticks::QJoysticks()
     connect (this, &QJoysticks::buttonEvent,
              this, &QJoysticks::onButtonEvent);
 
+    /* Configure the axis conditioning */
+    m_conditioner = new AxisConditioner;
+    m_settleTimer = new QTimer (this);
+    m_settleTimer->setInterval (10);
+    connect (m_settleTimer, &QTimer::timeout, this, &QJoysticks::settleAxes);
+
     /* Configure the settings */
     m_sortJoyticks = 0;
     m_settings = new QSettings (qApp->organizationName(), qApp->applicationName());
     m_settings->beginGroup ("Blacklisted Joysticks");
+
+    /* Read the blacklist once, so that hotplug events do not touch the disk */
+    foreach (const QString& name, m_settings->childKeys())
+        m_blacklist.insert (name, m_settings->value (name, false).toBool());
 }
 
 QJoysticks::~QJoysticks()
 {
-    delete m_settings;
     delete m_sdlJoysticks;
     delete m_virtualJoystick;
+    delete m_settings;
+    delete m_conditioner;
 }
 
 /**
@@ -265,6 +289,39 @@ QList<QJoystickDevice*> QJoysticks::inputDevices() const
     return m_devices;
 }
 
+/**
+ * Returns the conditioning settings of the given \a axis of the joystick at
+ * the given \a index. The settings are shared by all the joysticks of the
+ * same model.
+ */
+QVariantMap QJoysticks::axisConditioning (const int index, const int axis)
+{
+    QVariantMap map;
+
+    if (joystickExists (index)) {
+        QMutexLocker locker (&m_mutex);
+        AxisConditioner::Settings settings;
+        settings = m_conditioner->settings (getInputDevice (index)->guid, axis);
+
+        map.insert ("deadzone",  settings.deadzone);
+        map.insert ("expo",      settings.expo);
+        map.insert ("inverted",  settings.inverted);
+        map.insert ("minimum",   settings.minimum);
+        map.insert ("maximum",   settings.maximum);
+        map.insert ("smoothing", settings.smoothing);
+    }
+
+    return map;
+}
+
+/**
+ * Returns a pointer to the axis conditioning system
+ */
+AxisConditioner* QJoysticks::axisConditioner() const
+{
+    return m_conditioner;
+}
+
 /**
  * If \a sort is set to true, then the device list will put all blacklisted
  * joysticks at the end of the list
@@ -304,6 +361,7 @@ void QJoysticks::setBlacklisted (const int index, bool blacklisted)
 
     /* Save settings */
     m_devices.at (index)->blacklisted = blacklisted;
+    m_blacklist.insert (getName (index), blacklisted);
     m_settings->setValue (getName (index), blacklisted);
 
     /* Re-scan joysticks if blacklist value has changed */
@@ -311,70 +369,58 @@ void QJoysticks::setBlacklisted (const int index, bool blacklisted)
         updateInterfaces();
 }
 
+/**
+ * Changes the conditioning settings of the given \a axis of the joystick at
+ * the given \a index. Values missing in \a settings are left unchanged.
+ *
+ * The \a settings map can contain the following values:
+ *     - \c deadzone:  values below this magnitude are set to 0
+ *     - \c expo:      blend between a linear (0) and a cubic (1) curve
+ *     - \c inverted:  set to \c true to invert the axis
+ *     - \c minimum:   minimum value of the axis
+ *     - \c maximum:   maximum value of the axis
+ *     - \c smoothing: time constant (in msecs) of the low-pass filter
+ */
+void QJoysticks::setAxisConditioning (int index, int axis,
+                                      const QVariantMap& settings)
+{
+    if (!joystickExists (index))
+        return;
+
+    QMutexLocker locker (&m_mutex);
+    QString guid = getInputDevice (index)->guid;
+    AxisConditioner::Settings current = m_conditioner->settings (guid, axis);
+
+    current.deadzone  = settings.value ("deadzone",  current.deadzone).toReal();
+    current.expo      = settings.value ("expo",      current.expo).toReal();
+    current.inverted  = settings.value ("inverted",  current.inverted).toBool();
+    current.minimum   = settings.value ("minimum",   current.minimum).toReal();
+    current.maximum   = settings.value ("maximum",   current.maximum).toReal();
+    current.smoothing = settings.value ("smoothing", current.smoothing).toReal();
+
+    m_conditioner->setSettings (guid, axis, current);
+}
+
 /**
  * 'Rescans' for new/removed joysticks and registers them again.
+ *
+ * \note Attached and removed SDL joysticks do not require a re-scan, they
+ *       are handled by the \c onDeviceAdded() and \c onDeviceRemoved()
+ *       functions
  */
 void QJoysticks::updateInterfaces()
 {
     m_devices.clear();
 
-    /* Put blacklisted joysticks at the bottom of the list */
-    if (m_sortJoyticks) {
-        /* Register non-blacklisted SDL joysticks */
-        foreach (QJoystickDevice* joystick, sdlJoysticks()->joysticks()) {
-            joystick->blacklisted = m_settings->value (joystick->name, false).toBool();
-            if (!joystick->blacklisted)
-                addInputDevice (joystick);
-        }
-
-        /* Register the virtual joystick (if its not blacklisted) */
-        if (virtualJoystick()->joystickEnabled()) {
-            QJoystickDevice* joystick = virtualJoystick()->joystick();
-            joystick->blacklisted = m_settings->value (joystick->name, false).toBool();
-
-            if (!joystick->blacklisted) {
-                addInputDevice (joystick);
-                virtualJoystick()->setJoystickID (inputDevices().count() - 1);
-            }
-        }
-
-        /* Register blacklisted SDL joysticks */
-        foreach (QJoystickDevice* joystick, sdlJoysticks()->joysticks()) {
-            joystick->blacklisted = m_settings->value (joystick->name, false).toBool();
-            if (joystick->blacklisted)
-                addInputDevice (joystick);
-        }
-
-        /* Register the virtual joystick (if its blacklisted) */
-        if (virtualJoystick()->joystickEnabled()) {
-            QJoystickDevice* joystick = virtualJoystick()->joystick();
-            joystick->blacklisted = m_settings->value (joystick->name, false).toBool();
-
-            if (joystick->blacklisted) {
-                addInputDevice (joystick);
-                virtualJoystick()->setJoystickID (inputDevices().count() - 1);
-            }
-        }
-    }
+    /* Register SDL joysticks */
+    foreach (QJoystickDevice* joystick, sdlJoysticks()->joysticks())
+        insertInputDevice (joystick);
 
-    /* Sort normally */
-    else {
-        /* Register SDL joysticks */
-        foreach (QJoystickDevice* joystick, sdlJoysticks()->joysticks()) {
-            addInputDevice (joystick);
-            joystick->blacklisted = m_settings->value (joystick->name, false).toBool();
-        }
-
-        /* Register virtual joystick */
-        if (virtualJoystick()->joystickEnabled()) {
-            QJoystickDevice* joystick = virtualJoystick()->joystick();
-            joystick->blacklisted = m_settings->value (joystick->name, false).toBool();
-
-            addInputDevice (joystick);
-            virtualJoystick()->setJoystickID (inputDevices().count() - 1);
-        }
-    }
+    /* Register virtual joystick */
+    if (virtualJoystick()->joystickEnabled())
+        insertInputDevice (virtualJoystick()->joystick());
 
+    updateIDs();
     emit countChanged();
 }
 
@@ -407,14 +453,146 @@ void QJoysticks::resetJoysticks()
 }
 
 /**
- * Registers the given \a device to the \c QJoysticks system
+ * Registers the given \a device to the \c QJoysticks system, the ID of the
+ * device is set to its index in the device list
  */
 void QJoysticks::addInputDevice (QJoystickDevice* device)
 {
     Q_ASSERT (device);
+    device->id = m_devices.count();
     m_devices.append (device);
 }
 
+/**
+ * Registers the given SDL \a device without re-scanning the other joysticks
+ *
+ * \note The device may already be registered if the list was re-scanned
+ *       before the added event was processed
+ */
+void QJoysticks::onDeviceAdded (QJoystickDevice* device)
+{
+    if (m_devices.contains (device))
+        return;
+
+    insertInputDevice (device);
+    updateIDs();
+    emit countChanged();
+}
+
+/**
+ * Un-registers the given SDL \a device without re-scanning the other
+ * joysticks
+ */
+void QJoysticks::onDeviceRemoved (QJoystickDevice* device)
+{
+    m_mutex.lock();
+    m_conditioner->removeDevice (device);
+    m_mutex.unlock();
+
+    if (m_devices.removeAll (device) > 0) {
+        device->id = -1;
+        updateIDs();
+        emit countChanged();
+    }
+}
+
+/**
+ * Inserts the given \a device in the device list, the position depends on
+ * the blacklist state of the device (if the joysticks are sorted by their
+ * blacklist state) and the virtual joystick is always placed after the SDL
+ * joysticks of its group.
+ */
+void QJoysticks::insertInputDevice (QJoystickDevice* device)
+{
+    Q_ASSERT (device);
+    if (m_devices.contains (device))
+        return;
+
+    device->blacklisted = m_blacklist.value (device->name, false);
+
+    int index = 0;
+    int rank = sortRank (device);
+    while (index < m_devices.count() && sortRank (m_devices.at (index)) <= rank)
+        ++index;
+
+    m_devices.insert (index, device);
+}
+
+/**
+ * Returns the group of the given \a device, devices with a lower value are
+ * placed first in the device list
+ */
+int QJoysticks::sortRank (const QJoystickDevice* device) const
+{
+    int rank = (device == virtualJoystick()->joystick()) ? 1 : 0;
+
+    if (m_sortJoyticks && device->blacklisted)
+        rank += 2;
+
+    return rank;
+}
+
+/**
+ * Sets the ID of each device to its index in the device list
+ */
+void QJoysticks::updateIDs()
+{
+    for (int i = 0; i < m_devices.count(); ++i)
+        m_devices.at (i)->id = i;
+}
+
+/**
+ * Applies the conditioning settings of the axis to the given \a event and
+ * emits the resulting axis event.
+ *
+ * \note This function is called from the SDL dispatch thread for SDL
+ *       joysticks, the settle timer is started from the thread of this object
+ */
+void QJoysticks::conditionAxisEvent (const QJoystickAxisEvent& event)
+{
+    QJoystickAxisEvent conditioned = event;
+
+    m_mutex.lock();
+    m_conditioner->apply (&conditioned);
+    bool settling = m_conditioner->isSettling();
+    m_mutex.unlock();
+
+    emit axisEvent (conditioned);
+
+    if (settling)
+        QMetaObject::invokeMethod (this, "startSettling", Qt::AutoConnection);
+}
+
+/**
+ * Starts the settle timer (if it is not already running)
+ */
+void QJoysticks::startSettling()
+{
+    if (!m_settleTimer->isActive())
+        m_settleTimer->start();
+}
+
+/**
+ * Emits the values of the axes whose low-pass filters have not reached
+ * their target yet, this ensures that a filtered axis reaches its final
+ * value even if the joystick does not generate new events
+ */
+void QJoysticks::settleAxes()
+{
+    QList<QJoystickAxisEvent> events;
+
+    m_mutex.lock();
+    m_conditioner->settle (QJoysticksTimestamp(), &events);
+    bool settling = m_conditioner->isSettling();
+    m_mutex.unlock();
+
+    foreach (const QJoystickAxisEvent& event, events)
+        emit axisEvent (event);
+
+    if (!settling)
+        m_settleTimer->stop();
+}
+
 /**
  * Configures the QML-friendly signal based on the information given by the
  * \a event data and updates the joystick values
@@ -23,11 +23,16 @@
 #ifndef _QJOYSTICKS_MAIN_H
 #define _QJOYSTICKS_MAIN_H
 
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QStringList>
+#include <QVariantMap>
 #include <QJoysticks/JoysticksCommon.h>
 
+class QTimer;
 class QSettings;
+class AxisConditioner;
 class SDL_Joysticks;
 class VirtualJoystick;
 
@@ -47,6 +52,12 @@ class VirtualJoystick;
  *
  * \note the virtual joystick will ALWAYS be the last joystick to be registered,
  *       even if it has been enabled before any SDL joystick has been attached.
+ *
+ * \note The \c POVEvent(), \c axisEvent() and \c buttonEvent() signals of
+ *       the SDL joysticks are emitted from the SDL dispatch thread, connect
+ *       to them with \c Qt::DirectConnection to process the input without
+ *       waiting for the GUI thread. The QML-friendly signals are always
+ *       emitted from the thread of this object.
  */
 class QJoysticks : public QObject
 {
@@ -90,9 +101,11 @@ public:
     Q_INVOKABLE bool isBlacklisted (const int index);
     Q_INVOKABLE bool joystickExists (const int index);
     Q_INVOKABLE QString getName (const int index);
+    Q_INVOKABLE QVariantMap axisConditioning (const int index, const int axis);
 
     SDL_Joysticks* sdlJoysticks() const;
     VirtualJoystick* virtualJoystick() const;
+    AxisConditioner* axisConditioner() const;
     QJoystickDevice* getInputDevice (const int index);
     QList<QJoystickDevice*> inputDevices() const;
 
@@ -102,6 +115,7 @@ public slots:
     void setVirtualJoystickEnabled (bool enabled);
     void setSortJoysticksByBlacklistState (bool sort);
     void setBlacklisted (int index, bool blacklisted);
+    void setAxisConditioning (int index, int axis, const QVariantMap& settings);
 
 protected:
     explicit QJoysticks();
@@ -110,18 +124,32 @@ protected:
 private slots:
     void resetJoysticks();
     void addInputDevice (QJoystickDevice* device);
+    void onDeviceAdded (QJoystickDevice* device);
+    void onDeviceRemoved (QJoystickDevice* device);
+    void conditionAxisEvent (const QJoystickAxisEvent& event);
+    void startSettling();
+    void settleAxes();
     void onPOVEvent (const QJoystickPOVEvent& e);
     void onAxisEvent (const QJoystickAxisEvent& e);
     void onButtonEvent (const QJoystickButtonEvent& e);
 
+private:
+    void insertInputDevice (QJoystickDevice* device);
+    int sortRank (const QJoystickDevice* device) const;
+    void updateIDs();
+
 private:
     bool m_sortJoyticks;
 
+    QMutex m_mutex;
+    QTimer* m_settleTimer;
     QSettings* m_settings;
+    AxisConditioner* m_conditioner;
     SDL_Joysticks* m_sdlJoysticks;
     VirtualJoystick* m_virtualJoystick;
 
     QList<QJoystickDevice*> m_devices;
+    QHash<QString, bool> m_blacklist;
 };
 
 #endif
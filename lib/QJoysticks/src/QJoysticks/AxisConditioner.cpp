@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <QtMath>
+#include <QSettings>
+#include <QApplication>
+#include <QJoysticks/AxisConditioner.h>
+
+/* Difference at which the low-pass filter is considered to be settled */
+#define SETTLE_EPSILON 0.0005
+
+AxisConditioner::AxisConditioner()
+{
+    m_settling = 0;
+    m_storage = new QSettings (qApp->organizationName(), qApp->applicationName());
+    m_storage->beginGroup ("Axis Conditioning");
+
+    /* Read the settings of every joystick model */
+    foreach (const QString& guid, m_storage->childGroups()) {
+        m_storage->beginGroup (guid);
+
+        foreach (const QString& axis, m_storage->childGroups()) {
+            Settings defaults = defaultSettings();
+            Settings settings;
+
+            m_storage->beginGroup (axis);
+            settings.deadzone  = m_storage->value ("deadzone",  defaults.deadzone).toReal();
+            settings.expo      = m_storage->value ("expo",      defaults.expo).toReal();
+            settings.inverted  = m_storage->value ("inverted",  defaults.inverted).toBool();
+            settings.minimum   = m_storage->value ("minimum",   defaults.minimum).toReal();
+            settings.maximum   = m_storage->value ("maximum",   defaults.maximum).toReal();
+            settings.smoothing = m_storage->value ("smoothing", defaults.smoothing).toReal();
+            m_storage->endGroup();
+
+            m_settings [guid].insert (axis.toInt(), settings);
+        }
+
+        m_storage->endGroup();
+    }
+}
+
+AxisConditioner::~AxisConditioner()
+{
+    delete m_storage;
+}
+
+/**
+ * Returns the settings of an axis that is not conditioned
+ */
+AxisConditioner::Settings AxisConditioner::defaultSettings()
+{
+    Settings settings;
+    settings.deadzone = 0;
+    settings.expo = 0;
+    settings.inverted = false;
+    settings.minimum = -1;
+    settings.maximum = 1;
+    settings.smoothing = 0;
+    return settings;
+}
+
+/**
+ * Returns the settings of the given \a axis of the joysticks with the given
+ * \a guid
+ */
+AxisConditioner::Settings AxisConditioner::settings (const QString& guid,
+                                                      const int axis) const
+{
+    return m_settings.value (guid).value (axis, defaultSettings());
+}
+
+/**
+ * Changes the \a settings of the given \a axis of the joysticks with the
+ * given \a guid, saves them and updates the attached joysticks
+ */
+void AxisConditioner::setSettings (const QString& guid, const int axis,
+                                   const Settings& settings)
+{
+    m_settings [guid].insert (axis, settings);
+
+    /* Save settings */
+    m_storage->beginGroup (QString ("%1/%2").arg (guid).arg (axis));
+    m_storage->setValue ("deadzone",  settings.deadzone);
+    m_storage->setValue ("expo",      settings.expo);
+    m_storage->setValue ("inverted",  settings.inverted);
+    m_storage->setValue ("minimum",   settings.minimum);
+    m_storage->setValue ("maximum",   settings.maximum);
+    m_storage->setValue ("smoothing", settings.smoothing);
+    m_storage->endGroup();
+
+    /* Update the tables of the attached joysticks */
+    QHash<const QJoystickDevice*, QVector<Axis>>::iterator it;
+    for (it = m_devices.begin(); it != m_devices.end(); ++it) {
+        if (it.key()->guid == guid && axis >= 0 && axis < it.value().count())
+            configure (&it.value() [axis], settings);
+    }
+}
+
+/**
+ * Returns \c true if any low-pass filter has not reached its target value,
+ * in which case the \c settle() function should be called periodically
+ */
+bool AxisConditioner::isSettling() const
+{
+    return m_settling > 0;
+}
+
+/**
+ * Forgets the state of the given \a device, must be called before the
+ * device is deleted
+ */
+void AxisConditioner::removeDevice (const QJoystickDevice* device)
+{
+    if (m_devices.contains (device)) {
+        foreach (const Axis& axis, m_devices.value (device)) {
+            if (!axis.settled)
+                --m_settling;
+        }
+
+        m_devices.remove (device);
+    }
+}
+
+/**
+ * Replaces the value of the given axis \a event with its conditioned value
+ */
+void AxisConditioner::apply (QJoystickAxisEvent* event)
+{
+    QVector<Axis>* axes = device (event->joystick);
+    if (event->axis < 0 || event->axis >= axes->count())
+        return;
+
+    Axis* axis = &(*axes) [event->axis];
+    if (axis->identity)
+        return;
+
+    /* Read the lookup table */
+    double position = (qBound (-1.0, (double) event->value, 1.0) + 1) * TableSize / 2;
+    int index = qMin ((int) position, (int) TableSize - 1);
+    double fraction = position - index;
+    axis->target = axis->table [index] +
+                   (axis->table [index + 1] - axis->table [index]) * fraction;
+
+    /* Apply the low-pass filter */
+    if (axis->smoothing > 0 && axis->timestamp > 0) {
+        double dt = (event->timestamp - axis->timestamp) / 1e6;
+        axis->value += (axis->target - axis->value) * dt / (axis->smoothing + dt);
+    }
+
+    else
+        axis->value = axis->target;
+
+    axis->timestamp = event->timestamp;
+
+    /* Keep track of filters that still have to reach their target */
+    bool settled = qAbs (axis->target - axis->value) < SETTLE_EPSILON;
+    if (settled != axis->settled) {
+        m_settling += settled ? -1 : 1;
+        axis->settled = settled;
+    }
+
+    event->value = axis->value;
+}
+
+/**
+ * Advances the low-pass filters that have not reached their target value
+ * to the given \a timestamp and generates an event for each of them
+ */
+void AxisConditioner::settle (const qint64 timestamp,
+                              QList<QJoystickAxisEvent>* events)
+{
+    QHash<const QJoystickDevice*, QVector<Axis>>::iterator it;
+    for (it = m_devices.begin(); it != m_devices.end() && m_settling > 0; ++it) {
+        for (int i = 0; i < it.value().count(); ++i) {
+            Axis* axis = &it.value() [i];
+            if (axis->settled)
+                continue;
+
+            double dt = (timestamp - axis->timestamp) / 1e6;
+            axis->value += (axis->target - axis->value) * dt / (axis->smoothing + dt);
+            axis->timestamp = timestamp;
+
+            if (qAbs (axis->target - axis->value) < SETTLE_EPSILON) {
+                axis->value = axis->target;
+                axis->settled = true;
+                --m_settling;
+            }
+
+            QJoystickAxisEvent event;
+            event.axis = i;
+            event.value = axis->value;
+            event.timestamp = timestamp;
+            event.joystick = const_cast<QJoystickDevice*> (it.key());
+            events->append (event);
+        }
+    }
+}
+
+/**
+ * Calculates the lookup table of the given \a axis with the given
+ * \a settings
+ */
+void AxisConditioner::configure (Axis* axis, const Settings& settings)
+{
+    Settings defaults = defaultSettings();
+    axis->identity = settings.deadzone <= 0 &&
+                     settings.expo == 0 &&
+                     !settings.inverted &&
+                     settings.minimum <= defaults.minimum &&
+                     settings.maximum >= defaults.maximum &&
+                     settings.smoothing <= 0;
+
+    for (int i = 0; i <= TableSize; ++i)
+        axis->table [i] = curve (settings, (2.0 * i / TableSize) - 1);
+
+    if (!axis->settled)
+        --m_settling;
+
+    axis->settled = true;
+    axis->timestamp = 0;
+    axis->target = 0;
+    axis->value = 0;
+    axis->smoothing = qMax (settings.smoothing, (qreal) 0);
+}
+
+/**
+ * Returns the axis states of the given \a device, the states are created
+ * (with the settings of the GUID of the device) when the device generates
+ * its first event
+ */
+QVector<AxisConditioner::Axis>* AxisConditioner::device (
+    const QJoystickDevice* device)
+{
+    QHash<const QJoystickDevice*, QVector<Axis>>::iterator it;
+    it = m_devices.find (device);
+
+    if (it == m_devices.end()) {
+        it = m_devices.insert (device, QVector<Axis> (device->axes.count()));
+
+        for (int i = 0; i < it.value().count(); ++i) {
+            it.value() [i].settled = true;
+            configure (&it.value() [i], settings (device->guid, i));
+        }
+    }
+
+    return &it.value();
+}
+
+/**
+ * Applies the inversion, deadzone, curve and clamping of the given
+ * \a settings to the given \a value
+ */
+double AxisConditioner::curve (const Settings& settings, const double value)
+{
+    double x = settings.inverted ? -value : value;
+
+    /* Apply the deadzone and re-scale the remaining range */
+    double deadzone = qBound (0.0, (double) settings.deadzone, 0.99);
+    if (qAbs (x) <= deadzone)
+        x = 0;
+    else
+        x = (x > 0 ? 1 : -1) * (qAbs (x) - deadzone) / (1 - deadzone);
+
+    /* Blend the linear and cubic curves */
+    double expo = qBound (0.0, (double) settings.expo, 1.0);
+    x = ((1 - expo) * x) + (expo * x * x * x);
+
+    return qBound ((double) settings.minimum, x, (double) settings.maximum);
+}
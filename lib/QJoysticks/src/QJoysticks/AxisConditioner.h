@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QJOYSTICKS_AXIS_CONDITIONER_H
+#define _QJOYSTICKS_AXIS_CONDITIONER_H
+
+#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QJoysticks/JoysticksCommon.h>
+
+class QSettings;
+
+/**
+ * \brief Applies deadzones, response curves and smoothing to axis values
+ *
+ * The settings of each axis are stored with the GUID of the joystick, so
+ * that they are shared by every joystick of the same model. The deadzone,
+ * curve, inversion and clamping of an axis are pre-calculated in a lookup
+ * table, so conditioning a value only requires a table read, a linear
+ * interpolation and (if enabled) a low-pass filter step.
+ *
+ * \note The settings are read from the disk once, when this object is
+ *       created, and are only written when they are changed.
+ */
+class AxisConditioner
+{
+public:
+    struct Settings {
+        qreal deadzone;  /**< Values below this magnitude are set to 0 */
+        qreal expo;      /**< Blend between a linear (0) and cubic (1) curve */
+        bool inverted;   /**< Set to \c true to invert the axis */
+        qreal minimum;   /**< Minimum output value */
+        qreal maximum;   /**< Maximum output value */
+        qreal smoothing; /**< Time constant (in msecs) of the low-pass filter */
+    };
+
+    AxisConditioner();
+    ~AxisConditioner();
+
+    static Settings defaultSettings();
+
+    Settings settings (const QString& guid, const int axis) const;
+    void setSettings (const QString& guid, const int axis,
+                      const Settings& settings);
+
+    bool isSettling() const;
+    void removeDevice (const QJoystickDevice* device);
+    void apply (QJoystickAxisEvent* event);
+    void settle (const qint64 timestamp, QList<QJoystickAxisEvent>* events);
+
+private:
+    enum {
+        TableSize = 256,
+    };
+
+    struct Axis {
+        bool identity;
+        qreal smoothing;
+        float table [TableSize + 1];
+
+        bool settled;
+        qint64 timestamp;
+        double target;
+        double value;
+    };
+
+    void configure (Axis* axis, const Settings& settings);
+    QVector<Axis>* device (const QJoystickDevice* device);
+    static double curve (const Settings& settings, const double value);
+
+private:
+    int m_settling;
+    QSettings* m_storage;
+    QHash<QString, QMap<int, Settings>> m_settings;
+    QHash<const QJoystickDevice*, QVector<Axis>> m_devices;
+};
+
+#endif
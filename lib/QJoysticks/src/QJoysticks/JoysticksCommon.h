@@ -24,6 +24,8 @@
 #define _QJOYSTICKS_COMMON_H
 
 #include <QString>
+#include <QMetaType>
+#include <QElapsedTimer>
 
 /**
  * @brief Represents a joystick and its properties
@@ -31,6 +33,7 @@
  * This structure contains:
  *     - The numerical ID of the joystick
  *     - The joystick display name
+ *     - The GUID of the joystick model
  *     - The number of axes operated by the joystick
  *     - The number of buttons operated by the joystick
  *     - The number of POVs operated by the joystick
@@ -39,6 +42,7 @@
 struct QJoystickDevice {
     int     id;          /**< Holds the ID of the joystick */
     QString name;        /**< Holds the name/title of the joystick */
+    QString guid;        /**< Holds the GUID of the joystick model */
     QList<int> povs;     /**< Holds the values for each POV */
     QList<double> axes;  /**< Holds the values for each axis */
     QList<bool> buttons; /**< Holds the values for each button */
@@ -66,10 +70,12 @@ struct QJoystickRumble {
  *    - A pointer to the joystick that triggered the event
  *    - The POV number/ID
  *    - The current POV angle
+ *    - The time at which the event arrived
  */
 struct QJoystickPOVEvent {
     int pov;                   /**< The numerical ID of the POV */
     int angle;                 /**< The current angle of the POV */
+    qint64 timestamp;          /**< Time (in nsecs) at which the event arrived */
     QJoystickDevice* joystick; /**< Pointer to the device that caused the event */
 };
 
@@ -80,10 +86,12 @@ struct QJoystickPOVEvent {
  *    - A pointer to the joystick that caused the event
  *    - The axis number/ID
  *    - The current axis value
+ *    - The time at which the event arrived
  */
 struct QJoystickAxisEvent {
     int axis;                  /**< The numerical ID of the axis */
     qreal value;               /**< The value (from -1 to 1) of the axis */
+    qint64 timestamp;          /**< Time (in nsecs) at which the event arrived */
     QJoystickDevice* joystick; /**< Pointer to the device that caused the event */
 };
 
@@ -94,11 +102,39 @@ struct QJoystickAxisEvent {
  *   - A pointer to the joystick that caused the event
  *   - The button number/ID
  *   - The current button state (pressed or not pressed)
+ *   - The time at which the event arrived
  */
 struct QJoystickButtonEvent {
     int button;                /**< The numerical ID of the button */
     bool pressed;              /**< Set to \c true if the button is pressed */
+    qint64 timestamp;          /**< Time (in nsecs) at which the event arrived */
     QJoystickDevice* joystick; /**< Pointer to the device that caused the event */
 };
 
+/* Allow the events to be delivered through queued connections */
+Q_DECLARE_METATYPE (QJoystickPOVEvent)
+Q_DECLARE_METATYPE (QJoystickAxisEvent)
+Q_DECLARE_METATYPE (QJoystickButtonEvent)
+
+/**
+ * @brief Monotonic clock shared by all the input systems
+ */
+struct QJoysticksClock {
+    QElapsedTimer timer;
+    QJoysticksClock()
+    {
+        timer.start();
+    }
+};
+
+/**
+ * Returns the time (in nanoseconds) elapsed since the first call to this
+ * function, used to timestamp the input events as soon as they arrive
+ */
+inline qint64 QJoysticksTimestamp()
+{
+    static QJoysticksClock clock;
+    return clock.timer.nsecsElapsed();
+}
+
 #endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015-2017 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QJOYSTICKS_QUEUE_H
+#define _QJOYSTICKS_QUEUE_H
+
+#include <QAtomicInt>
+
+/**
+ * \brief Lock-free single-producer/single-consumer queue
+ *
+ * Used to pass input events from the input thread to the thread that
+ * consumes them without locking. Only one thread may call \c push() and
+ * only one thread may call \c pop().
+ *
+ * \note \a Size must be a power of two. The head and tail indexes wrap
+ *       around at twice the size, so that a full queue can be told apart
+ *       from an empty one.
+ */
+template <typename T, int Size>
+class QJoysticksQueue
+{
+public:
+    QJoysticksQueue() : m_head (0), m_tail (0), m_dropped (0) {}
+
+    /**
+     * Appends the given \a item to the queue (producer thread only).
+     * If the queue is full, the item is dropped and \c false is returned.
+     */
+    bool push (const T& item)
+    {
+        int tail = m_tail.load();
+        int head = m_head.loadAcquire();
+
+        if (((tail - head) & (2 * Size - 1)) == Size) {
+            m_dropped.ref();
+            return false;
+        }
+
+        m_items [tail & (Size - 1)] = item;
+        m_tail.storeRelease ((tail + 1) & (2 * Size - 1));
+        return true;
+    }
+
+    /**
+     * Removes the oldest item of the queue and copies it to \a item
+     * (consumer thread only). Returns \c false if the queue is empty.
+     */
+    bool pop (T* item)
+    {
+        int head = m_head.load();
+        int tail = m_tail.loadAcquire();
+
+        if (head == tail)
+            return false;
+
+        *item = m_items [head & (Size - 1)];
+        m_head.storeRelease ((head + 1) & (2 * Size - 1));
+        return true;
+    }
+
+    /**
+     * Returns the number of items that were dropped because the queue
+     * was full
+     */
+    int dropped() const
+    {
+        return m_dropped.load();
+    }
+
+private:
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+    QAtomicInt m_dropped;
+    T m_items [Size];
+};
+
+#endif
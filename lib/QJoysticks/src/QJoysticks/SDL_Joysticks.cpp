@@ -22,7 +22,7 @@
 
 #include <QFile>
 #include <QDebug>
-#include <QTimer>
+#include <QMutexLocker>
 #include <QApplication>
 #include <QJoysticks/SDL_Joysticks.h>
 
@@ -47,22 +47,46 @@ static QString GENERIC_MAPPINGS;
     #endif
 #endif
 
+/* Time (in msecs) that the input and dispatch threads wait for an event */
+#define WAIT_TIMEOUT 50
+
+/**
+ * Runs the given loop function of a \c SDL_Joysticks instance
+ */
+class SDL_Joysticks::WorkerThread : public QThread
+{
+public:
+    typedef void (SDL_Joysticks::*Loop)();
+
+    WorkerThread (SDL_Joysticks* joysticks, Loop loop) :
+        m_loop (loop), m_joysticks (joysticks) {}
+
+protected:
+    void run()
+    {
+        (m_joysticks->*m_loop)();
+    }
+
+private:
+    Loop m_loop;
+    SDL_Joysticks* m_joysticks;
+};
+
 SDL_Joysticks::SDL_Joysticks (QObject* parent) : QObject (parent)
 {
-    m_tracker = -1;
+    m_thread = Q_NULLPTR;
+    m_dispatchThread = Q_NULLPTR;
 
 #ifdef SDL_SUPPORTED
-    if (SDL_Init (SDL_INIT_HAPTIC | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER)) {
+    if (SDL_Init (SDL_INIT_AUDIO)) {
         qDebug() << "Cannot initialize SDL:" << SDL_GetError();
         qApp->quit();
     }
 
     QFile database (":/QJoysticks/SDL/Database.txt");
     if (database.open (QFile::ReadOnly)) {
-        while (!database.atEnd()) {
-            QString line = QString::fromUtf8 (database.readLine());
-            SDL_GameControllerAddMapping (line.toStdString().c_str());
-        }
+        while (!database.atEnd())
+            m_mappings.append (QString::fromUtf8 (database.readLine()));
 
         database.close();
     }
@@ -73,84 +97,261 @@ SDL_Joysticks::SDL_Joysticks (QObject* parent) : QObject (parent)
         genericMappings.close();
     }
 
-    QTimer::singleShot (100, Qt::PreciseTimer, this, SLOT (update()));
+    /* Start the input and dispatch threads */
+    m_running = 1;
+    m_thread = new WorkerThread (this, &SDL_Joysticks::run);
+    m_dispatchThread = new WorkerThread (this, &SDL_Joysticks::dispatch);
+    m_thread->start (QThread::HighPriority);
+    m_dispatchThread->start (QThread::HighPriority);
 #endif
 }
 
 SDL_Joysticks::~SDL_Joysticks()
 {
 #ifdef SDL_SUPPORTED
+    /* Stop the threads (the input thread closes the joysticks) */
+    m_running = 0;
+    m_thread->wait();
+    m_dispatchThread->wait();
+    delete m_thread;
+    delete m_dispatchThread;
+
+    /* Delete devices that were removed but not yet processed */
+    InputEvent event;
+    while (m_queue.pop (&event)) {
+        if (event.type == DeviceRemoved)
+            delete event.device;
+    }
+
+    foreach (const InputEvent& deviceEvent, m_deviceEvents) {
+        if (deviceEvent.type == DeviceRemoved)
+            delete deviceEvent.device;
+    }
+
+    foreach (const Device& device, m_devices)
+        delete device.device;
+
+    m_devices.clear();
     SDL_Quit();
 #endif
 }
 
 /**
- * Returns a list with all the registered joystick devices
+ * Returns a list with all the registered joystick devices, sorted in the
+ * order in which they were attached
  */
 QList<QJoystickDevice*> SDL_Joysticks::joysticks()
 {
     QList<QJoystickDevice*> list;
 
 #ifdef SDL_SUPPORTED
-    for (int i = 0; i < SDL_NumJoysticks(); ++i)
-        list.append (getJoystick (i));
+    QMutexLocker locker (&m_mutex);
+
+    /* SDL instance IDs are never re-used, so they follow attach order */
+    QList<int> ids = m_devices.keys();
+    qSort (ids);
+
+    foreach (int id, ids)
+        list.append (m_devices.value (id).device);
 #endif
 
     return list;
 }
 
+/**
+ * Returns the number of input events that were dropped because the queue
+ * was full (e.g. if the dispatch thread was blocked for a long time)
+ */
+int SDL_Joysticks::droppedEvents() const
+{
+    return m_queue.dropped();
+}
+
 /**
  * Based on the data contained in the \a request, this function will instruct
- * the appropriate joystick to rumble for
+ * the appropriate joystick to rumble for. The request is executed by the
+ * input thread.
  */
 void SDL_Joysticks::rumble (const QJoystickRumble& request)
 {
 #ifdef SDL_SUPPORTED
-    SDL_Haptic* haptic = SDL_HapticOpen (request.joystick->id);
-
-    if (haptic) {
-        SDL_HapticRumbleInit (haptic);
-        SDL_HapticRumblePlay (haptic, request.strength, request.length);
-    }
+    QMutexLocker locker (&m_mutex);
+    m_rumbleRequests.append (request);
 #else
     Q_UNUSED (request);
 #endif
 }
 
 /**
- * Polls for new SDL events and reacts to each event accordingly.
+ * Emits the signals of the oldest device event handed over by the dispatch
+ * thread. This function is executed by the thread of this object, once for
+ * each device event.
+ *
+ * \note Removed devices are deleted here, after every signal that was
+ *       queued before the removal (e.g. UI notifications) was delivered
+ */
+void SDL_Joysticks::processDeviceEvent()
+{
+    m_deviceMutex.lock();
+    if (m_deviceEvents.isEmpty()) {
+        m_deviceMutex.unlock();
+        return;
+    }
+
+    InputEvent event = m_deviceEvents.takeFirst();
+    m_deviceMutex.unlock();
+
+    if (event.type == DeviceAdded) {
+        emit joystickAdded (event.device);
+        emit countChanged();
+    }
+
+    else {
+        emit joystickRemoved (event.device);
+        emit countChanged();
+        delete event.device;
+    }
+}
+
+/**
+ * Main loop of the dispatch thread, reads the events translated by the
+ * input thread as soon as they are queued and emits the appropriate signals
  */
-void SDL_Joysticks::update()
+void SDL_Joysticks::dispatch()
+{
+    InputEvent event;
+    while (m_running.loadAcquire()) {
+        /* Consume every wake-up at once, the queue is drained below */
+        int count = qMax (m_available.available(), 1);
+        if (!m_available.tryAcquire (count, WAIT_TIMEOUT))
+            continue;
+
+        while (m_queue.pop (&event))
+            dispatchEvent (event);
+    }
+}
+
+/**
+ * Emits the input signal of the given \a event from the dispatch thread.
+ * Device events are handed over to the thread of this object.
+ */
+void SDL_Joysticks::dispatchEvent (const InputEvent& event)
+{
+    switch (event.type) {
+    case DeviceAdded:
+    case DeviceRemoved:
+        m_deviceMutex.lock();
+        m_deviceEvents.append (event);
+        m_deviceMutex.unlock();
+        QMetaObject::invokeMethod (this, "processDeviceEvent",
+                                   Qt::QueuedConnection);
+        break;
+    case AxisMoved: {
+        QJoystickAxisEvent axis;
+        axis.axis = event.index;
+        axis.joystick = event.device;
+        axis.timestamp = event.timestamp;
+        axis.value = static_cast<qreal> (event.value) / 32767;
+        emit axisEvent (axis);
+        break;
+    }
+    case ButtonChanged: {
+        QJoystickButtonEvent button;
+        button.button = event.index;
+        button.joystick = event.device;
+        button.timestamp = event.timestamp;
+        button.pressed = event.value != 0;
+        emit buttonEvent (button);
+        break;
+    }
+    case POVChanged: {
+        QJoystickPOVEvent pov;
+        pov.pov = event.index;
+        pov.angle = event.value;
+        pov.joystick = event.device;
+        pov.timestamp = event.timestamp;
+        emit POVEvent (pov);
+        break;
+    }
+    }
+}
+
+/**
+ * Main loop of the input thread, waits for SDL events and translates them
+ * as soon as they arrive. All the SDL joystick functions are called from
+ * this thread.
+ */
+void SDL_Joysticks::run()
 {
 #ifdef SDL_SUPPORTED
+    if (SDL_InitSubSystem (SDL_INIT_HAPTIC | SDL_INIT_GAMECONTROLLER)) {
+        qDebug() << "Cannot initialize SDL joysticks:" << SDL_GetError();
+        return;
+    }
+
+    foreach (const QString& mapping, m_mappings)
+        SDL_GameControllerAddMapping (mapping.toStdString().c_str());
+
     SDL_Event event;
+    while (m_running.loadAcquire()) {
+        if (SDL_WaitEventTimeout (&event, WAIT_TIMEOUT)) {
+            handleEvent (&event, QJoysticksTimestamp());
 
-    while (SDL_PollEvent (&event)) {
-        switch (event.type) {
-        case SDL_JOYDEVICEADDED:
-            configureJoystick (&event);
-            break;
-        case SDL_JOYDEVICEREMOVED:
-            SDL_JoystickClose (SDL_JoystickOpen (event.jdevice.which));
-            SDL_GameControllerClose (SDL_GameControllerOpen (event.cdevice.which));
-            emit countChanged();
-            break;
-        case SDL_CONTROLLERAXISMOTION:
-            emit axisEvent (getAxisEvent (&event));
-            break;
-        case SDL_JOYBUTTONUP:
-            emit buttonEvent (getButtonEvent (&event));
-            break;
-        case SDL_JOYBUTTONDOWN:
-            emit buttonEvent (getButtonEvent (&event));
-            break;
-        case SDL_JOYHATMOTION:
-            emit POVEvent (getPOVEvent (&event));
-            break;
+            while (SDL_PollEvent (&event))
+                handleEvent (&event, QJoysticksTimestamp());
         }
+
+        processRumbleRequests();
     }
 
-    QTimer::singleShot (10, Qt::PreciseTimer, this, SLOT (update()));
+    /* Close the joysticks (the devices are deleted by the destructor) */
+    m_mutex.lock();
+    foreach (const Device& device, m_devices)
+        closeDevice (device);
+    m_mutex.unlock();
+
+    SDL_QuitSubSystem (SDL_INIT_HAPTIC | SDL_INIT_GAMECONTROLLER);
+#endif
+}
+
+/**
+ * Translates the given SDL \a event and queues it for the dispatch thread
+ */
+void SDL_Joysticks::handleEvent (const SDL_Event* event, const qint64 timestamp)
+{
+#ifdef SDL_SUPPORTED
+    QJoystickDevice* device = Q_NULLPTR;
+
+    switch (event->type) {
+    case SDL_JOYDEVICEADDED:
+        configureJoystick (event, timestamp);
+        break;
+    case SDL_JOYDEVICEREMOVED:
+        removeJoystick (event, timestamp);
+        break;
+    case SDL_CONTROLLERAXISMOTION:
+        device = m_devices.value (event->caxis.which).device;
+        if (device)
+            pushEvent (AxisMoved, timestamp, device,
+                       event->caxis.axis, event->caxis.value);
+        break;
+    case SDL_JOYBUTTONUP:
+    case SDL_JOYBUTTONDOWN:
+        device = m_devices.value (event->jbutton.which).device;
+        if (device)
+            pushEvent (ButtonChanged, timestamp, device,
+                       event->jbutton.button, event->jbutton.state == SDL_PRESSED);
+        break;
+    case SDL_JOYHATMOTION:
+        device = m_devices.value (event->jhat.which).device;
+        if (device)
+            pushEvent (POVChanged, timestamp, device,
+                       event->jhat.hat, getPOVAngle (event->jhat.value));
+        break;
+    }
+#else
+    Q_UNUSED (event);
+    Q_UNUSED (timestamp);
 #endif
 }
 
@@ -158,8 +359,13 @@ void SDL_Joysticks::update()
  * Checks if the joystick referenced by the \a event can be initialized.
  * If not, the function will apply a generic mapping to the joystick and
  * attempt to initialize the joystick again.
+ *
+ * Once the joystick is open, a \c QJoystickDevice is created for it and
+ * registered with the SDL instance ID of the joystick. The device is kept
+ * until the joystick is removed.
  */
-void SDL_Joysticks::configureJoystick (const SDL_Event* event)
+void SDL_Joysticks::configureJoystick (const SDL_Event* event,
+                                       const qint64 timestamp)
 {
 #ifdef SDL_SUPPORTED
     if (!SDL_IsGameController (event->cdevice.which)) {
@@ -179,164 +385,183 @@ void SDL_Joysticks::configureJoystick (const SDL_Event* event)
         }
     }
 
-    SDL_GameControllerOpen (event->cdevice.which);
+    Device device;
+    device.haptic = NULL;
+    device.controller = SDL_GameControllerOpen (event->cdevice.which);
+
+    if (device.controller)
+        device.joystick = SDL_GameControllerGetJoystick (device.controller);
+    else
+        device.joystick = SDL_JoystickOpen (event->jdevice.which);
+
+    if (!device.joystick) {
+        qWarning() << Q_FUNC_INFO << "Cannot open joystick:" << SDL_GetError();
+        return;
+    }
+
+    /* Joystick is already registered, release the extra reference */
+    int instanceID = SDL_JoystickInstanceID (device.joystick);
+    if (m_devices.contains (instanceID)) {
+        closeDevice (device);
+        return;
+    }
+
+    /* Create the device and initialize its values */
+    char guid [33];
+    SDL_JoystickGetGUIDString (SDL_JoystickGetGUID (device.joystick),
+                               guid, sizeof (guid));
+
+    device.device = new QJoystickDevice;
+    device.device->id = -1;
+    device.device->guid = guid;
+    device.device->blacklisted = false;
+    device.device->name = SDL_JoystickName (device.joystick);
+
+    for (int i = 0; i < SDL_JoystickNumHats (device.joystick); ++i)
+        device.device->povs.append (0);
+
+    for (int i = 0; i < SDL_JoystickNumAxes (device.joystick); ++i)
+        device.device->axes.append (0);
+
+    for (int i = 0; i < SDL_JoystickNumButtons (device.joystick); ++i)
+        device.device->buttons.append (false);
+
+    m_mutex.lock();
+    m_devices.insert (instanceID, device);
+    m_mutex.unlock();
 
-    ++m_tracker;
-    emit countChanged();
+    pushEvent (DeviceAdded, timestamp, device.device, 0, 0);
 #else
     Q_UNUSED (event);
+    Q_UNUSED (timestamp);
 #endif
 }
 
 /**
- * Returns a joystick ID compatible with the \c QJoysticks system.
- * SDL assigns an ID to each joystick based on the order that they are attached,
- * but it does not decrease the ID counter when a joystick is removed.
- *
- * As noted earlier, the \c QJoysticks maintains an ID system similar to the
- * one used by a \c QList, since it eases the operation with most Qt classes
- * and widgets.
+ * Closes the joystick referenced by the \a event. The device is deleted by
+ * the thread of this object once it has processed the removal event.
  */
-int SDL_Joysticks::getDynamicID (int id)
+void SDL_Joysticks::removeJoystick (const SDL_Event* event,
+                                    const qint64 timestamp)
 {
 #ifdef SDL_SUPPORTED
-    id = abs (m_tracker - (id + 1));
+    if (!m_devices.contains (event->jdevice.which))
+        return;
 
-    if (id >= SDL_NumJoysticks())
-        id -= 1;
+    m_mutex.lock();
+    Device device = m_devices.take (event->jdevice.which);
+    m_mutex.unlock();
 
+    closeDevice (device);
+    pushEvent (DeviceRemoved, timestamp, device.device, 0, 0);
+#else
+    Q_UNUSED (event);
+    Q_UNUSED (timestamp);
 #endif
-
-    return id;
 }
 
 /**
- * Returns the josytick device registered with the given \a id.
- * If no joystick with the given \a id is found, then the function will warn
- * the user through the console.
+ * Queues a new input event and wakes up the dispatch thread
  */
-QJoystickDevice* SDL_Joysticks::getJoystick (int id)
+void SDL_Joysticks::pushEvent (const InputEventType type,
+                               const qint64 timestamp,
+                               QJoystickDevice* device,
+                               const int index,
+                               const int value)
 {
-#ifdef SDL_SUPPORTED
-    QJoystickDevice* joystick = new QJoystickDevice;
-    SDL_Joystick* sdl_joystick = SDL_JoystickOpen (id);
-    joystick->id = getDynamicID (id);
-
-    if (sdl_joystick) {
-        joystick->blacklisted = false;
-        joystick->name = SDL_JoystickName (sdl_joystick);
-
-        /* Get joystick properties */
-        int povs = SDL_JoystickNumHats (sdl_joystick);
-        int axes = SDL_JoystickNumAxes (sdl_joystick);
-        int buttons = SDL_JoystickNumButtons (sdl_joystick);
-
-        /* Initialize POVs */
-        for (int i = 0; i < povs; ++i)
-            joystick->povs.append (0);
-
-        /* Initialize axes */
-        for (int i = 0; i < axes; ++i)
-            joystick->axes.append (0);
-
-        /* Initialize buttons */
-        for (int i = 0; i < buttons; ++i)
-            joystick->buttons.append (false);
-    }
-
-    else
-        qWarning() << Q_FUNC_INFO << "Cannot find joystick with id:" << id;
-
-    return joystick;
-#else
-    Q_UNUSED (id);
-    return NULL;
-#endif
+    InputEvent event;
+    event.type = type;
+    event.timestamp = timestamp;
+    event.device = device;
+    event.index = index;
+    event.value = value;
+
+    /* Device events must not be lost, wait for the dispatch thread */
+    while (!m_queue.push (event) && (type == DeviceAdded || type == DeviceRemoved))
+        QThread::msleep (1);
+
+    m_available.release();
 }
 
 /**
- * Reads the contents of the given \a event and constructs a new
- * \c QJoystickPOVEvent to be used with the \c QJoysticks system.
+ * Executes the rumble requests registered with the \c rumble() function
  */
-QJoystickPOVEvent SDL_Joysticks::getPOVEvent (const SDL_Event* sdl_event)
+void SDL_Joysticks::processRumbleRequests()
 {
-    QJoystickPOVEvent event;
-
 #ifdef SDL_SUPPORTED
-    event.pov = sdl_event->jhat.hat;
-    event.joystick = getJoystick (sdl_event->jdevice.which);
+    QMutexLocker locker (&m_mutex);
 
-    switch (sdl_event->jhat.value) {
-    case SDL_HAT_RIGHTUP:
-        event.angle = 45;
-        break;
-    case SDL_HAT_RIGHTDOWN:
-        event.angle = 135;
-        break;
-    case SDL_HAT_LEFTDOWN:
-        event.angle = 225;
-        break;
-    case SDL_HAT_LEFTUP:
-        event.angle = 315;
-        break;
-    case SDL_HAT_UP:
-        event.angle = 0;
-        break;
-    case SDL_HAT_RIGHT:
-        event.angle = 90;
-        break;
-    case SDL_HAT_DOWN:
-        event.angle = 180;
-        break;
-    case SDL_HAT_LEFT:
-        event.angle = 270;
-        break;
-    default:
-        event.angle = -1;
-        break;
+    foreach (const QJoystickRumble& request, m_rumbleRequests) {
+        for (QHash<int, Device>::iterator it = m_devices.begin();
+                it != m_devices.end(); ++it) {
+            if (it.value().device != request.joystick)
+                continue;
+
+            if (!it.value().haptic) {
+                it.value().haptic = SDL_HapticOpenFromJoystick (it.value().joystick);
+
+                if (it.value().haptic)
+                    SDL_HapticRumbleInit (it.value().haptic);
+            }
+
+            if (it.value().haptic)
+                SDL_HapticRumblePlay (it.value().haptic,
+                                      request.strength,
+                                      request.length);
+        }
     }
-#else
-    Q_UNUSED (sdl_event);
-#endif
 
-    return event;
+    m_rumbleRequests.clear();
+#endif
 }
 
 /**
- * Reads the contents of the given \a event and constructs a new
- * \c QJoystickAxisEvent to be used with the \c QJoysticks system.
+ * Closes the SDL handles of the given \a device
  */
-QJoystickAxisEvent SDL_Joysticks::getAxisEvent (const SDL_Event* sdl_event)
+void SDL_Joysticks::closeDevice (const Device& device)
 {
-    QJoystickAxisEvent event;
-
 #ifdef SDL_SUPPORTED
-    event.axis = sdl_event->caxis.axis;
-    event.value = static_cast<qreal> (sdl_event->caxis.value) / 32767;
-    event.joystick = getJoystick (sdl_event->cdevice.which);
+    if (device.haptic)
+        SDL_HapticClose (device.haptic);
+
+    if (device.controller)
+        SDL_GameControllerClose (device.controller);
+    else
+        SDL_JoystickClose (device.joystick);
 #else
-    Q_UNUSED (sdl_event);
+    Q_UNUSED (device);
 #endif
-
-    return event;
 }
 
 /**
- * Reads the contents of the given \a event and constructs a new
- * \c QJoystickButtonEvent to be used with the \c QJoysticks system.
+ * Converts the given SDL hat \a value to an angle (in degrees), -1 is
+ * returned if the hat is centered
  */
-QJoystickButtonEvent SDL_Joysticks::getButtonEvent (const SDL_Event*
-        sdl_event)
+int SDL_Joysticks::getPOVAngle (const int value)
 {
-    QJoystickButtonEvent event;
-
 #ifdef SDL_SUPPORTED
-    event.button = sdl_event->jbutton.button;
-    event.pressed = sdl_event->jbutton.state == SDL_PRESSED;
-    event.joystick = getJoystick (sdl_event->jdevice.which);
+    switch (value) {
+    case SDL_HAT_RIGHTUP:
+        return 45;
+    case SDL_HAT_RIGHTDOWN:
+        return 135;
+    case SDL_HAT_LEFTDOWN:
+        return 225;
+    case SDL_HAT_LEFTUP:
+        return 315;
+    case SDL_HAT_UP:
+        return 0;
+    case SDL_HAT_RIGHT:
+        return 90;
+    case SDL_HAT_DOWN:
+        return 180;
+    case SDL_HAT_LEFT:
+        return 270;
+    default:
+        return -1;
+    }
 #else
-    Q_UNUSED (sdl_event);
+    Q_UNUSED (value);
+    return -1;
 #endif
-
-    return event;
 }
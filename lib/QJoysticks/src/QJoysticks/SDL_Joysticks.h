@@ -24,7 +24,14 @@
 #define _QJOYSTICKS_SDL_JOYSTICK_H
 
 #include <SDL.h>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QThread>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QStringList>
+#include <QJoysticks/JoysticksQueue.h>
 #include <QJoysticks/JoysticksCommon.h>
 
 /**
@@ -36,8 +43,13 @@
  * The only thing that differs from each operating system is the backup mapping
  * applied in the case that we do not know what mapping to apply to a joystick.
  *
- * \note The joystick values are refreshed every 20 milliseconds through a
- *       simple event loop.
+ * \note SDL is operated from a dedicated input thread, which blocks until
+ *       SDL reports an event. The events are timestamped as soon as they
+ *       arrive, translated and handed to a dispatch thread through a
+ *       lock-free queue. The axis, button and POV signals are emitted from
+ *       the dispatch thread, so the input latency does not depend on the
+ *       load of the GUI thread. Only the device signals are emitted from
+ *       the thread of this object.
  */
 class SDL_Joysticks : public QObject
 {
@@ -45,6 +57,8 @@ class SDL_Joysticks : public QObject
 
 signals:
     void countChanged();
+    void joystickAdded (QJoystickDevice* device);
+    void joystickRemoved (QJoystickDevice* device);
     void POVEvent (const QJoystickPOVEvent& event);
     void axisEvent (const QJoystickAxisEvent& event);
     void buttonEvent (const QJoystickButtonEvent& event);
@@ -54,24 +68,67 @@ public:
     ~SDL_Joysticks();
 
     QList<QJoystickDevice*> joysticks();
+    int droppedEvents() const;
 
 public slots:
     void rumble (const QJoystickRumble& request);
 
 private slots:
-    void update();
-    void configureJoystick (const SDL_Event* event);
+    void processDeviceEvent();
 
 private:
-    int getDynamicID (int id);
+    enum InputEventType {
+        DeviceAdded,
+        DeviceRemoved,
+        AxisMoved,
+        ButtonChanged,
+        POVChanged,
+    };
 
-    QJoystickDevice* getJoystick (int id);
-    QJoystickPOVEvent getPOVEvent (const SDL_Event* sdl_event);
-    QJoystickAxisEvent getAxisEvent (const SDL_Event* sdl_event);
-    QJoystickButtonEvent getButtonEvent (const SDL_Event* sdl_event);
+    struct InputEvent {
+        InputEventType type;
+        qint64 timestamp;
+        QJoystickDevice* device;
+        int index;
+        int value;
+    };
 
-    int m_tracker;
-    QList<QJoystickDevice> m_joysticks;
+    struct Device {
+        QJoystickDevice* device;
+        SDL_Joystick* joystick;
+        SDL_GameController* controller;
+        SDL_Haptic* haptic;
+    };
+
+    class WorkerThread;
+    friend class WorkerThread;
+
+    void run();
+    void dispatch();
+    void dispatchEvent (const InputEvent& event);
+    void handleEvent (const SDL_Event* event, const qint64 timestamp);
+    void configureJoystick (const SDL_Event* event, const qint64 timestamp);
+    void removeJoystick (const SDL_Event* event, const qint64 timestamp);
+    void pushEvent (const InputEventType type, const qint64 timestamp,
+                    QJoystickDevice* device, const int index, const int value);
+    void processRumbleRequests();
+    void closeDevice (const Device& device);
+
+    static int getPOVAngle (const int value);
+
+    QMutex m_mutex;
+    QThread* m_thread;
+    QThread* m_dispatchThread;
+    QAtomicInt m_running;
+    QSemaphore m_available;
+
+    QMutex m_deviceMutex;
+    QList<InputEvent> m_deviceEvents;
+
+    QStringList m_mappings;
+    QHash<int, Device> m_devices;
+    QList<QJoystickRumble> m_rumbleRequests;
+    QJoysticksQueue<InputEvent, 1024> m_queue;
 };
 
 #endif
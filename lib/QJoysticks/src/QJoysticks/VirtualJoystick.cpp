@@ -28,6 +28,7 @@ VirtualJoystick::VirtualJoystick (QObject* parent) : QObject (parent)
     m_axisRange = 1;
     m_joystickEnabled = false;
     m_joystick.blacklisted = false;
+    m_joystick.guid = "virtual";
     m_joystick.name = tr ("Virtual Joystick");
 
     /* Initialize POVs */
@@ -175,6 +176,7 @@ void VirtualJoystick::readAxes (int key, bool pressed)
         event.axis     = axis;
         event.value    = value;
         event.joystick = joystick();
+        event.timestamp = QJoysticksTimestamp();
 
         emit axisEvent (event);
     }
@@ -205,6 +207,7 @@ void VirtualJoystick::readPOVs (int key, bool pressed)
         event.pov      = 0;
         event.angle    = angle;
         event.joystick = joystick();
+        event.timestamp = QJoysticksTimestamp();
 
         emit povEvent (event);
     }
@@ -244,6 +247,7 @@ void VirtualJoystick::readButtons (int key, bool pressed)
         event.button   = button;
         event.pressed  = pressed;
         event.joystick = joystick();
+        event.timestamp = QJoysticksTimestamp();
 
         emit buttonEvent (event);
     }
@@ -11,6 +11,8 @@
 
 #include <QtTest>
 #include <QJoysticks.h>
+#include <QJoysticks/JoysticksQueue.h>
+#include <QJoysticks/AxisConditioner.h>
 
 class Test_QJoysticks : public QObject
 {
@@ -19,6 +21,9 @@ class Test_QJoysticks : public QObject
 private slots:
     void initTestCase()
     {
+        /* Keep the settings written by the tests away from the user's */
+        QStandardPaths::setTestModeEnabled (true);
+
         /* Get the QJoysticks instance */
         joysticks = QJoysticks::getInstance();
 
@@ -94,6 +99,107 @@ private slots:
         QVERIFY (joysticks->getInputDevice (0) == &device);
     }
 
+    void checkHotplug()
+    {
+        QJoystickDevice first;
+        QJoystickDevice second;
+        first.name = "First device";
+        second.name = "Second device";
+
+        /* Attach two devices */
+        joysticks->resetJoysticks();
+        joysticks->onDeviceAdded (&first);
+        joysticks->onDeviceAdded (&second);
+
+        QVERIFY (joysticks->count() == 2);
+        QVERIFY (first.id == 0);
+        QVERIFY (second.id == 1);
+
+        /* A device that is already registered must not be added twice */
+        joysticks->onDeviceAdded (&first);
+        QVERIFY (joysticks->count() == 2);
+
+        /* Remove the first device, the other device must be moved up */
+        joysticks->onDeviceRemoved (&first);
+
+        QVERIFY (joysticks->count() == 1);
+        QVERIFY (first.id == -1);
+        QVERIFY (second.id == 0);
+        QVERIFY (joysticks->getInputDevice (0) == &second);
+
+        joysticks->resetJoysticks();
+    }
+
+    void checkAxisConditioning()
+    {
+        AxisConditioner conditioner;
+        AxisConditioner::Settings settings = AxisConditioner::defaultSettings();
+
+        QJoystickDevice stick;
+        stick.guid = "test";
+        stick.axes.append (0);
+
+        QJoystickAxisEvent event;
+        event.axis = 0;
+        event.timestamp = 1;
+        event.joystick = &stick;
+
+        /* Values inside the deadzone must be neutral */
+        settings.deadzone = 0.2;
+        conditioner.setSettings (stick.guid, 0, settings);
+        event.value = 0.1;
+        conditioner.apply (&event);
+        QVERIFY (event.value == 0);
+
+        /* Inverted and clamped values */
+        settings.deadzone = 0;
+        settings.inverted = true;
+        settings.minimum = -0.5;
+        conditioner.setSettings (stick.guid, 0, settings);
+        event.value = 0.25;
+        conditioner.apply (&event);
+        QVERIFY (qAbs (event.value + 0.25) < 0.001);
+        event.value = 1;
+        conditioner.apply (&event);
+        QVERIFY (qAbs (event.value + 0.5) < 0.001);
+
+        /* Restore the default settings */
+        conditioner.setSettings (stick.guid, 0, AxisConditioner::defaultSettings());
+        conditioner.removeDevice (&stick);
+    }
+
+    void checkEventQueue()
+    {
+        QJoysticksQueue<int, 4> queue;
+        int value = 0;
+
+        /* Queue must be empty */
+        QVERIFY (queue.pop (&value) == false);
+
+        /* Fill the queue, the extra item must be dropped */
+        for (int i = 0; i < 5; ++i)
+            queue.push (i);
+
+        QVERIFY (queue.dropped() == 1);
+
+        /* Items must be read in order, even after wrapping around */
+        for (int i = 0; i < 3; ++i) {
+            QVERIFY (queue.pop (&value));
+            QVERIFY (value == i);
+        }
+
+        QVERIFY (queue.push (10));
+        QVERIFY (queue.push (11));
+        QVERIFY (queue.push (12));
+        QVERIFY (queue.push (13) == false);
+
+        QVERIFY (queue.pop (&value) && value == 3);
+        QVERIFY (queue.pop (&value) && value == 10);
+        QVERIFY (queue.pop (&value) && value == 11);
+        QVERIFY (queue.pop (&value) && value == 12);
+        QVERIFY (queue.pop (&value) == false);
+    }
+
     void verifyCrashAvoidance()
     {
         joysticks->resetJoysticks();
@@ -107,6 +213,14 @@ private slots:
         qDebug() << joysticks->getInputDevice (2);
     }
 
+    void cleanupTestCase()
+    {
+        /* Remove the blacklist and axis settings written by the tests */
+        QSettings settings (qApp->organizationName(), qApp->applicationName());
+        settings.clear();
+        settings.sync();
+    }
+
 private:
     QJoysticks* joysticks;
     QJoystickDevice device;
@@ -36,8 +36,8 @@ Window {
     title: qsTr ("Settings")
     minimumWidth: Globals.scale (420)
     maximumWidth: Globals.scale (420)
-    minimumHeight: Globals.scale (340)
-    maximumHeight: Globals.scale (340)
+    minimumHeight: Globals.scale (370)
+    maximumHeight: Globals.scale (370)
     color: Globals.Colors.WindowBackground
 
     //
@@ -78,6 +78,7 @@ Window {
         updatePlaceholders()
         Beeper.setEnabled (enableSoundEffects.checked)
         Utilities.setAutoScaleEnabled (autoScale.checked)
+        DS.setRealtimeEnabled (realtime.checked)
 		
         DS.customFMSAddress = fmsAddress.text
         DS.customRadioAddress = radioAddress.text
@@ -110,6 +111,7 @@ Window {
         property alias y: window.y
         property alias address: robotAddress.text
         property alias autoScale: autoScale.checked
+        property alias realtime: realtime.checked
         property alias enableSoundEffects: enableSoundEffects.checked
     }
 
@@ -238,6 +240,12 @@ Window {
                             id: autoScale
                             text: qsTr ("Auto-scale text and UI items")
                         }
+
+                        Checkbox {
+                            checked: false
+                            id: realtime
+                            text: qsTr ("Real-time priority for robot communications")
+                        }
                     }
                 }  
 
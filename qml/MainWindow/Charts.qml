@@ -23,6 +23,7 @@
 import QtQuick 2.0
 import QtQuick.Window 2.0
 import QtQuick.Layouts 1.0
+import QtQuick.Controls 1.4 as Controls
 import Qt.labs.settings 1.0
 
 import "../Widgets"
@@ -37,6 +38,35 @@ Item {
         voltage.clear()
         loss.setSpeed (seconds)
         voltage.setSpeed (seconds)
+        DSTelemetry.windowLength = seconds * 1000
+    }
+
+    //
+    // Returns the elapsed time (in mm:ss format) between the start of the
+    // telemetry log and the given \a time
+    //
+    function formatTime (time) {
+        var secs = Math.max (0, Math.floor ((time - DSTelemetry.firstTime) / 1000))
+        var mins = Math.floor (secs / 60)
+        secs = secs % 60
+        return mins + ":" + (secs < 10 ? "0" : "") + secs
+    }
+
+    //
+    // Re-reads the telemetry log while it is being written, the review
+    // chart follows the newest samples if the slider is at its end
+    //
+    Timer {
+        repeat: true
+        running: true
+        interval: 1000
+        onTriggered: {
+            var following = scrubber.value >= scrubber.maximumValue
+            DSTelemetry.refresh()
+
+            if (following)
+                scrubber.value = scrubber.maximumValue
+        }
     }
 
     //
@@ -171,5 +201,90 @@ Item {
             Layout.fillWidth: true
             Layout.fillHeight: true
         }
+
+        //
+        // Session review controls
+        //
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Globals.spacing
+
+            Label {
+                text: qsTr ("Session Review") + ":"
+            }
+
+            Combobox {
+                id: channelSelector
+                model: DSTelemetry.channels
+                Layout.preferredWidth: Globals.scale (128)
+                onCurrentTextChanged: DSTelemetry.channel = currentText
+                Component.onCompleted: currentIndex = Math.max (0, find (DSTelemetry.channel))
+            }
+
+            Item {
+                Layout.fillWidth: true
+            }
+
+            Label {
+                size: small
+                text: qsTr ("Min") + ": " + DSTelemetry.minimum.toFixed (2) + "  "
+                      + qsTr ("Avg") + ": " + DSTelemetry.average.toFixed (2) + "  "
+                      + qsTr ("Max") + ": " + DSTelemetry.maximum.toFixed (2)
+            }
+        }
+
+        //
+        // Min/max envelope of the selected channel in the selected window
+        //
+        Rectangle {
+            id: review
+            Layout.fillWidth: true
+            Layout.preferredHeight: Globals.scale (48)
+            border.width: Globals.scale (1)
+            color: Globals.Colors.WindowBackground
+            border.color: Globals.Colors.WidgetBorder
+
+            property real range: Math.max (DSTelemetry.maximum - DSTelemetry.minimum, 1)
+
+            Repeater {
+                model: DSTelemetry
+                delegate: Rectangle {
+                    visible: count > 0
+                    color: Globals.Colors.HighlightColor
+                    width: Math.max (1, review.width / DSTelemetry.buckets)
+                    x: index * review.width / DSTelemetry.buckets
+                    y: review.height * (1 - (maximum - DSTelemetry.minimum) / review.range)
+                    height: Math.max (1, review.height * (maximum - minimum) / review.range)
+                }
+            }
+        }
+
+        //
+        // Scrubs through the whole telemetry log
+        //
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Globals.spacing
+
+            Label {
+                size: small
+                text: formatTime (DSTelemetry.windowStart)
+            }
+
+            Controls.Slider {
+                id: scrubber
+                Layout.fillWidth: true
+                minimumValue: DSTelemetry.firstTime
+                maximumValue: Math.max (DSTelemetry.firstTime,
+                                        DSTelemetry.lastTime - DSTelemetry.windowLength)
+                onValueChanged: DSTelemetry.windowStart = value
+                Component.onCompleted: value = maximumValue
+            }
+
+            Label {
+                size: small
+                text: formatTime (DSTelemetry.lastTime)
+            }
+        }
     }
 }
@@ -64,6 +64,68 @@ RowLayout {
             }
         }
 
+        //
+        // DSCP marking of the robot packets (as reported by the system)
+        //
+        Label {
+            id: qos
+            property var robot: undefined
+
+            function update() {
+                var sockets = DS.socketQoS()
+                robot = sockets.length > 1 ? sockets [1] : undefined
+            }
+
+            Timer {
+                repeat: true
+                running: true
+                interval: 1000
+                onTriggered: qos.update()
+                Component.onCompleted: qos.update()
+            }
+
+            text: {
+                var value = Globals.invalidStr
+                if (robot && robot.requestedDscp > 0) {
+                    value = robot.dscp === robot.requestedDscp ?
+                                "DSCP " + robot.dscp :
+                                qsTr ("Rejected")
+                }
+
+                return qsTr ("Robot QoS") + ": " + value
+            }
+        }
+
+        //
+        // Real-time profile of the protocol threads
+        //
+        Label {
+            id: realtime
+            property var status: undefined
+
+            Timer {
+                repeat: true
+                running: true
+                interval: 1000
+                onTriggered: realtime.status = DS.realtimeStatus()
+                Component.onCompleted: realtime.status = DS.realtimeStatus()
+            }
+
+            text: {
+                var value = Globals.invalidStr
+                if (status && status.enabled) {
+                    if (status.scheduler === 1)
+                        value = qsTr ("Priority")
+                    else if (status.nice === 1)
+                        value = qsTr ("Nice")
+                    else
+                        value = qsTr ("Denied")
+                }
+
+                return qsTr ("Real-time") + ": " + value
+            }
+        }
+
         Item {
             Layout.fillHeight: true
         }
@@ -150,4 +212,198 @@ RowLayout {
     Item {
         Layout.fillWidth: true
     }
+
+    //
+    // Computer information items (used to tell apart local and field issues)
+    //
+    ColumnLayout {
+        id: host
+        Layout.fillHeight: true
+        spacing: Globals.spacing
+
+        property var metrics: HostMetrics.snapshot()
+        property var drops: {
+            var rx = 0
+            var tx = 0
+            for (var i = 0; i < metrics.interfaces.length; ++i) {
+                rx += metrics.interfaces [i].rxDrops + metrics.interfaces [i].rxErrors
+                tx += metrics.interfaces [i].txDrops + metrics.interfaces [i].txErrors
+            }
+            return { "rx": rx, "tx": tx }
+        }
+
+        function percent (value) {
+            return metrics.available ? value.toFixed (0) + " %" : Globals.invalidStr
+        }
+
+        Connections {
+            target: HostMetrics
+            onUpdated: host.metrics = HostMetrics.snapshot()
+        }
+
+        Label {
+            font.bold: true
+            text: qsTr ("Computer Information") + ":"
+        }
+
+        Grid {
+            columns: 2
+            Layout.fillHeight: true
+            rowSpacing: Globals.scale (1)
+            columnSpacing: Globals.spacing
+
+            Label {
+                text: qsTr ("CPU Usage")
+            }
+
+            Label {
+                text: host.percent (host.metrics.cpu)
+            }
+
+            Label {
+                text: qsTr ("I/O Wait / Steal")
+            }
+
+            Label {
+                text: host.metrics.available ?
+                          host.metrics.iowait.toFixed (0) + " / " +
+                          host.metrics.steal.toFixed (0) + " %" :
+                          Globals.invalidStr
+            }
+
+            Label {
+                text: qsTr ("RAM Usage")
+            }
+
+            Label {
+                text: host.percent (host.metrics.memoryUsage)
+            }
+
+            Label {
+                text: qsTr ("RX/TX Drops")
+            }
+
+            Label {
+                text: host.metrics.available ?
+                          host.drops.rx + " / " + host.drops.tx :
+                          Globals.invalidStr
+            }
+        }
+    }
+
+    //
+    // Another spacer
+    //
+    Item {
+        Layout.fillWidth: true
+    }
+
+    //
+    // Input-to-wire latency items (percentiles & histogram of each stage)
+    //
+    ColumnLayout {
+        id: latency
+        Layout.fillHeight: true
+        spacing: Globals.spacing
+
+        property var stages: []
+
+        function update() {
+            stages = DS.latencyStats()
+        }
+
+        function format (value) {
+            return value > 0 ? value.toFixed (2) + " ms" : Globals.invalidStr
+        }
+
+        Timer {
+            repeat: true
+            running: true
+            interval: 1000
+            onTriggered: latency.update()
+            Component.onCompleted: latency.update()
+        }
+
+        Label {
+            font.bold: true
+            text: qsTr ("Input Latency") + ":"
+        }
+
+        Grid {
+            columns: 4
+            rowSpacing: Globals.scale (1)
+            columnSpacing: Globals.spacing
+
+            Label { text: qsTr ("Stage") }
+            Label { text: qsTr ("P50") }
+            Label { text: qsTr ("P99") }
+            Label { text: qsTr ("Max") }
+
+            Repeater {
+                model: latency.stages.length * 4
+                delegate: Label {
+                    property var stage: latency.stages [Math.floor (index / 4)]
+                    text: {
+                        switch (index % 4) {
+                        case 0:
+                            return stage.name
+                        case 1:
+                            return latency.format (stage.p50)
+                        case 2:
+                            return latency.format (stage.p99)
+                        default:
+                            return latency.format (stage.maximum)
+                        }
+                    }
+                }
+            }
+        }
+
+        //
+        // Histogram of the total latency
+        //
+        Row {
+            id: histogram
+            spacing: Globals.scale (1)
+            Layout.fillHeight: true
+            Layout.minimumHeight: Globals.scale (24)
+
+            property var total: latency.stages.length > 3 ?
+                                    latency.stages [3] : undefined
+            property int peak: {
+                var max = 1
+                if (total)
+                    for (var i = 0; i < total.buckets.length; ++i)
+                        max = Math.max (max, total.buckets [i])
+                return max
+            }
+
+            Repeater {
+                model: histogram.total ? histogram.total.buckets.length : 0
+                delegate: Rectangle {
+                    width: Globals.scale (4)
+                    color: Globals.Colors.HighlightColor
+                    anchors.bottom: parent.bottom
+                    height: histogram.height * histogram.total.buckets [index] /
+                            histogram.peak
+                }
+            }
+        }
+
+        Button {
+            Layout.fillWidth: true
+            text: qsTr ("Reset")
+            onClicked: {
+                DS.resetLatencyStats()
+                latency.update()
+            }
+        }
+    }
+
+    //
+    // Last spacer
+    //
+    Item {
+        Layout.fillWidth: true
+    }
 }
@@ -42,10 +42,10 @@ Item {
         povs.model = 0
         buttons.model = 0
 
-        if (DS.joystickCount > currentJoystick) {
-            axes.model = DS.getNumAxes (currentJoystick)
-            povs.model = DS.getNumHats (currentJoystick)
-            buttons.model = DS.getNumButtons (currentJoystick)
+        if (QJoysticks.count > currentJoystick) {
+            axes.model = QJoysticks.getNumAxes (currentJoystick)
+            povs.model = QJoysticks.getNumPOVs (currentJoystick)
+            buttons.model = QJoysticks.getNumButtons (currentJoystick)
         }
     }
 
@@ -85,37 +85,12 @@ Item {
     }
 
     //
-    // Regenerate the UI when a joystick is removed or attached and
-    // update DriverStation joysticks
+    // Regenerate the UI when a joystick is removed or attached, the joystick
+    // values are sent to the DS by the C++ input bridge
     //
     Connections {
         target: QJoysticks
-
-        onCountChanged: {
-            updateControls()
-            DS.resetJoysticks()
-
-            for (var i = 0; i < QJoysticks.count; ++i) {
-                DS.addJoystick (QJoysticks.getNumAxes (i),
-                                           QJoysticks.getNumPOVs (i),
-                                           QJoysticks.getNumButtons (i))
-            }
-        }
-
-        onPovChanged: {
-            var val = QJoysticks.isBlacklisted (currentJoystick) ? 0 : angle
-            DS.setJoystickHat (js, pov, val)
-        }
-
-        onAxisChanged: {
-            var val = QJoysticks.isBlacklisted (currentJoystick) ? 0 : value
-            DS.setJoystickAxis (js, axis, val)
-        }
-
-        onButtonChanged: {
-            var val = QJoysticks.isBlacklisted (currentJoystick) ? false : pressed
-            DS.setJoystickButton (js, button, val)
-        }
+        onCountChanged: updateControls()
     }
 
     Connections {
@@ -129,13 +104,10 @@ Item {
     onCurrentJoystickChanged: joysticks.regenerateControls()
 
     //
-    // Initialize the QJoysticks system and call updateControls(), which will
-    // help us in the case that the virtual joystick is enabled
+    // Call updateControls(), which will help us in the case that the virtual
+    // joystick is enabled
     //
-    Component.onCompleted: {
-        QJoysticks.setSortJoysticksByBlacklistState (true)
-        joysticks.updateControls()
-    }
+    Component.onCompleted: joysticks.updateControls()
 
     //
     // The "No Joysticks? No Problem" widget
@@ -22,6 +22,7 @@
 
 import QtQuick 2.0
 import QtQuick.Layouts 1.0
+import QtQuick.Dialogs 1.1
 import QtQuick.Controls 1.4
 
 import "../Widgets"
@@ -31,11 +32,14 @@ ColumnLayout {
     spacing: Globals.spacing
 
     //
-    // Write to the console every time the DS receives a message
+    // Shows an informational message in the console
     //
-    Connections {
-        target: DS
-        onNewMessage: messages.editor.append (message)
+    function showInformation (text) {
+        DSNetConsole.append ("<font color=#888>** <font color=#AAA> "
+                             + qsTr ("Information")
+                             + ":</font> "
+                             + text
+                             + "</font>")
     }
 
     //
@@ -55,6 +59,23 @@ ColumnLayout {
         }
     }
 
+    //
+    // Asks the user where to save the console history
+    //
+    FileDialog {
+        id: exportDialog
+        selectExisting: false
+        title: qsTr ("Export Console Output")
+        nameFilters: [qsTr ("Text files") + " (*.txt)"]
+
+        onAccepted: {
+            if (DSNetConsole.exportToFile (fileUrl))
+                showInformation (qsTr ("Console output exported to") + " " + fileUrl)
+            else
+                showInformation (qsTr ("Cannot write to") + " " + fileUrl)
+        }
+    }
+
     //
     // Draw the action buttons
     //
@@ -72,6 +93,17 @@ ColumnLayout {
             height: Globals.spacing
         }
 
+        LineEdit {
+            Layout.fillWidth: true
+            placeholder: qsTr ("Filter") + "..."
+            onTextChanged: DSNetConsole.filter = text
+        }
+
+        Item {
+            width: Globals.spacing
+            height: Globals.spacing
+        }
+
         Button {
             icon: icons.fa_copy
             width: Globals.scale (48)
@@ -79,37 +111,96 @@ ColumnLayout {
             iconSize: Globals.scale (12)
 
             onClicked: {
-                messages.copy()
-                messages.editor.append ("<font color=#888>** <font color=#AAA> "
-                                        + qsTr ("Information")
-                                        + ":</font> "
-                                        + qsTr ("Console output copied to clipboard")
-                                        + "</font>")
+                Utilities.copy (DSNetConsole.toPlainText())
+                showInformation (qsTr ("Console output copied to clipboard"))
             }
         }
 
+        Button {
+            icon: icons.fa_save
+            width: Globals.scale (48)
+            height: Globals.scale (24)
+            iconSize: Globals.scale (12)
+            onClicked: exportDialog.open()
+        }
+
         Button {
             icon: icons.fa_trash
             width: Globals.scale (48)
             height: Globals.scale (24)
             iconSize: Globals.scale (12)
-            onClicked: messages.text = ""
+            onClicked: DSNetConsole.clear()
         }
     }
 
     //
-    // Draw the console
+    // Draw the console, only the visible messages are instantiated
     //
-    TextEditor {
-        id: messages
-        editor.readOnly: true
+    Rectangle {
         Layout.fillWidth: true
         Layout.fillHeight: true
-        editor.textFormat: Text.RichText
-        editor.font.family: Globals.monoFont
-        editor.font.pixelSize: Globals.scale (13)
-        foregroundColor: Globals.Colors.WidgetForeground
-        backgroundColor: Globals.Colors.WindowBackground
-        editor.wrapMode: TextEdit.WrapAtWordBoundaryOrAnywhere
+        border.width: Globals.scale (1)
+        color: Globals.Colors.WindowBackground
+        border.color: Globals.Colors.WidgetBorder
+
+        //
+        // Allows the scrollbar to show/hide automatically
+        //
+        MouseArea {
+            id: mouse
+            hoverEnabled: true
+            anchors.fill: parent
+            acceptedButtons: Qt.NoButton
+        }
+
+        ListView {
+            id: messages
+            clip: true
+            model: DSNetConsole
+            boundsBehavior: Flickable.StopAtBounds
+
+            //
+            // Keep showing the newest messages unless the user scrolls up
+            //
+            property bool autoscroll: true
+            onMovementEnded: autoscroll = atYEnd
+            onCountChanged: {
+                if (autoscroll)
+                    positionViewAtEnd()
+            }
+
+            anchors {
+                fill: parent
+                margins: Globals.spacing
+                rightMargin: scroll.width + Globals.spacing
+            }
+
+            delegate: Text {
+                width: messages.width
+                text: model.message
+                font.family: Globals.monoFont
+                font.pixelSize: Globals.scale (13)
+                color: Globals.Colors.WidgetForeground
+                wrapMode: Text.WrapAtWordBoundaryOrAnywhere
+                textFormat: model.richText ? Text.StyledText : Text.PlainText
+            }
+        }
+
+        Scrollbar {
+            id: scroll
+            mouseArea: mouse
+            scrollArea: messages
+            height: parent.height
+            width: opacity > 0 ? Globals.scale (8) : 0
+
+            Behavior on width {NumberAnimation{}}
+
+            anchors {
+                top: parent.top
+                right: parent.right
+                bottom: parent.bottom
+                margins: Globals.scale (6)
+            }
+        }
     }
 }
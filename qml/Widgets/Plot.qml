@@ -21,6 +21,7 @@
  */
 
 import QtQuick 2.0
+import QDriverStation 1.0
 import "../Globals.js" as Globals
 
 Rectangle {
@@ -37,9 +38,9 @@ Rectangle {
     property double rectWidth: Globals.scale (2)
 
     //
-    // Gives direct access to the canvas object
+    // Gives direct access to the item that draws the bars
     //
-    property alias canvasObject: canvas
+    property alias plotItem: bars
 
     //
     // Defines the color to use to draw the lines
@@ -54,7 +55,7 @@ Rectangle {
     property double maximumValue: 100
 
     //
-    // Emitted when the timer expires and a canvas repaint is done
+    // Emitted when the timer expires and a new bar is added
     //
     signal refreshed
 
@@ -74,18 +75,14 @@ Rectangle {
         var resetTime = width / pixelsPerSec
 
         /* Do a rule of three to obtain new refresh interval */
-        var newInterval = (seconds * refreshInterval) / resetTime
-
-        /* Apply obtained interval */
-        refreshInterval = newInterval
-        timer.interval = refreshInterval
+        refreshInterval = (seconds * refreshInterval) / resetTime
     }
 
     //
-    // Forces the canvas to clear its plot
+    // Forces the graph to clear its plot
     //
     function clear() {
-        timer.currentPos = canvas.width / rectWidth
+        bars.clear()
     }
 
     //
@@ -96,59 +93,18 @@ Rectangle {
     border.color: Globals.Colors.WidgetBorder
 
     //
-    // Refreshes the graph on real-time
-    //
-    Timer {
-        id: timer
-        interval: refreshInterval
-        Component.onCompleted: start()
-
-        property int currentPos: 0
-
-        onTriggered: {
-            if (plot.visible)
-                ++currentPos
-
-            canvas.requestPaint()
-            parent.refreshed()
-        }
-    }
-
-    //
-    // The actual canvas used to draw the graph
+    // Draws the bars and refreshes the graph on real-time
     //
-    Canvas {
-        id: canvas
+    PlotItem {
+        id: bars
+        value: plot.value
         anchors.fill: parent
-        renderStrategy: Canvas.Threaded
+        barWidth: plot.rectWidth
+        barColor: plot.barColor
+        minimumValue: plot.minimumValue
+        maximumValue: plot.maximumValue
+        refreshInterval: plot.refreshInterval
         anchors.margins: parent.border.width
-
-        onPaint: {
-            /* Lazy is good sometimes */
-            if (plot.visible) {
-                /* Get drawing context */
-                var context = getContext('2d')
-
-                /* Set the bar color */
-                context.fillStyle = barColor
-
-                /* Calculate X and Y coordinates */
-                var yOffset = (1 - getLevel()) * height
-                var xOffset = timer.currentPos * rectWidth
-
-                /* Reset the graph if it is greater than the width */
-                if (xOffset > canvas.width) {
-                    xOffset = 0
-                    timer.currentPos = 0
-                    context.clearRect (0, 0, canvas.width, canvas.height)
-                }
-
-                /* Draw a single bar */
-                context.fillRect (xOffset, yOffset, rectWidth, height)
-            }
-
-            /* Restart the timer */
-            timer.restart()
-        }
+        onRefreshed: plot.refreshed()
     }
 }
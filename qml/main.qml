@@ -71,6 +71,7 @@ Item {
     //
     MainWindow {
         id: mainwindow
+        objectName: "MainWindow"
         onVisibleChanged: {
             if (!visible)
                 Qt.quit()
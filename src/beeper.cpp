@@ -24,28 +24,23 @@
 
 /* Used for generating the sine wave and various operations */
 #include <QtMath>
-#include <QQueue>
 
 /* Used for generating the sounds */
 #include <SDL.h>
 #include <SDL_audio.h>
 
-/**
- * \brief Holds information regarding a beep/wave sound
- */
-struct BeepObject {
-    qreal frequency;
-    int samplesLeft;
-};
-
 /* Think of this as the 'volume' of the sound wave */
 const int AMPLITUDE = 16000;
 
 /* Corresponds to the freq. used in phones, we do not need more than that */
 const int SAMPLING_FREQ = 8000;
 
-/* Holds the beep objects to be processed */
-QQueue<BeepObject> BEEPS;
+/* Number of entries of the sine table (must be a power of two) */
+const int TABLE_BITS = 10;
+const int TABLE_SIZE = 1 << TABLE_BITS;
+
+/* Holds one period of the sound wave */
+static qint16 SINE_TABLE [TABLE_SIZE];
 
 /**
  * Calls the beeper when and generates the audio
@@ -57,14 +52,17 @@ void AUDIO_CALLBACK (void* beeper, quint8* stream, int length)
 }
 
 /**
- * Configures the audio spec
+ * Generates the sine table and configures the audio spec
  */
 Beeper::Beeper()
 {
-    m_angle = 0;
+    m_phase = 0;
     m_enabled = false;
+    m_current.samples = 0;
+    m_current.increment = 0;
 
-    SDL_LockAudio();
+    for (int i = 0; i < TABLE_SIZE; ++i)
+        SINE_TABLE [i] = (qint16) qRound (AMPLITUDE * qSin (2 * M_PI * i / TABLE_SIZE));
 
     /* Generate the audio configuration */
     SDL_AudioSpec desiredSpec;
@@ -89,37 +87,35 @@ Beeper::Beeper()
 Beeper::~Beeper()
 {
     SDL_CloseAudio();
-    SDL_UnlockAudio();
 }
 
+/**
+ * Fills the audio \a stream with the pending beeps (audio thread only).
+ *
+ * The phase of the wave is kept in a 32-bit accumulator, whose upper bits
+ * are used as the index of the sine table.
+ */
 void Beeper::generateSamples (qint16* stream, int length)
 {
     int i = 0;
     while (i < length) {
 
-        /* Beeps object is empty, ensure that stream has neutral values */
-        if (BEEPS.empty()) {
+        /* Get the next beep, ensure that stream has neutral values if none */
+        if (m_current.samples <= 0 && !m_commands.pop (&m_current)) {
             for (; i < length; ++i)
                 stream [i] = 0;
 
             return;
         }
 
-        /* Get the beep object */
-        BeepObject& beep = BEEPS.front();
-        int samplesToDo = qMin (i + beep.samplesLeft, length);
-        beep.samplesLeft -= samplesToDo - i;
-
         /* Generate the sound */
+        int samplesToDo = qMin (i + m_current.samples, length);
+        m_current.samples -= samplesToDo - i;
+
         for (; i < samplesToDo; ++i) {
-            m_angle += beep.frequency;
-            stream [i] = AMPLITUDE * qSin ((m_angle * 2 * M_PI) / SAMPLING_FREQ);
+            m_phase += m_current.increment;
+            stream [i] = SINE_TABLE [m_phase >> (32 - TABLE_BITS)];
         }
-
-        /* Go to next beep object */
-        if (beep.samplesLeft == 0)
-            BEEPS.pop_front();
-
     }
 }
 
@@ -133,15 +129,17 @@ void Beeper::setEnabled (bool enabled)
 
 /**
  * Generates a beep of the given \a frequency & \a duration (in milliseconds).
- * \note The request will be ignored if the beeper is disabled
+ * \note The request will be ignored if the beeper is disabled or if too many
+ *       beeps are waiting to be played
  */
 void Beeper::beep (qreal frequency, int duration)
 {
     if (m_enabled) {
-        BeepObject beep_object;
-        beep_object.frequency = frequency;
-        beep_object.samplesLeft = duration * SAMPLING_FREQ / 1000;
+        BeepCommand command;
+        command.samples = duration * SAMPLING_FREQ / 1000;
+        command.increment = (quint32) (qBound (0.0, frequency, SAMPLING_FREQ / 2.0)
+                                       * 4294967296.0 / SAMPLING_FREQ);
 
-        BEEPS.append (beep_object);
+        m_commands.push (command);
     }
 }
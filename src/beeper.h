@@ -7,9 +7,14 @@
 #define _QDS_BEEPER_H
 
 #include <QObject>
+#include "spscqueue.h"
 
 /**
  * \brief Uses SDL to generate telephone-like sound tones on the fly
+ *
+ * The beeps requested by the GUI thread are passed to the SDL audio thread
+ * through a lock-free queue, and the samples are read from a precomputed
+ * sine table, so that the audio callback never blocks nor allocates memory.
  */
 class Beeper : public QObject
 {
@@ -26,8 +31,19 @@ public slots:
     void beep (qreal frequency, int duration);
 
 private:
+    struct BeepCommand {
+        quint32 increment;
+        int samples;
+    };
+
     bool m_enabled;
-    double m_angle;
+
+    /* Owned by the audio thread */
+    quint32 m_phase;
+    BeepCommand m_current;
+
+    /* Written by the GUI thread, read by the audio thread */
+    SPSCQueue<BeepCommand, 64> m_commands;
 };
 
 #endif
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "headlessserver.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QCoreApplication>
+#include <DriverStation.h>
+
+#define LOG qDebug() << "Headless:"
+
+/* Interval (in msecs) between each telemetry event */
+#define TELEMETRY_INTERVAL 100
+
+/* Maximum length of a command line, longer lines close the connection */
+#define MAX_LINE_LENGTH (64 * 1024)
+
+/* Time (in msecs) to wait for a running instance to answer */
+#define PROBE_TIMEOUT 500
+
+/* Maximum amount of unsent data of a client, clients that do not read
+ * their data are disconnected when they reach it */
+#define MAX_PENDING_BYTES (1024 * 1024)
+
+/**
+ * Returns the name of the given control \a mode
+ */
+static QString modeName (const DriverStation::Control mode)
+{
+    switch (mode) {
+    case DriverStation::ControlTest:
+        return "test";
+    case DriverStation::ControlAutonomous:
+        return "autonomous";
+    default:
+        return "teleoperated";
+    }
+}
+
+/**
+ * Returns the names of the team stations, in the same order as the
+ * \c DriverStation::Station enum
+ */
+static QStringList stationNames()
+{
+    return QStringList() << "red1" << "red2" << "red3"
+           << "blue1" << "blue2" << "blue3";
+}
+
+/**
+ * Connects the signals of the DS and the local server
+ */
+HeadlessServer::HeadlessServer()
+{
+    connect (&m_server, SIGNAL (newConnection()),
+             this,        SLOT (acceptConnections()));
+    connect (&m_timer,  SIGNAL (timeout()),
+             this,        SLOT (sendTelemetry()));
+    connect (DriverStation::getInstance(), SIGNAL (newMessage (QString)),
+             this,                           SLOT (sendMessage (QString)));
+
+    m_timer.setInterval (TELEMETRY_INTERVAL);
+}
+
+/**
+ * Closes the server and its socket file
+ */
+HeadlessServer::~HeadlessServer()
+{
+    m_server.close();
+}
+
+/**
+ * Starts listening for clients on the local socket with the given \a name
+ * (which may also be the full path of the socket). Only the current user
+ * can connect to the socket.
+ *
+ * \returns \c true on success, \c false if the socket cannot be created
+ *          or if another instance is already listening on it
+ */
+bool HeadlessServer::listen (const QString& name)
+{
+    /* Do not steal the socket of a running instance */
+    QLocalSocket probe;
+    probe.connectToServer (name);
+    if (probe.waitForConnected (PROBE_TIMEOUT)) {
+        probe.disconnectFromServer();
+        LOG << "Another instance is already listening on" << name;
+        return false;
+    }
+
+    /* Remove the socket file left by an instance that crashed */
+    QLocalServer::removeServer (name);
+    m_server.setSocketOptions (QLocalServer::UserAccessOption);
+
+    if (!m_server.listen (name)) {
+        LOG << "Cannot listen on" << name << m_server.errorString();
+        return false;
+    }
+
+    LOG << "Listening on" << m_server.fullServerName();
+    return true;
+}
+
+/**
+ * Executes each complete line sent by the client
+ */
+void HeadlessServer::readCommands()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*> (sender());
+    if (!client)
+        return;
+
+    while (client->canReadLine()) {
+        QByteArray line = client->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        QJsonParseError error;
+        QJsonDocument document = QJsonDocument::fromJson (line, &error);
+
+        if (!document.isObject()) {
+            QJsonObject answer;
+            answer.insert ("ok", false);
+            answer.insert ("error", error.error == QJsonParseError::NoError ?
+                           QString ("Command is not an object") :
+                           error.errorString());
+            send (client, answer);
+            continue;
+        }
+
+        send (client, execute (document.object(), client));
+    }
+
+    if (client->bytesAvailable() > MAX_LINE_LENGTH) {
+        LOG << "Command too long, closing connection";
+        client->disconnectFromServer();
+    }
+}
+
+/**
+ * Forgets about the client that closed the connection
+ */
+void HeadlessServer::removeClient()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*> (sender());
+    if (!client)
+        return;
+
+    m_clients.removeAll (client);
+    m_subscribers.removeAll (client);
+    client->deleteLater();
+
+    if (m_subscribers.isEmpty())
+        m_timer.stop();
+}
+
+/**
+ * Sends the current telemetry to the subscribed clients
+ */
+void HeadlessServer::sendTelemetry()
+{
+    QJsonObject event;
+    event.insert ("event", QString ("telemetry"));
+    event.insert ("telemetry", telemetry());
+
+    foreach (QLocalSocket* client, m_subscribers)
+        send (client, event);
+}
+
+/**
+ * Registers the clients that are waiting to be accepted
+ */
+void HeadlessServer::acceptConnections()
+{
+    while (m_server.hasPendingConnections()) {
+        QLocalSocket* client = m_server.nextPendingConnection();
+
+        connect (client, SIGNAL (readyRead()),
+                 this,     SLOT (readCommands()));
+        connect (client, SIGNAL (disconnected()),
+                 this,     SLOT (removeClient()));
+
+        m_clients.append (client);
+    }
+}
+
+/**
+ * Sends the given NetConsole \a message to the subscribed clients
+ */
+void HeadlessServer::sendMessage (const QString& message)
+{
+    QJsonObject event;
+    event.insert ("event", QString ("message"));
+    event.insert ("message", message);
+
+    foreach (QLocalSocket* client, m_subscribers)
+        send (client, event);
+}
+
+/**
+ * Returns the current state of the DS and the robot
+ */
+QJsonObject HeadlessServer::telemetry() const
+{
+    DriverStation* ds = DriverStation::getInstance();
+
+    QJsonObject object;
+    object.insert ("team", ds->teamNumber());
+    object.insert ("enabled", ds->isEnabled());
+    object.insert ("estop", ds->emergencyStopped());
+    object.insert ("mode", modeName (ds->controlMode()));
+    object.insert ("station", stationNames().value (ds->teamStation()));
+    object.insert ("fmsComms", ds->connectedToFMS());
+    object.insert ("radioComms", ds->connectedToRadio());
+    object.insert ("robotComms", ds->connectedToRobot());
+    object.insert ("robotCode", ds->hasRobotCode());
+    object.insert ("voltage", ds->voltage());
+    object.insert ("cpuUsage", ds->cpuUsage());
+    object.insert ("ramUsage", ds->ramUsage());
+    object.insert ("canUsage", ds->canUsage());
+    object.insert ("diskUsage", ds->diskUsage());
+    object.insert ("packetLoss", ds->robotPacketLoss());
+    object.insert ("status", ds->generalStatus());
+
+    return object;
+}
+
+/**
+ * Executes the given \a command and returns the answer for the \a client
+ */
+QJsonObject HeadlessServer::execute (const QJsonObject& command,
+                                     QLocalSocket* client)
+{
+    DriverStation* ds = DriverStation::getInstance();
+
+    QString error;
+    QJsonObject answer;
+    QString name = command.value ("cmd").toString();
+    QJsonValue value = command.value ("value");
+
+    if (name == "enable" && value.isBool())
+        ds->setEnabled (value.toBool());
+
+    else if (name == "estop" && value.isBool())
+        ds->setEmergencyStopped (value.toBool());
+
+    else if (name == "team" && value.isDouble())
+        ds->setTeamNumber (value.toInt());
+
+    else if (name == "mode") {
+        QString mode = value.toString();
+        if (mode == "test")
+            ds->setControlMode (DriverStation::ControlTest);
+        else if (mode == "autonomous")
+            ds->setControlMode (DriverStation::ControlAutonomous);
+        else if (mode == "teleoperated")
+            ds->setControlMode (DriverStation::ControlTeleoperated);
+        else
+            error = "Unknown mode";
+    }
+
+    else if (name == "station") {
+        int station = stationNames().indexOf (value.toString());
+        if (station >= 0)
+            ds->setTeamStation ((DriverStation::Station) station);
+        else
+            error = "Unknown station";
+    }
+
+    else if (name == "subscribe") {
+        m_subscribers.removeAll (client);
+        if (value.toBool (true))
+            m_subscribers.append (client);
+
+        if (m_subscribers.isEmpty())
+            m_timer.stop();
+        else if (!m_timer.isActive())
+            m_timer.start();
+    }
+
+    else if (name == "status")
+        answer.insert ("telemetry", telemetry());
+
+    else if (name == "quit")
+        QTimer::singleShot (0, qApp, SLOT (quit()));
+
+    else if (name == "enable" || name == "estop" || name == "team")
+        error = "Invalid value";
+
+    else
+        error = "Unknown command";
+
+    if (command.contains ("id"))
+        answer.insert ("id", command.value ("id"));
+
+    answer.insert ("ok", error.isEmpty());
+    if (!error.isEmpty())
+        answer.insert ("error", error);
+
+    return answer;
+}
+
+/**
+ * Writes the given \a object to the \a client as a single line. If the
+ * client does not read its data, it is disconnected once it has more than
+ * \c MAX_PENDING_BYTES waiting to be sent.
+ */
+void HeadlessServer::send (QLocalSocket* client, const QJsonObject& object)
+{
+    if (!m_clients.contains (client))
+        return;
+
+    if (client->bytesToWrite() > MAX_PENDING_BYTES) {
+        LOG << "Client is not reading its data, closing connection";
+
+        m_clients.removeAll (client);
+        m_subscribers.removeAll (client);
+        if (m_subscribers.isEmpty())
+            m_timer.stop();
+
+        client->disconnect (this);
+        client->abort();
+        client->deleteLater();
+        return;
+    }
+
+    client->write (QJsonDocument (object).toJson (QJsonDocument::Compact));
+    client->write ("\n");
+}
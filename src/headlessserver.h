@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QDS_HEADLESS_SERVER_H
+#define _QDS_HEADLESS_SERVER_H
+
+#include <QList>
+#include <QTimer>
+#include <QObject>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+/**
+ * \brief Controls the DS through a local socket when running headless
+ *
+ * Clients send one JSON object per line, with the command name in the
+ * \c cmd field and its argument in the \c value field:
+ *
+ * - \c enable (bool), \c estop (bool)
+ * - \c mode (\c "test", \c "autonomous" or \c "teleoperated")
+ * - \c team (number)
+ * - \c station (\c "red1" to \c "red3" or \c "blue1" to \c "blue3")
+ * - \c subscribe (bool), starts or stops sending telemetry to the client
+ * - \c status, returns the current telemetry
+ * - \c quit, closes the application
+ *
+ * Each command is answered with an object whose \c ok field tells if the
+ * command was accepted (and \c error explains why not). The \c id field of
+ * the command, if any, is copied to the answer.
+ *
+ * Subscribed clients receive a \c telemetry event every 100 ms and a
+ * \c message event for each NetConsole message. Clients that do not read
+ * their data are disconnected (the server does not queue it forever).
+ */
+class HeadlessServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessServer();
+    ~HeadlessServer();
+
+    bool listen (const QString& name);
+
+private slots:
+    void readCommands();
+    void removeClient();
+    void sendTelemetry();
+    void acceptConnections();
+    void sendMessage (const QString& message);
+
+private:
+    QJsonObject telemetry() const;
+    QJsonObject execute (const QJsonObject& command, QLocalSocket* client);
+    void send (QLocalSocket* client, const QJsonObject& object);
+
+private:
+    QTimer m_timer;
+    QLocalServer m_server;
+    QList<QLocalSocket*> m_clients;
+    QList<QLocalSocket*> m_subscribers;
+};
+
+#endif
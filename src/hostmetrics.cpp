@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "hostmetrics.h"
+
+#include <QVariantList>
+
+#if defined Q_OS_LINUX
+    #include <fcntl.h>
+    #include <string.h>
+    #include <unistd.h>
+#endif
+
+/* Interval (in msecs) between each sample */
+#define SAMPLE_INTERVAL 1000
+
+/* Size of the buffer used to read the kernel files */
+#define BUFFER_SIZE (64 * 1024)
+
+//------------------------------------------------------------------------------
+// Scanner functions
+//------------------------------------------------------------------------------
+
+/**
+ * Moves \a ptr to the next character that is not a space or a tab
+ */
+static inline const char* skipSpaces (const char* ptr, const char* end)
+{
+    while (ptr < end && (*ptr == ' ' || *ptr == '\t'))
+        ++ptr;
+
+    return ptr;
+}
+
+/**
+ * Moves \a ptr to the beginning of the next line
+ */
+static inline const char* nextLine (const char* ptr, const char* end)
+{
+    while (ptr < end && *ptr != '\n')
+        ++ptr;
+
+    return ptr < end ? ptr + 1 : end;
+}
+
+/**
+ * Parses the unsigned number at \a ptr and moves \a ptr after it
+ */
+static inline quint64 parseNumber (const char** ptr, const char* end)
+{
+    quint64 value = 0;
+    const char* p = skipSpaces (*ptr, end);
+
+    while (p < end && *p >= '0' && *p <= '9')
+        value = (value * 10) + (quint64) (*p++ - '0');
+
+    *ptr = p;
+    return value;
+}
+
+/**
+ * Returns \c true if the line at \a ptr begins with the given \a prefix
+ */
+static inline bool startsWith (const char* ptr, const char* end,
+                               const char* prefix, const int length)
+{
+    return (end - ptr) >= length && memcmp (ptr, prefix, length) == 0;
+}
+
+//------------------------------------------------------------------------------
+// Start class code
+//------------------------------------------------------------------------------
+
+/**
+ * Opens the kernel files and starts the sampling timer
+ */
+HostMetrics::HostMetrics()
+{
+    m_memFd = -1;
+    m_netFd = -1;
+    m_statFd = -1;
+    m_memTotal = 0;
+    m_memAvailable = 0;
+    m_interval = SAMPLE_INTERVAL / 1000.0;
+    memset (&m_total, 0, sizeof (m_total));
+
+#if defined Q_OS_LINUX
+    m_memFd = open ("/proc/meminfo", O_RDONLY | O_CLOEXEC);
+    m_netFd = open ("/proc/net/dev", O_RDONLY | O_CLOEXEC);
+    m_statFd = open ("/proc/stat", O_RDONLY | O_CLOEXEC);
+    m_buffer.resize (BUFFER_SIZE);
+#endif
+
+    if (isAvailable()) {
+        update();
+        connect (&m_timer, SIGNAL (timeout()), this, SLOT (update()));
+        m_timer.start (SAMPLE_INTERVAL);
+    }
+}
+
+/**
+ * Closes the kernel files
+ */
+HostMetrics::~HostMetrics()
+{
+#if defined Q_OS_LINUX
+    if (m_memFd >= 0)
+        close (m_memFd);
+    if (m_netFd >= 0)
+        close (m_netFd);
+    if (m_statFd >= 0)
+        close (m_statFd);
+#endif
+}
+
+/**
+ * Returns the only instance of this class
+ */
+HostMetrics* HostMetrics::getInstance()
+{
+    static HostMetrics instance;
+    return &instance;
+}
+
+/**
+ * Returns \c true if the metrics can be sampled in this operating system
+ */
+bool HostMetrics::isAvailable() const
+{
+    return m_statFd >= 0;
+}
+
+/**
+ * Returns the total CPU usage (from 0 to 100)
+ */
+int HostMetrics::cpuUsage() const
+{
+    return qRound (m_total.usage);
+}
+
+/**
+ * Returns the usage of all the CPU cores
+ */
+const HostMetrics::Cpu& HostMetrics::totalCpu() const
+{
+    return m_total;
+}
+
+/**
+ * Returns the usage of each CPU core
+ */
+const QVector<HostMetrics::Cpu>& HostMetrics::cores() const
+{
+    return m_cores;
+}
+
+/**
+ * Returns the counters of each network interface (except the loopback)
+ */
+const QVector<HostMetrics::Interface>& HostMetrics::interfaces() const
+{
+    return m_interfaces;
+}
+
+/**
+ * Returns the latest sample as a map, which contains:
+ *
+ * - \c cpu, \c iowait, \c steal: total CPU usage (from 0 to 100)
+ * - \c cores: list with the usage of each core (from 0 to 100)
+ * - \c memoryTotal, \c memoryAvailable: memory (in KiB)
+ * - \c memoryUsage: used memory (from 0 to 100)
+ * - \c interfaces: list of maps with the \c name of each network interface,
+ *   its \c rxRate and \c txRate (bytes/second) and the \c rxDrops,
+ *   \c txDrops, \c rxErrors and \c txErrors of the last interval
+ */
+QVariantMap HostMetrics::snapshot() const
+{
+    QVariantMap map;
+    QVariantList cores;
+    QVariantList interfaces;
+
+    foreach (const Cpu& core, m_cores)
+        cores.append (core.usage);
+
+    foreach (const Interface& iface, m_interfaces) {
+        QVariantMap item;
+        item.insert ("name", QString::fromLatin1 (iface.name));
+        item.insert ("rxRate", iface.rxBytesDelta / m_interval);
+        item.insert ("txRate", iface.txBytesDelta / m_interval);
+        item.insert ("rxDrops", iface.rxDropsDelta);
+        item.insert ("txDrops", iface.txDropsDelta);
+        item.insert ("rxErrors", iface.rxErrorsDelta);
+        item.insert ("txErrors", iface.txErrorsDelta);
+        interfaces.append (item);
+    }
+
+    map.insert ("available", isAvailable());
+    map.insert ("cpu", m_total.usage);
+    map.insert ("iowait", m_total.iowaitUsage);
+    map.insert ("steal", m_total.stealUsage);
+    map.insert ("cores", cores);
+    map.insert ("memoryTotal", m_memTotal);
+    map.insert ("memoryAvailable", m_memAvailable);
+    map.insert ("memoryUsage", m_memTotal > 0 ?
+                100.0 * (m_memTotal - m_memAvailable) / m_memTotal : 0);
+    map.insert ("interfaces", interfaces);
+
+    return map;
+}
+
+/**
+ * Samples all the metrics and notifies the rest of the application
+ */
+void HostMetrics::update()
+{
+    readCpu();
+    readMemory();
+    readNetwork();
+
+    emit updated();
+}
+
+/**
+ * Parses the \c cpu lines of \c /proc/stat
+ */
+void HostMetrics::readCpu()
+{
+    int length = read (m_statFd);
+    const char* ptr = m_buffer.constData();
+    const char* end = ptr + length;
+
+    int core = 0;
+    while (ptr < end && startsWith (ptr, end, "cpu", 3)) {
+        ptr += 3;
+
+        /* Get the core number ("cpu" alone is the total) */
+        bool total = (ptr < end && (*ptr == ' '));
+        if (!total)
+            parseNumber (&ptr, end);
+
+        /* Read user, nice, system, idle, iowait, irq, softirq and steal */
+        quint64 fields [8];
+        for (int i = 0; i < 8; ++i)
+            fields [i] = parseNumber (&ptr, end);
+
+        if (total)
+            updateCpu (&m_total, fields, 8);
+
+        else {
+            if (core >= m_cores.count()) {
+                Cpu cpu;
+                memset (&cpu, 0, sizeof (cpu));
+                m_cores.append (cpu);
+            }
+
+            updateCpu (&m_cores [core], fields, 8);
+            ++core;
+        }
+
+        ptr = nextLine (ptr, end);
+    }
+
+    /* Some cores were disabled */
+    if (core > 0 && core < m_cores.count())
+        m_cores.resize (core);
+}
+
+/**
+ * Parses the \c MemTotal and \c MemAvailable lines of \c /proc/meminfo
+ */
+void HostMetrics::readMemory()
+{
+    int length = read (m_memFd);
+    const char* ptr = m_buffer.constData();
+    const char* end = ptr + length;
+
+    while (ptr < end) {
+        if (startsWith (ptr, end, "MemTotal:", 9)) {
+            ptr += 9;
+            m_memTotal = parseNumber (&ptr, end);
+        }
+
+        else if (startsWith (ptr, end, "MemAvailable:", 13)) {
+            ptr += 13;
+            m_memAvailable = parseNumber (&ptr, end);
+            break;
+        }
+
+        ptr = nextLine (ptr, end);
+    }
+}
+
+/**
+ * Parses the interface counters of \c /proc/net/dev
+ */
+void HostMetrics::readNetwork()
+{
+    int length = read (m_netFd);
+    const char* ptr = m_buffer.constData();
+    const char* end = ptr + length;
+
+    for (int i = 0; i < m_interfaces.count(); ++i)
+        m_interfaces [i].present = false;
+
+    /* Skip the two header lines */
+    ptr = nextLine (nextLine (ptr, end), end);
+
+    while (ptr < end) {
+        /* Get the interface name */
+        const char* name = skipSpaces (ptr, end);
+        const char* colon = name;
+        while (colon < end && *colon != ':' && *colon != '\n')
+            ++colon;
+
+        if (colon >= end || *colon != ':') {
+            ptr = nextLine (colon, end);
+            continue;
+        }
+
+        /* Read the 16 counters of the interface */
+        quint64 fields [16];
+        ptr = colon + 1;
+        for (int i = 0; i < 16; ++i)
+            fields [i] = parseNumber (&ptr, end);
+
+        ptr = nextLine (ptr, end);
+
+        /* Ignore the loopback interface */
+        int nameLength = colon - name;
+        if (nameLength == 2 && memcmp (name, "lo", 2) == 0)
+            continue;
+
+        /* Find the interface (or register it) */
+        Interface* iface = Q_NULLPTR;
+        for (int i = 0; i < m_interfaces.count(); ++i) {
+            const QByteArray& n = m_interfaces.at (i).name;
+            if (n.length() == nameLength && memcmp (n.constData(), name, nameLength) == 0) {
+                iface = &m_interfaces [i];
+                break;
+            }
+        }
+
+        bool first = (iface == Q_NULLPTR);
+        if (first) {
+            Interface newInterface;
+            newInterface.rxBytes = 0;
+            newInterface.txBytes = 0;
+            newInterface.rxDrops = 0;
+            newInterface.txDrops = 0;
+            newInterface.rxErrors = 0;
+            newInterface.txErrors = 0;
+            newInterface.name = QByteArray (name, nameLength);
+            m_interfaces.append (newInterface);
+            iface = &m_interfaces.last();
+        }
+
+        /* Calculate the deltas (counters may be reset by the driver) */
+        quint64 rxBytes = fields [0];
+        quint64 rxErrors = fields [2];
+        quint64 rxDrops = fields [3];
+        quint64 txBytes = fields [8];
+        quint64 txErrors = fields [10];
+        quint64 txDrops = fields [11];
+
+#define DELTA(now, past) (!first && (now) >= (past) ? (now) - (past) : 0)
+        iface->rxBytesDelta = DELTA (rxBytes, iface->rxBytes);
+        iface->txBytesDelta = DELTA (txBytes, iface->txBytes);
+        iface->rxDropsDelta = DELTA (rxDrops, iface->rxDrops);
+        iface->txDropsDelta = DELTA (txDrops, iface->txDrops);
+        iface->rxErrorsDelta = DELTA (rxErrors, iface->rxErrors);
+        iface->txErrorsDelta = DELTA (txErrors, iface->txErrors);
+#undef DELTA
+
+        iface->rxBytes = rxBytes;
+        iface->txBytes = txBytes;
+        iface->rxDrops = rxDrops;
+        iface->txDrops = txDrops;
+        iface->rxErrors = rxErrors;
+        iface->txErrors = txErrors;
+        iface->present = true;
+    }
+
+    /* Remove the interfaces that are gone */
+    for (int i = m_interfaces.count() - 1; i >= 0; --i) {
+        if (!m_interfaces.at (i).present)
+            m_interfaces.remove (i);
+    }
+}
+
+/**
+ * Reads the kernel file referenced by \a fd from the beginning into the
+ * buffer and returns the number of bytes read. The \c /proc files return
+ * about one page per read, so we keep reading until the end of the file
+ * (the buffer grows if the file does not fit in it).
+ */
+int HostMetrics::read (const int fd)
+{
+#if defined Q_OS_LINUX
+    if (fd >= 0) {
+        int length = 0;
+        forever {
+            if (length == m_buffer.size())
+                m_buffer.resize (m_buffer.size() * 2);
+
+            int bytes = pread (fd, m_buffer.data() + length,
+                               m_buffer.size() - length, length);
+            if (bytes <= 0)
+                break;
+
+            length += bytes;
+        }
+
+        return length;
+    }
+#else
+    Q_UNUSED (fd);
+#endif
+
+    return 0;
+}
+
+/**
+ * Calculates the usage of the given \a cpu from the new jiffy \a fields
+ * (user, nice, system, idle, iowait, irq, softirq and steal)
+ */
+void HostMetrics::updateCpu (Cpu* cpu, const quint64* fields, const int count)
+{
+    quint64 total = 0;
+    for (int i = 0; i < count; ++i)
+        total += fields [i];
+
+    quint64 idle = fields [3] + fields [4];
+    quint64 busy = total - idle;
+
+    /* The iowait counter of a core can go backwards, ignore those samples */
+    quint64 totalDelta = total - cpu->total;
+    if (cpu->total > 0 && total > cpu->total) {
+        if (busy >= cpu->busy)
+            cpu->usage = 100.0 * (busy - cpu->busy) / totalDelta;
+        if (fields [4] >= cpu->iowait)
+            cpu->iowaitUsage = 100.0 * (fields [4] - cpu->iowait) / totalDelta;
+        if (fields [7] >= cpu->steal)
+            cpu->stealUsage = 100.0 * (fields [7] - cpu->steal) / totalDelta;
+    }
+
+    cpu->busy = busy;
+    cpu->total = total;
+    cpu->iowait = fields [4];
+    cpu->steal = fields [7];
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QDS_HOST_METRICS_H
+#define _QDS_HOST_METRICS_H
+
+#include <QTimer>
+#include <QObject>
+#include <QVector>
+#include <QVariantMap>
+
+/**
+ * \brief Samples the CPU, memory and network usage of the computer
+ *
+ * The kernel files (\c /proc/stat, \c /proc/meminfo and \c /proc/net/dev)
+ * are opened once and parsed in a fixed buffer every second, without
+ * allocating memory (unless a CPU core or network interface appears).
+ *
+ * The results are shared by the \c Utilities class (for the CPU usage) and
+ * the QML interface, which can obtain all the values with \c snapshot().
+ *
+ * \note Only Linux is supported for the moment, on other operating systems
+ *       \c isAvailable() returns \c false
+ */
+class HostMetrics : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void updated();
+
+public:
+    static HostMetrics* getInstance();
+
+    struct Cpu {
+        quint64 busy;
+        quint64 total;
+        quint64 iowait;
+        quint64 steal;
+        qreal usage;
+        qreal iowaitUsage;
+        qreal stealUsage;
+    };
+
+    struct Interface {
+        QByteArray name;
+        quint64 rxBytes;
+        quint64 txBytes;
+        quint64 rxDrops;
+        quint64 txDrops;
+        quint64 rxErrors;
+        quint64 txErrors;
+        quint64 rxBytesDelta;
+        quint64 txBytesDelta;
+        quint64 rxDropsDelta;
+        quint64 txDropsDelta;
+        quint64 rxErrorsDelta;
+        quint64 txErrorsDelta;
+        bool present;
+    };
+
+    bool isAvailable() const;
+    int cpuUsage() const;
+
+    const Cpu& totalCpu() const;
+    const QVector<Cpu>& cores() const;
+    const QVector<Interface>& interfaces() const;
+
+    Q_INVOKABLE QVariantMap snapshot() const;
+
+private slots:
+    void update();
+
+private:
+    HostMetrics();
+    ~HostMetrics();
+
+    void readCpu();
+    void readMemory();
+    void readNetwork();
+    int read (const int fd);
+
+    static void updateCpu (Cpu* cpu, const quint64* fields, const int count);
+
+private:
+    int m_statFd;
+    int m_memFd;
+    int m_netFd;
+
+    qreal m_interval;
+    quint64 m_memTotal;
+    quint64 m_memAvailable;
+
+    Cpu m_total;
+    QTimer m_timer;
+    QByteArray m_buffer;
+    QVector<Cpu> m_cores;
+    QVector<Interface> m_interfaces;
+};
+
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "inputbridge.h"
+
+#include <QSet>
+#include <QMutexLocker>
+#include <DriverStation.h>
+#include <DS_Latency.h>
+#include <DS_Joysticks.h>
+
+/**
+ * Connects the \c QJoysticks signals and registers the joysticks that are
+ * already attached.
+ *
+ * \note This object must be created after the DS has been started
+ */
+InputBridge::InputBridge()
+{
+    m_joysticks = QJoysticks::getInstance();
+    m_joysticks->setSortJoysticksByBlacklistState (true);
+
+    connect (m_joysticks, &QJoysticks::countChanged,
+             this,        &InputBridge::updateSlots);
+    connect (m_joysticks, &QJoysticks::POVEvent,
+             this,        &InputBridge::onPOVEvent,
+             Qt::DirectConnection);
+    connect (m_joysticks, &QJoysticks::axisEvent,
+             this,        &InputBridge::onAxisEvent,
+             Qt::DirectConnection);
+    connect (m_joysticks, &QJoysticks::buttonEvent,
+             this,        &InputBridge::onButtonEvent,
+             Qt::DirectConnection);
+
+    updateSlots();
+}
+
+/**
+ * Compares the \c QJoysticks devices with the DS slots and only registers
+ * or removes the joysticks that were attached, removed or (un)blacklisted
+ */
+void InputBridge::updateSlots()
+{
+    DriverStation* ds = DriverStation::getInstance();
+    QMutexLocker locker (&m_mutex);
+
+    /* Get the joysticks that should have a slot */
+    QList<QJoystickDevice*> devices;
+    foreach (QJoystickDevice* device, m_joysticks->inputDevices()) {
+        if (!device->blacklisted)
+            devices.append (device);
+    }
+
+    /* Free the slots of removed or blacklisted joysticks */
+    QSet<QJoystickDevice*> current = devices.toSet();
+    for (int i = 0; i < m_slots.count(); ++i) {
+        if (m_slots.at (i).device && !current.contains (m_slots.at (i).device)) {
+            m_deviceSlots.remove (m_slots.at (i).device);
+            m_slots [i].device = Q_NULLPTR;
+            ds->removeJoystick (i);
+        }
+    }
+
+    /* Assign a slot to the new joysticks */
+    foreach (QJoystickDevice* device, devices) {
+        if (m_deviceSlots.contains (device))
+            continue;
+
+        int slot = findSlot (device);
+        if (slot == m_slots.count())
+            m_slots.append (Slot());
+
+        m_slots [slot].guid = device->guid;
+        m_slots [slot].device = device;
+        m_deviceSlots.insert (device, slot);
+
+        ds->setJoystick (slot,
+                         device->axes.count(),
+                         device->povs.count(),
+                         device->buttons.count());
+    }
+}
+
+/**
+ * Returns the slot for the given \a device, in order of preference:
+ *
+ * - A free slot that was used by a joystick with the same GUID
+ * - A slot that was never used
+ * - Any free slot
+ * - A new slot at the end of the list
+ */
+int InputBridge::findSlot (const QJoystickDevice* device) const
+{
+    int unused = -1;
+    int free = -1;
+
+    for (int i = 0; i < m_slots.count(); ++i) {
+        const Slot& slot = m_slots.at (i);
+        if (slot.device)
+            continue;
+
+        if (slot.guid == device->guid)
+            return i;
+
+        if (unused < 0 && slot.guid.isEmpty())
+            unused = i;
+
+        if (free < 0)
+            free = i;
+    }
+
+    if (unused >= 0)
+        return unused;
+
+    if (free >= 0)
+        return free;
+
+    return m_slots.count();
+}
+
+/**
+ * Registers the latency of an input event with the given \a timestamp
+ * (given by the \c QJoysticks clock) with the LibDS
+ */
+void InputBridge::registerLatency (const qint64 timestamp)
+{
+    qint64 age = QJoysticksTimestamp() - timestamp;
+    DS_LatencyInput (DS_LatencyNow() - age);
+}
+
+/**
+ * Updates the hat of the joystick referenced by the \a event (if the
+ * joystick has a DS slot)
+ */
+void InputBridge::onPOVEvent (const QJoystickPOVEvent& event)
+{
+    QMutexLocker locker (&m_mutex);
+    int slot = m_deviceSlots.value (event.joystick, -1);
+    if (slot >= 0) {
+        DS_SetJoystickHat (slot, event.pov, event.angle);
+        registerLatency (event.timestamp);
+    }
+}
+
+/**
+ * Updates the axis of the joystick referenced by the \a event (if the
+ * joystick has a DS slot)
+ */
+void InputBridge::onAxisEvent (const QJoystickAxisEvent& event)
+{
+    QMutexLocker locker (&m_mutex);
+    int slot = m_deviceSlots.value (event.joystick, -1);
+    if (slot >= 0) {
+        DS_SetJoystickAxis (slot, event.axis, event.value);
+        registerLatency (event.timestamp);
+    }
+}
+
+/**
+ * Updates the button of the joystick referenced by the \a event (if the
+ * joystick has a DS slot)
+ */
+void InputBridge::onButtonEvent (const QJoystickButtonEvent& event)
+{
+    QMutexLocker locker (&m_mutex);
+    int slot = m_deviceSlots.value (event.joystick, -1);
+    if (slot >= 0) {
+        DS_SetJoystickButton (slot, event.button, event.pressed);
+        registerLatency (event.timestamp);
+    }
+}
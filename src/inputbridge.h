@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QDS_INPUT_BRIDGE_H
+#define _QDS_INPUT_BRIDGE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <QObject>
+#include <QJoysticks.h>
+
+/**
+ * \brief Feeds the joystick values from \c QJoysticks to the LibDS
+ *
+ * The joystick events are forwarded directly to the \c DS_SetJoystick*()
+ * functions, applying the blacklist and the joystick indexes of the
+ * \c QJoysticks system. The QML interface is only used to display the
+ * joystick values.
+ *
+ * Each joystick is assigned a DS slot when it is attached. The slot is
+ * kept for the GUID of the joystick when it is removed, so that it gets
+ * the same slot if it is attached again, and attaching or removing a
+ * joystick does not change the slots of the other joysticks. Blacklisted
+ * joysticks are not assigned a slot.
+ *
+ * The input events of the SDL joysticks are received directly from the
+ * \c QJoysticks dispatch thread, so feeding the DS does not wait for the
+ * GUI thread. The slots are updated from the GUI thread.
+ */
+class InputBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputBridge();
+
+private slots:
+    void updateSlots();
+    void onPOVEvent (const QJoystickPOVEvent& event);
+    void onAxisEvent (const QJoystickAxisEvent& event);
+    void onButtonEvent (const QJoystickButtonEvent& event);
+
+private:
+    struct Slot {
+        QString guid;
+        QJoystickDevice* device;
+    };
+
+    int findSlot (const QJoystickDevice* device) const;
+    void registerLatency (const qint64 timestamp);
+
+private:
+    QMutex m_mutex;
+    QJoysticks* m_joysticks;
+    QVector<Slot> m_slots;
+    QHash<const QJoystickDevice*, int> m_deviceSlots;
+};
+
+#endif
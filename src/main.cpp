@@ -26,9 +26,11 @@
 
 #include <QTime>
 #include <QtQml>
+#include <QUdpSocket>
 #include <iostream>
 #include <QApplication>
 #include <QJoysticks.h>
+#include <QQuickWindow>
 #include <QDesktopServices>
 #include <QQmlApplicationEngine>
 
@@ -39,6 +41,8 @@
 #include <stdio.h>
 #include <EventLogger.h>
 #include <DriverStation.h>
+#include <TelemetryModel.h>
+#include <NetConsoleModel.h>
 
 //------------------------------------------------------------------------------
 // Application includes
@@ -46,9 +50,13 @@
 
 #include "beeper.h"
 #include "versions.h"
+#include "inputbridge.h"
 #include "shortcuts.h"
 #include "utilities.h"
 #include "dashboards.h"
+#include "plotitem.h"
+#include "hostmetrics.h"
+#include "headlessserver.h"
 
 //------------------------------------------------------------------------------
 // Mac-specific initialization code
@@ -77,7 +85,19 @@ const QString HELP = "Usage: qdriverstation [ options ... ]                 \n"
                      "    -r, --reset     Reset/clear the settings          \n"
                      "    -c, --contact   Contact the lead developer        \n"
                      "    -v, --version   Display the application version   \n"
-                     "    -w, --website   Open a web site of this project   \n";
+                     "    -w, --website   Open a web site of this project   \n"
+                     "    --headless [socket]                               \n"
+                     "                    Run without UI, controlled through\n"
+                     "                    a local socket (JSON lines)       \n"
+                     "                                                      \n"
+                     "Headless options:                                     \n"
+                     "    --protocol <2014|2015|2016>                       \n"
+                     "                    Protocol to use (default: 2016)   \n"
+                     "    --port-offset <n>                                 \n"
+                     "                    Add n to the ports that the DS    \n"
+                     "                    listens on (for several instances)\n"
+                     "    --robot-address <address>                         \n"
+                     "                    Use a custom robot address        \n";
 
 //------------------------------------------------------------------------------
 // Download joystick drivers if needed
@@ -157,6 +177,103 @@ static void showVersion()
     qDebug() << author.toStdString().c_str();
 }
 
+//------------------------------------------------------------------------------
+// Headless mode
+//------------------------------------------------------------------------------
+
+/**
+ * Returns the value given to the command line \a option, or \a fallback
+ * if the option is not present
+ */
+static QString optionValue (const QStringList& arguments,
+                            const QString& option,
+                            const QString& fallback = QString())
+{
+    int index = arguments.indexOf (option);
+    if (index >= 0 && index + 1 < arguments.count())
+        return arguments.at (index + 1);
+
+    return fallback;
+}
+
+/**
+ * Returns \c true if no other process listens on the given UDP \a ports.
+ * The DS sockets share their ports (\c SO_REUSEPORT), so another instance
+ * would silently receive half of the robot packets.
+ */
+static bool portsAvailable (const QList<int>& ports)
+{
+    foreach (int port, ports) {
+        QUdpSocket probe;
+        if (!probe.bind (QHostAddress::Any, port, QUdpSocket::DontShareAddress)) {
+            qWarning() << "Headless: Port" << port << "is already in use,"
+                       << "use --port-offset to run several instances";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int runHeadless (int argc, char* argv[])
+{
+    QCoreApplication app (argc, argv);
+
+    /* Get the name of the control socket */
+    QString name = "qdriverstation";
+    QStringList arguments = app.arguments();
+    int index = arguments.indexOf ("--headless");
+    if (index + 1 < arguments.count() && !arguments.at (index + 1).startsWith ("-"))
+        name = arguments.at (index + 1);
+
+    /* Get the protocol and the network options of this instance */
+    DriverStation::Protocol protocol = DriverStation::Protocol2016;
+    QString protocolName = optionValue (arguments, "--protocol", "2016");
+    if (protocolName == "2015")
+        protocol = DriverStation::Protocol2015;
+    else if (protocolName == "2014")
+        protocol = DriverStation::Protocol2014;
+    else if (protocolName != "2016") {
+        showHelp();
+        return EXIT_FAILURE;
+    }
+
+    bool validOffset = true;
+    int offset = optionValue (arguments, "--port-offset", "0").toInt (&validOffset);
+    if (!validOffset || offset < 0 || offset > 50000) {
+        showHelp();
+        return EXIT_FAILURE;
+    }
+
+    /* Refuse to share the DS ports with another process */
+    DriverStation* ds = DriverStation::getInstance();
+    ds->setPortOffset (offset);
+    if (!portsAvailable (ds->inputPorts (protocol)))
+        return EXIT_FAILURE;
+
+    /* Install the LibDS event logger */
+    DSEventLogger* dslogger = DSEventLogger::getInstance();
+    qInstallMessageHandler (dslogger->messageHandler);
+
+    /* Start the DS and feed the joystick values to it */
+    QJoysticks::getInstance();
+    ds->start();
+    InputBridge inputBridge;
+
+    /* Start the control server */
+    HeadlessServer server;
+    if (!server.listen (name))
+        return EXIT_FAILURE;
+
+    /* Load the protocol (after the socket, so that a second instance with
+     * the same socket does not touch the network) */
+    ds->setProtocol (protocol);
+    if (arguments.contains ("--robot-address"))
+        ds->setCustomRobotAddress (optionValue (arguments, "--robot-address"));
+
+    return app.exec();
+}
+
 //------------------------------------------------------------------------------
 // Application init
 //------------------------------------------------------------------------------
@@ -178,6 +295,12 @@ int main (int argc, char* argv[])
     QApplication::setApplicationVersion (APP_VERSION);
     QApplication::setOrganizationDomain (APP_WEBSITE);
 
+    /* Run without the QML interface */
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp (argv [i], "--headless") == 0)
+            return runHeadless (argc, argv);
+    }
+
     /* Initialize application */
     QString arguments;
     QApplication app (argc, argv);
@@ -236,7 +359,10 @@ int main (int argc, char* argv[])
     Utilities utilities;
     Shortcuts shortcuts;
     Dashboards dashboards;
+    DSTelemetryModel telemetry;
+    DSNetConsoleModel netconsole;
     QJoysticks* qjoysticks = QJoysticks::getInstance();
+    HostMetrics* hostmetrics = HostMetrics::getInstance();
     DriverStation* driverstation = DriverStation::getInstance();
 
     /* Configure the shortcuts handler and start the DS */
@@ -244,6 +370,12 @@ int main (int argc, char* argv[])
     driverstation->declareQML();
     driverstation->start();
 
+    /* Feed the joystick values to the DS */
+    InputBridge inputBridge;
+
+    /* Register the QML items implemented in C++ */
+    qmlRegisterType<PlotItem> ("QDriverStation", 1, 0, "PlotItem");
+
     /* Load the QML interface */
     QQmlApplicationEngine engine;
     engine.rootContext()->setContextProperty ("cIsMac",        isMac);
@@ -252,12 +384,15 @@ int main (int argc, char* argv[])
     engine.rootContext()->setContextProperty ("Beeper",        &beeper);
     engine.rootContext()->setContextProperty ("QJoysticks",    qjoysticks);
     engine.rootContext()->setContextProperty ("Utilities",     &utilities);
+    engine.rootContext()->setContextProperty ("HostMetrics",   hostmetrics);
     engine.rootContext()->setContextProperty ("cDashboard",    &dashboards);
     engine.rootContext()->setContextProperty ("appDspName",    APP_DSPNAME);
     engine.rootContext()->setContextProperty ("appVersion",    APP_VERSION);
     engine.rootContext()->setContextProperty ("appWebsite",    APP_WEBSITE);
     engine.rootContext()->setContextProperty ("appRepBugs",    APP_REPBUGS);
     engine.rootContext()->setContextProperty ("DSLogger",      dslogger);
+    engine.rootContext()->setContextProperty ("DSTelemetry",   &telemetry);
+    engine.rootContext()->setContextProperty ("DSNetConsole",  &netconsole);
     engine.rootContext()->setContextProperty ("DS",            driverstation);
     engine.load (QUrl (QStringLiteral ("qrc:/qml/main.qml")));
 
@@ -265,6 +400,20 @@ int main (int argc, char* argv[])
     if (engine.rootObjects().isEmpty())
         return EXIT_FAILURE;
 
+    /* Publish the DS telemetry changes once per rendered frame */
+#if QT_VERSION >= QT_VERSION_CHECK (5, 3, 0)
+    QObject* root = engine.rootObjects().first();
+    QQuickWindow* window = root->findChild<QQuickWindow*> ("MainWindow");
+    if (window) {
+        QObject::connect (window,        SIGNAL (afterAnimating()),
+                          driverstation,   SLOT (publishChanges()));
+        QObject::connect (driverstation, SIGNAL (changesPending()),
+                          window,          SLOT (update()));
+
+        driverstation->setFrameSynchronized (true);
+    }
+#endif
+
     /* Tell user how much time was needed to initialize the app */
     qDebug() << "Initialized in " << timer.elapsed() << "milliseconds";
 
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "plotitem.h"
+
+#include <QSGGeometryNode>
+#include <QSGVertexColorMaterial>
+
+#if QT_VERSION >= QT_VERSION_CHECK (5, 8, 0)
+    #include <QPainter>
+    #include <QQuickWindow>
+    #include <QSGRenderNode>
+    #include <QSGRendererInterface>
+    #define SOFTWARE_BACKEND_SUPPORT
+#endif
+
+/* Number of vertices used to draw each bar (two triangles) */
+#define VERTICES_PER_BAR 6
+
+/**
+ * Writes the two triangles of the bar of the given \a sample, empty slots
+ * are written as degenerate triangles
+ */
+static void writeBar (QSGGeometry::ColoredPoint2D* v,
+                      const PlotItem::Sample& sample,
+                      const float x, const float width, const float height)
+{
+    float top = height;
+    if (sample.level >= 0)
+        top = height * (1 - sample.level);
+
+    /* Colors used by the vertex color material are premultiplied */
+    int a = qAlpha (sample.color);
+    uchar r = qRed (sample.color) * a / 255;
+    uchar g = qGreen (sample.color) * a / 255;
+    uchar b = qBlue (sample.color) * a / 255;
+
+    v [0].set (x,         top,    r, g, b, a);
+    v [1].set (x + width, top,    r, g, b, a);
+    v [2].set (x,         height, r, g, b, a);
+    v [3].set (x + width, top,    r, g, b, a);
+    v [4].set (x + width, height, r, g, b, a);
+    v [5].set (x,         height, r, g, b, a);
+}
+
+#if defined SOFTWARE_BACKEND_SUPPORT
+/**
+ * Draws the bars with the painter of the software scene graph backend,
+ * which does not support custom geometry nodes
+ */
+class PlotPainterNode : public QSGRenderNode
+{
+public:
+    PlotPainterNode (QQuickWindow* window) : window (window), barWidth (0) {}
+
+    void render (const RenderState* state)
+    {
+        QSGRendererInterface* rif = window->rendererInterface();
+        QPainter* p = static_cast<QPainter*> (rif->getResource (
+                                                  window, QSGRendererInterface::PainterResource));
+        if (!p)
+            return;
+
+        p->setTransform (matrix()->toTransform());
+        p->setOpacity (inheritedOpacity());
+
+        const QRegion* clip = state->clipRegion();
+        if (clip && !clip->isEmpty())
+            p->setClipRegion (*clip, Qt::ReplaceClip);
+
+        for (int i = 0; i < samples.count(); ++i) {
+            const PlotItem::Sample& sample = samples.at (i);
+            if (sample.level > 0) {
+                qreal top = size.height() * (1 - sample.level);
+                p->fillRect (QRectF (i * barWidth, top, barWidth,
+                                     size.height() - top),
+                             QColor::fromRgba (sample.color));
+            }
+        }
+    }
+
+    StateFlags changedStates() const
+    {
+        return 0;
+    }
+
+    RenderingFlags flags() const
+    {
+        return BoundedRectRendering;
+    }
+
+    QRectF rect() const
+    {
+        return QRectF (QPointF (0, 0), size);
+    }
+
+    QQuickWindow* window;
+    qreal barWidth;
+    QSizeF size;
+    QVector<PlotItem::Sample> samples;
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Start class code
+//------------------------------------------------------------------------------
+
+/**
+ * Configures the item and starts the refresh timer
+ */
+PlotItem::PlotItem (QQuickItem* parent) : QQuickItem (parent)
+{
+    m_head = 0;
+    m_value = 0;
+    m_pending = 0;
+    m_barWidth = 2;
+    m_fullUpdate = true;
+    m_minimumValue = 0;
+    m_maximumValue = 100;
+    m_barColor = Qt::black;
+
+    setFlag (ItemHasContents, true);
+
+    connect (&m_timer, SIGNAL (timeout()), this, SLOT (addSample()));
+    m_timer.start (50);
+}
+
+/**
+ * Returns the value that will be added to the graph during the next refresh
+ */
+qreal PlotItem::value() const
+{
+    return m_value;
+}
+
+/**
+ * Returns the width (in pixels) of each bar
+ */
+qreal PlotItem::barWidth() const
+{
+    return m_barWidth;
+}
+
+/**
+ * Returns the color used to draw the next bars
+ */
+QColor PlotItem::barColor() const
+{
+    return m_barColor;
+}
+
+/**
+ * Returns the minimum value of the graph
+ */
+qreal PlotItem::minimumValue() const
+{
+    return m_minimumValue;
+}
+
+/**
+ * Returns the maximum value of the graph
+ */
+qreal PlotItem::maximumValue() const
+{
+    return m_maximumValue;
+}
+
+/**
+ * Returns the interval (in milliseconds) between each bar
+ */
+int PlotItem::refreshInterval() const
+{
+    return m_timer.interval();
+}
+
+/**
+ * Returns the ratio between the current value and the maximum value
+ */
+qreal PlotItem::level() const
+{
+    if (m_maximumValue == 0)
+        return 0;
+
+    return qMax (m_value, m_minimumValue) / m_maximumValue;
+}
+
+/**
+ * Removes all the bars of the graph
+ */
+void PlotItem::clear()
+{
+    Sample empty;
+    empty.level = -1;
+    empty.color = 0;
+
+    m_head = 0;
+    m_pending = 0;
+    m_fullUpdate = true;
+    m_samples.fill (empty);
+
+    update();
+}
+
+/**
+ * Changes the value that will be added to the graph during the next refresh
+ */
+void PlotItem::setValue (const qreal value)
+{
+    if (m_value != value) {
+        m_value = value;
+        emit valueChanged();
+    }
+}
+
+/**
+ * Changes the \a width of each bar, this clears the graph
+ */
+void PlotItem::setBarWidth (const qreal width)
+{
+    if (m_barWidth != width && width > 0) {
+        m_barWidth = width;
+        resizeBuffer();
+        emit barWidthChanged();
+    }
+}
+
+/**
+ * Changes the color used to draw the next bars
+ */
+void PlotItem::setBarColor (const QColor& color)
+{
+    if (m_barColor != color) {
+        m_barColor = color;
+        emit barColorChanged();
+    }
+}
+
+/**
+ * Changes the minimum value of the graph
+ */
+void PlotItem::setMinimumValue (const qreal value)
+{
+    if (m_minimumValue != value) {
+        m_minimumValue = value;
+        emit minimumValueChanged();
+    }
+}
+
+/**
+ * Changes the maximum value of the graph
+ */
+void PlotItem::setMaximumValue (const qreal value)
+{
+    if (m_maximumValue != value) {
+        m_maximumValue = value;
+        emit maximumValueChanged();
+    }
+}
+
+/**
+ * Changes the \a interval (in milliseconds) between each bar
+ */
+void PlotItem::setRefreshInterval (const int interval)
+{
+    if (m_timer.interval() != interval && interval > 0) {
+        m_timer.start (interval);
+        emit refreshIntervalChanged();
+    }
+}
+
+/**
+ * Re-calculates the number of bars when the width of the item changes
+ */
+void PlotItem::geometryChanged (const QRectF& newGeometry,
+                                const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChanged (newGeometry, oldGeometry);
+
+    if (newGeometry.width() != oldGeometry.width())
+        resizeBuffer();
+
+    else if (newGeometry.height() != oldGeometry.height()) {
+        m_fullUpdate = true;
+        update();
+    }
+}
+
+/**
+ * Writes the vertices of the bars that changed since the last frame
+ */
+QSGNode* PlotItem::updatePaintNode (QSGNode* node, UpdatePaintNodeData* data)
+{
+    Q_UNUSED (data);
+
+    int capacity = m_samples.count();
+    if (capacity == 0) {
+        delete node;
+        return Q_NULLPTR;
+    }
+
+    /* Get the slots that changed (the last bars and the empty slot) */
+    bool full = m_fullUpdate || m_pending + 1 >= capacity;
+    int first = full ? 0 : (m_head - m_pending + capacity) % capacity;
+    int count = full ? capacity : m_pending + 1;
+
+    m_pending = 0;
+    m_fullUpdate = false;
+
+#if defined SOFTWARE_BACKEND_SUPPORT
+    QQuickWindow* win = window();
+    if (win && win->rendererInterface()->graphicsApi() ==
+            QSGRendererInterface::Software) {
+        PlotPainterNode* painterNode = static_cast<PlotPainterNode*> (node);
+        if (!painterNode)
+            painterNode = new PlotPainterNode (win);
+
+        if (painterNode->samples.count() != capacity) {
+            painterNode->samples = m_samples;
+            count = 0;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int slot = (first + i) % capacity;
+            painterNode->samples [slot] = m_samples.at (slot);
+        }
+
+        painterNode->barWidth = m_barWidth;
+        painterNode->size = QSizeF (width(), height());
+        painterNode->markDirty (QSGNode::DirtyMaterial);
+
+        return painterNode;
+    }
+#endif
+
+    /* Create the node */
+    QSGGeometryNode* geometryNode = static_cast<QSGGeometryNode*> (node);
+    if (!geometryNode) {
+        QSGGeometry* geometry = new QSGGeometry (
+            QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode (GL_TRIANGLES);
+
+        geometryNode = new QSGGeometryNode;
+        geometryNode->setGeometry (geometry);
+        geometryNode->setMaterial (new QSGVertexColorMaterial);
+        geometryNode->setFlag (QSGNode::OwnsGeometry);
+        geometryNode->setFlag (QSGNode::OwnsMaterial);
+    }
+
+    /* Resize the vertex buffer */
+    QSGGeometry* geometry = geometryNode->geometry();
+    if (geometry->vertexCount() != capacity * VERTICES_PER_BAR) {
+        geometry->allocate (capacity * VERTICES_PER_BAR);
+        first = 0;
+        count = capacity;
+    }
+
+    /* Write the bars */
+    QSGGeometry::ColoredPoint2D* vertices = geometry->vertexDataAsColoredPoint2D();
+    for (int i = 0; i < count; ++i) {
+        int slot = (first + i) % capacity;
+        writeBar (vertices + (slot * VERTICES_PER_BAR),
+                  m_samples.at (slot),
+                  slot * m_barWidth, m_barWidth, height());
+    }
+
+    geometryNode->markDirty (QSGNode::DirtyGeometry);
+    return geometryNode;
+}
+
+/**
+ * Stores the current value in the slot of the oldest bar and clears the slot
+ * next to it
+ */
+void PlotItem::addSample()
+{
+    emit refreshed();
+
+    int capacity = m_samples.count();
+    if (!isVisible() || capacity == 0)
+        return;
+
+    Sample sample;
+    sample.level = qBound (0.0, level(), 1.0);
+    sample.color = m_barColor.rgba();
+
+    m_samples [m_head] = sample;
+    m_head = (m_head + 1) % capacity;
+    m_samples [m_head].level = -1;
+
+    ++m_pending;
+    update();
+}
+
+/**
+ * Allocates one slot for each bar that fits in the item and clears the graph
+ */
+void PlotItem::resizeBuffer()
+{
+    int capacity = 0;
+    if (m_barWidth > 0 && width() > 0)
+        capacity = (int) (width() / m_barWidth);
+
+    m_samples.resize (capacity);
+    clear();
+}
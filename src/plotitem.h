@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QDS_PLOT_ITEM_H
+#define _QDS_PLOT_ITEM_H
+
+#include <QTimer>
+#include <QColor>
+#include <QVector>
+#include <QQuickItem>
+
+/**
+ * \brief Draws a real-time bar graph using the Qt Quick scene graph
+ *
+ * Every time that the refresh timer expires, the current value is stored in
+ * a ring buffer with one slot for each bar that fits in the item. The slots
+ * are drawn from left to right (like an oscilloscope), the newest bar
+ * overwrites the oldest one and the slot next to it is left empty to show
+ * where the graph is being drawn.
+ *
+ * All bars are drawn by a single geometry node, and only the vertices of the
+ * slots that changed since the last frame are re-written. When the software
+ * scene graph backend is used, the bars are drawn with \c QPainter instead.
+ */
+class PlotItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY (qreal value
+                READ value
+                WRITE setValue
+                NOTIFY valueChanged)
+    Q_PROPERTY (qreal minimumValue
+                READ minimumValue
+                WRITE setMinimumValue
+                NOTIFY minimumValueChanged)
+    Q_PROPERTY (qreal maximumValue
+                READ maximumValue
+                WRITE setMaximumValue
+                NOTIFY maximumValueChanged)
+    Q_PROPERTY (qreal barWidth
+                READ barWidth
+                WRITE setBarWidth
+                NOTIFY barWidthChanged)
+    Q_PROPERTY (QColor barColor
+                READ barColor
+                WRITE setBarColor
+                NOTIFY barColorChanged)
+    Q_PROPERTY (int refreshInterval
+                READ refreshInterval
+                WRITE setRefreshInterval
+                NOTIFY refreshIntervalChanged)
+
+signals:
+    void refreshed();
+    void valueChanged();
+    void barWidthChanged();
+    void barColorChanged();
+    void minimumValueChanged();
+    void maximumValueChanged();
+    void refreshIntervalChanged();
+
+public:
+    struct Sample {
+        qreal level;
+        QRgb color;
+    };
+
+    explicit PlotItem (QQuickItem* parent = Q_NULLPTR);
+
+    qreal value() const;
+    qreal barWidth() const;
+    QColor barColor() const;
+    qreal minimumValue() const;
+    qreal maximumValue() const;
+    int refreshInterval() const;
+
+    Q_INVOKABLE qreal level() const;
+
+public slots:
+    void clear();
+    void setValue (const qreal value);
+    void setBarWidth (const qreal width);
+    void setBarColor (const QColor& color);
+    void setMinimumValue (const qreal value);
+    void setMaximumValue (const qreal value);
+    void setRefreshInterval (const int interval);
+
+protected:
+    void geometryChanged (const QRectF& newGeometry,
+                          const QRectF& oldGeometry);
+    QSGNode* updatePaintNode (QSGNode* node, UpdatePaintNodeData* data);
+
+private slots:
+    void addSample();
+
+private:
+    void resizeBuffer();
+
+private:
+    qreal m_value;
+    qreal m_barWidth;
+    qreal m_minimumValue;
+    qreal m_maximumValue;
+
+    int m_head;
+    int m_pending;
+    bool m_fullUpdate;
+
+    QTimer m_timer;
+    QColor m_barColor;
+    QVector<Sample> m_samples;
+};
+
+#endif
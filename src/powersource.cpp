@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "powersource.h"
+
+#include <QTimer>
+
+/* Interval (in msecs) at which the power sources are polled */
+#define POLL_INTERVAL 1000
+
+//------------------------------------------------------------------------------
+// Windows backend
+//------------------------------------------------------------------------------
+
+#if defined Q_OS_WIN
+#include <windows.h>
+
+/**
+ * Reads the power status with the \c GetSystemPowerStatus() API
+ */
+class WindowsPowerSource : public PowerSource
+{
+public:
+    WindowsPowerSource (QObject* parent) : PowerSource (parent)
+    {
+        update();
+
+        QTimer* timer = new QTimer (this);
+        connect (timer, SIGNAL (timeout()), this, SLOT (update()));
+        timer->start (POLL_INTERVAL);
+    }
+
+    int batteryLevel() const
+    {
+        return m_batteryLevel;
+    }
+
+    bool isConnectedToAC() const
+    {
+        return m_connectedToAC;
+    }
+
+protected:
+    void update()
+    {
+        SYSTEM_POWER_STATUS power;
+        if (GetSystemPowerStatus (&power)) {
+            m_batteryLevel = power.BatteryLifePercent <= 100 ?
+                             power.BatteryLifePercent : 0;
+            m_connectedToAC = (power.ACLineStatus == 1);
+            emit changed();
+        }
+    }
+
+private:
+    int m_batteryLevel = 0;
+    bool m_connectedToAC = false;
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Mac OS backend
+//------------------------------------------------------------------------------
+
+#if defined Q_OS_MAC
+#include <QProcess>
+
+/**
+ * Reads the power status from the output of \c pmset, a single process is
+ * used to obtain both the battery level and the AC state. The output of
+ * the process is read when the next process is about to be started.
+ */
+class PmsetPowerSource : public PowerSource
+{
+public:
+    PmsetPowerSource (QObject* parent) : PowerSource (parent)
+    {
+        QTimer* timer = new QTimer (this);
+        connect (timer, SIGNAL (timeout()), this, SLOT (update()));
+        timer->start (POLL_INTERVAL);
+
+        update();
+    }
+
+    ~PmsetPowerSource()
+    {
+        m_process.kill();
+        m_process.waitForFinished (100);
+    }
+
+    int batteryLevel() const
+    {
+        return m_batteryLevel;
+    }
+
+    bool isConnectedToAC() const
+    {
+        return m_connectedToAC;
+    }
+
+protected:
+    void update()
+    {
+        if (m_process.state() == QProcess::NotRunning) {
+            read();
+            m_process.start ("pmset -g batt", QIODevice::ReadOnly);
+        }
+    }
+
+private:
+    void read()
+    {
+        QByteArray data = m_process.readAll();
+        if (m_process.exitCode() != 0 || data.isEmpty())
+            return;
+
+        /* Parse the digits before the percent sign */
+        int percent = data.indexOf ("%");
+        int start = percent;
+        while (start > 0 && data.at (start - 1) >= '0' && data.at (start - 1) <= '9')
+            --start;
+
+        m_batteryLevel = percent > start ? data.mid (start, percent - start).toInt() : 0;
+        m_connectedToAC = !data.contains ("discharging");
+        emit changed();
+    }
+
+private:
+    QProcess m_process;
+    int m_batteryLevel = 0;
+    bool m_connectedToAC = false;
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Linux backend
+//------------------------------------------------------------------------------
+
+#if defined Q_OS_LINUX
+#include <QDir>
+#include <QVector>
+#include <QSocketNotifier>
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+/* Location of the power supplies in the sysfs */
+#define SYSFS_POWER_SUPPLY "/sys/class/power_supply"
+
+/**
+ * Reads the power status from the sysfs attributes of each power supply of
+ * the system (the batteries of peripherals, such as joysticks, are ignored).
+ * The attribute files are opened once and re-read with \c pread(), and the
+ * kernel uevents (if available) trigger an immediate update, so that AC
+ * changes are reported without waiting for the next poll. The supplies are
+ * scanned again when the kernel reports that one was added or removed.
+ */
+class SysfsPowerSource : public PowerSource
+{
+public:
+    SysfsPowerSource (QObject* parent) : PowerSource (parent)
+    {
+        m_uevents = -1;
+        m_batteryLevel = 0;
+        m_connectedToAC = false;
+
+        /* Open the attributes of each power supply */
+        scanSupplies();
+
+        /* Listen for power supply events */
+        m_uevents = socket (AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                            NETLINK_KOBJECT_UEVENT);
+
+        if (m_uevents >= 0) {
+            struct sockaddr_nl address;
+            memset (&address, 0, sizeof (address));
+            address.nl_family = AF_NETLINK;
+            address.nl_groups = 1;
+
+            if (bind (m_uevents, (struct sockaddr*) &address, sizeof (address)) == 0) {
+                QSocketNotifier* notifier;
+                notifier = new QSocketNotifier (m_uevents, QSocketNotifier::Read, this);
+                connect (notifier, SIGNAL (activated (int)), this, SLOT (update()));
+            }
+
+            else {
+                close (m_uevents);
+                m_uevents = -1;
+            }
+        }
+
+        /* Poll the battery level (not every driver reports its changes) */
+        QTimer* timer = new QTimer (this);
+        connect (timer, SIGNAL (timeout()), this, SLOT (update()));
+        timer->start (POLL_INTERVAL);
+
+        update();
+    }
+
+    ~SysfsPowerSource()
+    {
+        closeSupplies();
+
+        if (m_uevents >= 0)
+            close (m_uevents);
+    }
+
+    int batteryLevel() const
+    {
+        return m_batteryLevel;
+    }
+
+    bool isConnectedToAC() const
+    {
+        return m_connectedToAC;
+    }
+
+private:
+    struct Battery {
+        int capacity;
+        int status;
+    };
+
+    /**
+     * Opens the given sysfs attribute, returns -1 if it does not exist
+     */
+    static int openAttribute (const QString& path)
+    {
+        return open (path.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    }
+
+    /**
+     * Reads the given attribute file descriptor from the beginning to the
+     * given \a buffer (without the trailing newline)
+     */
+    static int readAttribute (const int fd, char* buffer, const int size)
+    {
+        int length = pread (fd, buffer, size - 1, 0);
+        if (length < 0)
+            length = 0;
+
+        while (length > 0 && (buffer [length - 1] == '\n' || buffer [length - 1] == ' '))
+            --length;
+
+        buffer [length] = '\0';
+        return length;
+    }
+
+    /**
+     * Reads the given attribute once (used for constant attributes)
+     */
+    static QByteArray readOnce (const QString& path)
+    {
+        char buffer [32];
+        int fd = openAttribute (path);
+        if (fd < 0)
+            return QByteArray();
+
+        readAttribute (fd, buffer, sizeof (buffer));
+        close (fd);
+        return QByteArray (buffer);
+    }
+
+    /**
+     * Opens the attributes of each power supply of the system. Supplies with
+     * a \c Device scope (e.g. the battery of a wireless joystick) do not
+     * power the computer, so they are ignored.
+     */
+    void scanSupplies()
+    {
+        QDir dir (SYSFS_POWER_SUPPLY);
+        foreach (const QString& name, dir.entryList (QDir::Dirs | QDir::NoDotAndDotDot)) {
+            QString path = dir.absoluteFilePath (name);
+            if (readOnce (path + "/scope") == "Device")
+                continue;
+
+            if (readOnce (path + "/type") == "Battery") {
+                Battery battery;
+                battery.capacity = openAttribute (path + "/capacity");
+                battery.status = openAttribute (path + "/status");
+
+                if (battery.capacity >= 0)
+                    m_batteries.append (battery);
+                else if (battery.status >= 0)
+                    close (battery.status);
+            }
+
+            else {
+                int online = openAttribute (path + "/online");
+                if (online >= 0)
+                    m_supplies.append (online);
+            }
+        }
+    }
+
+    /**
+     * Closes the attributes of the power supplies
+     */
+    void closeSupplies()
+    {
+        foreach (const Battery& battery, m_batteries) {
+            close (battery.capacity);
+            if (battery.status >= 0)
+                close (battery.status);
+        }
+
+        foreach (int online, m_supplies)
+            close (online);
+
+        m_supplies.clear();
+        m_batteries.clear();
+    }
+
+    /**
+     * Reads the queued kernel uevents, the attributes are read again
+     * regardless of the device that generated them.
+     *
+     * \returns \c true if a power supply was added or removed, or if we
+     *          cannot receive uevents (so that the supplies are scanned on
+     *          each update)
+     */
+    bool readUevents()
+    {
+        if (m_uevents < 0)
+            return true;
+
+        int length;
+        bool changed = false;
+        char buffer [4096];
+        while ((length = recv (m_uevents, buffer, sizeof (buffer) - 1, 0)) > 0) {
+            bool action = false;
+            bool supply = false;
+
+            /* The uevent is a list of null-terminated KEY=VALUE strings */
+            buffer [length] = '\0';
+            for (int i = 0; i < length; i += strlen (buffer + i) + 1) {
+                action |= (strcmp (buffer + i, "ACTION=add") == 0);
+                action |= (strcmp (buffer + i, "ACTION=remove") == 0);
+                supply |= (strcmp (buffer + i, "SUBSYSTEM=power_supply") == 0);
+            }
+
+            changed |= (action && supply);
+        }
+
+        return changed;
+    }
+
+protected:
+    /**
+     * Reads the attributes of the power supplies and emits \c changed() if
+     * the battery level or the AC state have changed
+     */
+    void update()
+    {
+        char buffer [32];
+        if (readUevents()) {
+            closeSupplies();
+            scanSupplies();
+        }
+
+        int level = 0;
+        bool online = false;
+        bool discharging = false;
+
+        foreach (const Battery& battery, m_batteries) {
+            if (readAttribute (battery.capacity, buffer, sizeof (buffer)) > 0)
+                level += atoi (buffer);
+
+            if (battery.status >= 0 &&
+                    readAttribute (battery.status, buffer, sizeof (buffer)) > 0)
+                discharging |= (strcmp (buffer, "Discharging") == 0);
+        }
+
+        foreach (int supply, m_supplies) {
+            if (readAttribute (supply, buffer, sizeof (buffer)) > 0)
+                online |= (atoi (buffer) == 1);
+        }
+
+        if (!m_batteries.isEmpty())
+            level /= m_batteries.count();
+
+        bool connected = online || (!m_batteries.isEmpty() && !discharging);
+        if (level != m_batteryLevel || connected != m_connectedToAC) {
+            m_batteryLevel = level;
+            m_connectedToAC = connected;
+            emit changed();
+        }
+    }
+
+private:
+    int m_uevents;
+    int m_batteryLevel;
+    bool m_connectedToAC;
+
+    QVector<int> m_supplies;
+    QVector<Battery> m_batteries;
+};
+#endif
+
+//------------------------------------------------------------------------------
+// Fallback backend
+//------------------------------------------------------------------------------
+
+/**
+ * Used on operating systems without a power source backend
+ */
+class NullPowerSource : public PowerSource
+{
+public:
+    NullPowerSource (QObject* parent) : PowerSource (parent) {}
+
+protected:
+    void update() {}
+
+    int batteryLevel() const
+    {
+        return 0;
+    }
+
+    bool isConnectedToAC() const
+    {
+        return false;
+    }
+};
+
+//------------------------------------------------------------------------------
+// Start class code
+//------------------------------------------------------------------------------
+
+PowerSource::PowerSource (QObject* parent) : QObject (parent) {}
+
+/**
+ * Creates the power source backend of the current operating system
+ */
+PowerSource* PowerSource::create (QObject* parent)
+{
+#if defined Q_OS_WIN
+    return new WindowsPowerSource (parent);
+#elif defined Q_OS_MAC
+    return new PmsetPowerSource (parent);
+#elif defined Q_OS_LINUX
+    return new SysfsPowerSource (parent);
+#else
+    return new NullPowerSource (parent);
+#endif
+}
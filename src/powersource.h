@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2015-2016 Alex Spataru <alex_spataru@outlook.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef _QDS_POWER_SOURCE_H
+#define _QDS_POWER_SOURCE_H
+
+#include <QObject>
+
+/**
+ * \brief Reports the battery level and the AC power state of the computer
+ *
+ * Each operating system has its own backend, which is created with the
+ * \c create() function. The backends emit \c changed() when the battery
+ * level or the AC state (may) have changed.
+ */
+class PowerSource : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void changed();
+
+public:
+    static PowerSource* create (QObject* parent = Q_NULLPTR);
+
+    virtual int batteryLevel() const = 0;
+    virtual bool isConnectedToAC() const = 0;
+
+protected:
+    explicit PowerSource (QObject* parent);
+
+protected slots:
+    virtual void update() = 0;
+};
+
+#endif
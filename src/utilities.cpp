@@ -21,6 +21,8 @@
  */
 
 #include "utilities.h"
+#include "powersource.h"
+#include "hostmetrics.h"
 
 #include <QTimer>
 #include <QDebug>
@@ -41,7 +43,6 @@
 
     static PDH_HQUERY cpuQuery;
     static PDH_HCOUNTER cpuTotal;
-    static SYSTEM_POWER_STATUS power;
 #endif
 
 //------------------------------------------------------------------------------
@@ -51,24 +52,6 @@
 #if defined Q_OS_MAC
     static const QString CPU_CMD = "bash -c \"ps -A -o %cpu | "
     "awk '{s+=$1} END {print s}'\"";
-    static const QString BTY_CMD = "pmset -g batt";
-    static const QString PWR_CMD = "pmset -g batt";
-#endif
-
-//------------------------------------------------------------------------------
-// Linux hacks
-//------------------------------------------------------------------------------
-
-#if defined Q_OS_LINUX
-    #include <QFile>
-    #include <QRegExp>
-
-    static const QString BTY_CMD = "bash -c \"upower -i "
-    "$(upower -e | grep 'BAT') | "
-    "grep -E 'state|to\\ full|percentage'\"";
-    static const QString PWR_CMD = "bash -c \"upower -i "
-    "$(upower -e | grep 'BAT') | "
-    "grep -E 'state|to\\ full|percentage'\"";
 #endif
 
 //------------------------------------------------------------------------------
@@ -77,8 +60,6 @@
 
 #if !defined Q_OS_WIN && !defined Q_OS_MAC && !defined Q_OS_LINUX
     static const QString CPU_CMD = "";
-    static const QString BTY_CMD = "";
-    static const QString PWR_CMD = "";
 #endif
 
 //------------------------------------------------------------------------------
@@ -101,18 +82,15 @@ Utilities::Utilities()
     /* Read process data when they finish */
     connect (&m_cpuProcess,           SIGNAL (finished                 (int)),
              this,                      SLOT (readCpuUsageProcess      (int)));
-    connect (&m_batteryLevelProcess,  SIGNAL (finished                 (int)),
-             this,                      SLOT (readBatteryLevelProcess  (int)));
-    connect (&m_connectedToACProcess, SIGNAL (finished                 (int)),
-             this,                      SLOT (readConnectedToACProcess (int)));
 
     /* Kill the probing processes when application quits */
     connect (qApp,                  SIGNAL (aboutToQuit()),
              &m_cpuProcess,           SLOT (kill()));
-    connect (qApp,                  SIGNAL (aboutToQuit()),
-             &m_batteryLevelProcess,  SLOT (kill()));
-    connect (qApp,                  SIGNAL (aboutToQuit()),
-             &m_connectedToACProcess, SLOT (kill()));
+
+    /* Read the battery level and AC state from the power source backend */
+    m_powerSource = PowerSource::create (this);
+    connect (m_powerSource,         SIGNAL (changed()),
+             this,                    SLOT (updatePowerSource()));
 
     /* Configure Windows */
 #if defined Q_OS_WIN
@@ -124,10 +102,15 @@ Utilities::Utilities()
     PdhCollectQueryData (cpuQuery);
 #endif
 
+    /* Get the CPU usage from the host metrics sampler */
+#if defined Q_OS_LINUX
+    connect (HostMetrics::getInstance(), SIGNAL (updated()),
+             this,                         SLOT (updateCpuUsage()));
+#endif
+
     /* Start loop */
     updateCpuUsage();
-    updateBatteryLevel();
-    updateConnectedToAC();
+    updatePowerSource();
 }
 
 /**
@@ -208,56 +191,35 @@ void Utilities::updateCpuUsage()
     m_cpuProcess.terminate();
     m_cpuProcess.start (CPU_CMD, QIODevice::ReadOnly);
 #elif defined Q_OS_LINUX
-    auto cpuJiffies = getCpuJiffies();
-
-    m_cpuUsage = (cpuJiffies.first - m_pastCpuJiffies.first) * 100 /
-                 (cpuJiffies.second - m_pastCpuJiffies.second);
-
-    m_pastCpuJiffies = cpuJiffies;
+    m_cpuUsage = HostMetrics::getInstance()->cpuUsage();
     emit cpuUsageChanged();
 #endif
 
+    /* The host metrics sampler calls this function on Linux */
+#if !defined Q_OS_LINUX
     QTimer::singleShot (1000,
                         Qt::PreciseTimer,
                         this, SLOT (updateCpuUsage()));
-}
-
-/**
- * Queries for the current battery level
- */
-void Utilities::updateBatteryLevel()
-{
-#if defined Q_OS_WIN
-    GetSystemPowerStatus (&power);
-    m_batteryLevel = static_cast<int> (power.BatteryLifePercent);
-    emit batteryLevelChanged();
-#else
-    m_batteryLevelProcess.terminate();
-    m_batteryLevelProcess.start (BTY_CMD, QIODevice::ReadOnly);
 #endif
-
-    QTimer::singleShot (1000,
-                        Qt::PreciseTimer,
-                        this, SLOT (updateBatteryLevel()));
 }
 
 /**
- * Queries for the current AC power source status
+ * Reads the battery level and AC state reported by the power source backend
  */
-void Utilities::updateConnectedToAC()
+void Utilities::updatePowerSource()
 {
-#if defined Q_OS_WIN
-    GetSystemPowerStatus (&power);
-    m_connectedToAC = (power.ACLineStatus != 0);
-    emit connectedToACChanged();
-#else
-    m_connectedToACProcess.terminate();
-    m_connectedToACProcess.start (PWR_CMD, QIODevice::ReadOnly);
-#endif
+    int level = m_powerSource->batteryLevel();
+    bool connected = m_powerSource->isConnectedToAC();
 
-    QTimer::singleShot (1000,
-                        Qt::PreciseTimer,
-                        this, SLOT (updateConnectedToAC()));
+    if (m_batteryLevel != level) {
+        m_batteryLevel = level;
+        emit batteryLevelChanged();
+    }
+
+    if (m_connectedToAC != connected) {
+        m_connectedToAC = connected;
+        emit connectedToACChanged();
+    }
 }
 
 /**
@@ -318,81 +280,3 @@ void Utilities::readCpuUsageProcess (int exit_code)
     }
 #endif
 }
-
-/**
- * Reads the output of the process launched to get the battery level
- */
-void Utilities::readBatteryLevelProcess (int exit_code)
-{
-    if (exit_code == EXIT_FAILURE)
-        return;
-
-#if defined Q_OS_MAC || defined Q_OS_LINUX
-    m_batteryLevel = 0;
-    m_batteryLevelProcess.terminate();
-    QByteArray data = m_batteryLevelProcess.readAll();
-
-    if (!data.isEmpty()) {
-        /* Parse the digits of the percentage */
-        int h = data.at (data.indexOf ("%") - 3) - '0'; // Hundreds
-        int t = data.at (data.indexOf ("%") - 2) - '0'; // Tens
-        int u = data.at (data.indexOf ("%") - 1) - '0'; // Units
-
-        /* Check if process data is invalid */
-        if (h < 0) h = 0;
-        if (t < 0) t = 0;
-        if (u < 0) u = 0;
-
-        /* Update information */
-        m_batteryLevel = (h * 100) + (t * 10) + u;
-        emit batteryLevelChanged();
-    }
-#endif
-}
-
-/**
- * Reads the output of the process launched to get the AC power source status
- */
-void Utilities::readConnectedToACProcess (int exit_code)
-{
-    if (exit_code == EXIT_FAILURE)
-        return;
-
-#if defined Q_OS_MAC || defined Q_OS_LINUX
-    m_connectedToAC = false;
-    m_connectedToACProcess.terminate();
-    QByteArray data = m_connectedToACProcess.readAll();
-
-    if (!data.isEmpty()) {
-        m_connectedToAC = !data.contains ("discharging");
-        emit connectedToACChanged();
-    }
-#endif
-}
-
-#if defined Q_OS_LINUX
-/**
- * Reads the current count of CPU jiffies from /proc/stat and return a pair
- * consisting of non-idle jiffies and total jiffies
- */
-QPair<quint64, quint64> Utilities::getCpuJiffies()
-{
-    quint64 totalJiffies = 0;
-    quint64 nonIdleJiffies = 0;
-
-    QFile file ("/proc/stat");
-    if (file.open (QFile::ReadOnly)) {
-        QString line = file.readLine();
-        QStringList jiffies = line.replace ("cpu  ", "").split (" ");
-
-        if (jiffies.count() > 3) {
-            nonIdleJiffies = jiffies.at (0).toInt() + jiffies.at (2).toInt();
-            totalJiffies = nonIdleJiffies + jiffies.at (3).toInt();
-        }
-
-        file.close();
-    }
-
-    return qMakePair (nonIdleJiffies, totalJiffies);
-}
-#endif
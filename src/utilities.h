@@ -25,11 +25,8 @@
 
 #include <QProcess>
 
-#if defined Q_OS_LINUX
-    #include <QPair>
-#endif
-
 class QSettings;
+class PowerSource;
 
 /**
  * \brief Provides CPU and Battery information to the QML interface
@@ -67,19 +64,11 @@ public slots:
 
 private slots:
     void updateCpuUsage();
-    void updateBatteryLevel();
-    void updateConnectedToAC();
+    void updatePowerSource();
     void calculateScaleRatio();
     void readCpuUsageProcess (int exit_code = 0);
-    void readBatteryLevelProcess (int exit_code = 0);
-    void readConnectedToACProcess (int exit_code = 0);
 
 private:
-#if defined (Q_OS_LINUX)
-    QPair<quint64, quint64> getCpuJiffies();
-    QPair<quint64, quint64> m_pastCpuJiffies {0, 0};
-#endif
-
     qreal m_ratio;
     int m_cpuUsage;
     int m_batteryLevel;
@@ -87,8 +76,7 @@ private:
 
     QSettings* m_settings;
     QProcess m_cpuProcess;
-    QProcess m_batteryLevelProcess;
-    QProcess m_connectedToACProcess;
+    PowerSource* m_powerSource;
 };
 
 #endif